@@ -0,0 +1,49 @@
+//
+//        Interface between the emulator and a Quack3200 program that was
+//        translated ahead of time to C++ by AotTranslator and compiled into
+//        a shared library. The generated source includes only this file.
+//
+
+#ifndef _AOTMODULE_H
+#define _AOTMODULE_H
+
+// The state of the emulator shared with a translated program
+struct QuackAotContext
+{
+    int *m_memory;                              // The memory of the Quack3200
+    int *m_reg;                                 // The registers of the Quack3200
+    long long m_instrCount;                     // Instructions dispatched so far
+    int m_pc;                                   // Location where the translated program stopped
+    void *m_host;                               // The emulator running the program
+
+    // Reads a value into a memory location, false if a run-time error was recorded
+    bool (*m_read)(void *a_host, int a_address);
+
+    // Writes a value
+    void (*m_write)(void *a_host, int a_value);
+
+    // Records a run-time error in a register
+    void (*m_error)(void *a_host, int a_errorCode, int a_regNumber);
+
+    // Reads values into a block of memory, false if a run-time error was recorded
+    bool (*m_readWords)(void *a_host, int a_address, int a_count);
+
+    // Writes the values of a block of memory
+    void (*m_writeWords)(void *a_host, const int *a_values, int a_count);
+};
+
+// Why a translated program returned to the emulator
+enum QuackAotStatus
+{
+    AOT_HALT,           // HALT was executed at m_pc
+    AOT_ERROR,          // a run-time error was recorded
+    AOT_RESUME          // the program changed its own code, interpret from m_pc
+};
+
+// The entry point of a translated program and the hash of its image
+#define QUACK_AOT_ENTRY "QuackAotRun"
+#define QUACK_AOT_IMAGE "QuackAotImage"
+
+typedef int (*QuackAotEntry)(QuackAotContext *);
+
+#endif
@@ -0,0 +1,415 @@
+//
+//  Implementation of the AOT translator class.
+//
+
+#include "stdafx.h"
+
+namespace
+{
+
+// Splits a translation into its opcode, register and address the way the emulator does
+void Decode(const int& a_translation, int& a_opcode, int& a_regNumber, int& a_address)
+{
+    a_opcode = Quack3200::Opcode(a_translation);
+    a_regNumber = Quack3200::Register(a_translation);
+    a_address = Quack3200::Address(a_translation);
+}
+
+// The code that leaves the translated program at location "a_pc"
+string Leave(const int& a_pc, const char *a_status)
+{
+    return "{ pc = " + to_string(a_pc) + "; status = " + a_status + "; goto done; }";
+}
+
+}
+
+
+/*
+NAME
+
+    Translate - Writes the C++ translation of a memory image
+
+SYNOPSIS
+
+    void Translate(const int a_memory[], ostream& a_out);
+
+DESCRIPTION
+
+    This function writes to "a_out" a C++ source file defining the entry
+    point QuackAotRun() of AotModule.h for the program in "a_memory".
+    Every location that can be executed starting at location 100 becomes
+    a statement, locations that are branched to become labels and the
+    branches become gotos. The run-time checks of Emulator::ResultChecker
+    are inlined. A store or a read into a location that holds translated
+    code leaves the function so that the emulator interprets the rest of
+    the program, which keeps self-modifying programs correct.
+*/
+
+void AotTranslator::Translate(const int a_memory[], ostream& a_out)
+{
+    vector<bool> code, target;
+    FindCode(a_memory, code, target);
+
+    a_out<<"// Translation of a Quack3200 program, generated by QuackAot."<<endl
+         <<"// Compile into a shared library and run with QUACK_AOT=<library> Assem <source>."<<endl
+         <<endl
+         <<"#include \"AotModule.h\""<<endl
+         <<endl
+         <<"// results of ADD, SUB and MULT wrap around as they do in the emulator"<<endl
+         <<"static inline int Wrap(long long a_value)"<<endl
+         <<"{"<<endl
+         <<"    return (int)(unsigned)a_value;"<<endl
+         <<"}"<<endl
+         <<endl
+         <<"extern \"C\" const unsigned long long QuackAotImage = "
+         <<ImageHash(a_memory)<<"ULL;"<<endl
+         <<endl
+         <<"extern \"C\" int QuackAotRun(QuackAotContext *ctx)"<<endl
+         <<"{"<<endl
+         <<"    int *mem = ctx->m_memory;"<<endl;
+
+    for (int i = 0; i < 10; i++)
+        a_out<<"    int r"<<i<<" = ctx->m_reg["<<i<<"];"<<endl;
+
+    a_out<<"    long long ic = ctx->m_instrCount;"<<endl
+         <<"    int pc, status, t, a;"<<endl
+         <<endl;
+
+    // the image may be run from location 100 only
+    a_out<<"    goto L100;"<<endl;
+
+    bool fallsThrough = false;
+
+    for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+    {
+        if (!code[loc])
+            continue;
+
+        a_out<<endl;
+
+        if (target[loc])
+            a_out<<"L"<<loc<<":"<<endl;
+
+        TranslateWord(a_memory, loc, code, a_out);
+
+        int opcode, regNumber, address;
+        Decode(a_memory[loc], opcode, regNumber, address);
+        fallsThrough = (opcode != Emulator::HALT && opcode != Emulator::B);
+    }
+
+    // the last location executed continues past the end of memory
+    if (fallsThrough)
+    {
+        int end = Emulator::MEMSZ;
+        a_out<<"    "<<Leave(end, "AOT_RESUME")<<endl;
+    }
+
+    a_out<<endl
+         <<"done:"<<endl;
+
+    for (int i = 0; i < 10; i++)
+        a_out<<"    ctx->m_reg["<<i<<"] = r"<<i<<";"<<endl;
+
+    a_out<<"    ctx->m_instrCount = ic;"<<endl
+         <<"    ctx->m_pc = pc;"<<endl
+         <<"    return status;"<<endl
+         <<"}"<<endl;
+}
+/*void AotTranslator::Translate(const int a_memory[], ostream& a_out); */
+
+
+/*
+NAME
+
+    ImageHash - Returns the hash identifying a memory image
+
+SYNOPSIS
+
+    unsigned long long ImageHash(const int a_memory[]);
+
+DESCRIPTION
+
+    This function computes the 64-bit FNV-1a hash of every word of
+    "a_memory". A translated program is only run on the image it was
+    translated from.
+*/
+
+unsigned long long AotTranslator::ImageHash(const int a_memory[])
+{
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+    {
+        unsigned word = (unsigned)a_memory[loc];
+
+        // hash the bytes in the same order on every machine
+        for (int byte = 0; byte < 4; byte++)
+        {
+            hash ^= (word >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    return hash;
+}
+/*unsigned long long AotTranslator::ImageHash(const int a_memory[]); */
+
+
+/*
+NAME
+
+    FindCode - Finds the locations that can be executed and those that are branched to
+
+SYNOPSIS
+
+    void FindCode(const int a_memory[], vector<bool>& a_code, vector<bool>& a_target);
+
+DESCRIPTION
+
+    This function follows every path of execution starting at location 100,
+    marking in "a_code" the locations that can be executed and in "a_target"
+    the locations that start a basic block (location 100 and the destinations
+    of branches).
+*/
+
+void AotTranslator::FindCode(const int a_memory[], vector<bool>& a_code, vector<bool>& a_target)
+{
+    a_code.assign(Emulator::MEMSZ, false);
+    a_target.assign(Emulator::MEMSZ, false);
+
+    vector<int> pending;
+    pending.push_back(100);
+    a_target[100] = true;
+
+    while (!pending.empty())
+    {
+        int loc = pending.back();
+        pending.pop_back();
+
+        // continue each path until it reaches translated code, the end of memory or a HALT
+        while (loc < Emulator::MEMSZ && !a_code[loc])
+        {
+            a_code[loc] = true;
+
+            int opcode, regNumber, address;
+            Decode(a_memory[loc], opcode, regNumber, address);
+
+            if (opcode == Emulator::HALT)
+                break;
+
+            if (opcode >= Emulator::B && opcode <= Emulator::BP)
+            {
+                a_target[address] = true;
+                pending.push_back(address);
+
+                if (opcode == Emulator::B)
+                    break;
+            }
+
+            loc++;
+        }
+    }
+}
+/*void AotTranslator::FindCode(const int a_memory[], vector<bool>& a_code, vector<bool>& a_target); */
+
+
+/*
+NAME
+
+    TranslateWord - Writes the translation of the instruction at one location
+
+SYNOPSIS
+
+    void TranslateWord(const int a_memory[], const int& a_loc,
+                       const vector<bool>& a_code, ostream& a_out);
+
+DESCRIPTION
+
+    This function writes to "a_out" the statements executing the instruction
+    at location "a_loc" of "a_memory", with the same effect as one iteration
+    of Emulator::RunProgram. "a_code" holds the locations that are translated,
+    which must not change while the translation runs; an indexed STORE,
+    READV, MOVE or FILL between the first and the last of them leaves the
+    translation. FORK, JOIN and FADD leave it before they execute, since
+    the memory is shared by threads from the first FORK on, and so do SEND
+    and RECV, which may suspend the program.
+*/
+
+void AotTranslator::TranslateWord(const int a_memory[], const int& a_loc,
+                                  const vector<bool>& a_code, ostream& a_out)
+{
+    int opcode, regNumber, address;
+    Decode(a_memory[a_loc], opcode, regNumber, address);
+
+    string reg = "r" + to_string(regNumber);
+    string mem = "mem[" + to_string(address) + "]";
+    string error = "{ ctx->m_error(ctx->m_host, %d, " + to_string(regNumber) + "); "
+        + Leave(a_loc + 1, "AOT_ERROR") + " }";
+
+    a_out<<"    // "<<a_loc<<": "<<setw(8)<<setfill('0')<<a_memory[a_loc]<<setfill(' ')<<endl;
+
+    if (opcode >= Emulator::FORK && opcode <= Emulator::CHANNEL)
+    {
+        a_out<<"    "<<Leave(a_loc, "AOT_RESUME")<<endl;
+        return;
+    }
+
+    a_out<<"    ++ic;"<<endl;
+
+    // the first and the last location translated, for the stores whose location is only known when they run
+    int first = 0, last = -1;
+
+    // READV, MOVE, FILL and the indexed STORE
+    if (opcode == Emulator::READV || (opcode >= Emulator::MOVE && opcode < Emulator::INDEXED)
+        || opcode >= Emulator::INDEXED + 10 * (Emulator::STORE - Emulator::ADD))
+    {
+        first = (int)(find(a_code.begin(), a_code.end(), true) - a_code.begin());
+        last = (int)(a_code.rend() - find(a_code.rbegin(), a_code.rend(), true)) - 1;
+    }
+
+    // MOVE and FILL leave the translation if their block overlaps translated code
+    if (opcode >= Emulator::MOVE && opcode < Emulator::INDEXED)
+    {
+        int second = opcode % 10;
+
+        //Code 35: Block Exceeds Quack3200 Memory
+        a_out<<"    t = "<<reg<<";"<<endl
+             <<"    a = "<<(opcode < Emulator::FILL ? "r" + to_string(second) : "0")<<";"<<endl
+             <<"    if (t < 0 || t > "<<Emulator::MEMSZ - address<<" || a < 0 || a > "<<Emulator::MEMSZ<<" - t) "
+             <<"{ ctx->m_error(ctx->m_host, 35, "<<regNumber<<"); "<<Leave(a_loc + 1, "AOT_ERROR")<<" }"<<endl;
+
+        if (opcode < Emulator::FILL)
+            a_out<<"    __builtin_memmove(mem + "<<address<<", mem + a, t * sizeof(int));"<<endl;
+        else
+            a_out<<"    for (a = 0; a < t; a++) mem["<<address<<" + a] = r"<<second<<";"<<endl;
+
+        a_out<<"    if ("<<address<<" <= "<<last<<" && "<<address<<" + t > "<<first<<") "
+             <<Leave(a_loc + 1, "AOT_RESUME")<<endl;
+        return;
+    }
+
+    // READV and WRITEV pass their whole block to the emulator
+    if (opcode == Emulator::READV || opcode == Emulator::WRITEV)
+    {
+        //Code 35: Block Exceeds Quack3200 Memory
+        a_out<<"    t = "<<reg<<";"<<endl
+             <<"    if (t < 0 || t > "<<Emulator::MEMSZ - address<<") "
+             <<"{ ctx->m_error(ctx->m_host, 35, "<<regNumber<<"); "<<Leave(a_loc + 1, "AOT_ERROR")<<" }"<<endl;
+
+        if (opcode == Emulator::WRITEV)
+        {
+            a_out<<"    if (t > 0) ctx->m_writeWords(ctx->m_host, mem + "<<address<<", t);"<<endl;
+            return;
+        }
+
+        a_out<<"    if (t > 0 && !ctx->m_readWords(ctx->m_host, "<<address<<", t)) "
+             <<Leave(a_loc + 1, "AOT_ERROR")<<endl
+             <<"    if ("<<address<<" <= "<<last<<" && "<<address<<" + t > "<<first<<") "
+             <<Leave(a_loc + 1, "AOT_RESUME")<<endl;
+        return;
+    }
+
+    // the address of an indexed ADD to STORE is only known when it runs
+    bool indexed = opcode >= Emulator::INDEXED;
+
+    if (indexed)
+    {
+        int indexReg = opcode % 10;
+        opcode = Emulator::ADD + (opcode - Emulator::INDEXED) / 10;
+        mem = "mem[a]";
+
+        //Code 34: Indexed Address Outside Quack3200 Memory
+        a_out<<"    a = "<<address<<" + r"<<indexReg<<";"<<endl
+             <<"    if (a < 0 || a >= "<<Emulator::MEMSZ<<") { ctx->m_error(ctx->m_host, 34, "<<indexReg<<"); "
+             <<Leave(a_loc + 1, "AOT_ERROR")<<" }"<<endl;
+    }
+
+    // the error of each checked operation
+    auto checked = [&](const int& a_code, const string& a_operation)
+    {
+        string onError = error;
+        onError.replace(onError.find("%d"), 2, to_string(a_code));
+
+        a_out<<"    t = Wrap("<<a_operation<<");"<<endl
+             <<"    if (t > "<<Quack3200::MAXVAL<<" || t < "<<Quack3200::MINVAL<<") "<<onError<<endl
+             <<"    "<<reg<<" = t;"<<endl;
+    };
+
+    switch (opcode)
+    {
+        case Emulator::ADD:
+            checked(25, "(long long)" + reg + " + " + mem);
+            break;
+
+        case Emulator::SUB:
+            checked(26, "(long long)" + reg + " - " + mem);
+            break;
+
+        case Emulator::MULT:
+            checked(27, "(long long)" + reg + " * " + mem);
+            break;
+
+        case Emulator::DIV:
+        {
+            string onError = error;
+            onError.replace(onError.find("%d"), 2, "29");
+
+            a_out<<"    if ("<<mem<<" == 0) "<<onError<<endl
+                 <<"    "<<reg<<" /= "<<mem<<";"<<endl;
+            break;
+        }
+
+        case Emulator::LOAD:
+            a_out<<"    "<<reg<<" = "<<mem<<";"<<endl;
+            break;
+
+        case Emulator::STORE:
+            a_out<<"    "<<mem<<" = "<<reg<<";"<<endl;
+
+            // the program changes its own code
+            if (indexed)
+                a_out<<"    if (a >= "<<first<<" && a <= "<<last<<") "<<Leave(a_loc + 1, "AOT_RESUME")<<endl;
+
+            else if (a_code[address])
+                a_out<<"    "<<Leave(a_loc + 1, "AOT_RESUME")<<endl;
+            break;
+
+        case Emulator::READ:
+            a_out<<"    if (!ctx->m_read(ctx->m_host, "<<address<<")) "
+                 <<Leave(a_loc + 1, "AOT_ERROR")<<endl;
+
+            if (a_code[address])
+                a_out<<"    "<<Leave(a_loc + 1, "AOT_RESUME")<<endl;
+            break;
+
+        case Emulator::WRITE:
+            a_out<<"    ctx->m_write(ctx->m_host, "<<mem<<");"<<endl;
+            break;
+
+        case Emulator::B:
+            a_out<<"    goto L"<<address<<";"<<endl;
+            break;
+
+        case Emulator::BM:
+            a_out<<"    if ("<<reg<<" < 0) goto L"<<address<<";"<<endl;
+            break;
+
+        case Emulator::BZ:
+            a_out<<"    if ("<<reg<<" == 0) goto L"<<address<<";"<<endl;
+            break;
+
+        case Emulator::BP:
+            a_out<<"    if ("<<reg<<" > 0) goto L"<<address<<";"<<endl;
+            break;
+
+        case Emulator::HALT:
+            a_out<<"    "<<Leave(a_loc, "AOT_HALT")<<endl;
+            break;
+
+        // other words do nothing when executed
+        default:
+            break;
+    }
+}
+/*void AotTranslator::TranslateWord(const int a_memory[], const int& a_loc,
+  const vector<bool>& a_code, ostream& a_out); */
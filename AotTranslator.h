@@ -0,0 +1,33 @@
+//
+//        AOT translator - translates the memory image of a Quack3200
+//        program to one C++ function that can be compiled into a shared
+//        library and run by the emulator in place of interpretation.
+//
+
+#ifndef _AOTTRANSLATOR_H
+#define _AOTTRANSLATOR_H
+
+#include "stdafx.h"
+
+class AotTranslator
+{
+
+public:
+
+    // Writes the C++ translation of a memory image
+    static void Translate(const int [], ostream&);
+
+    // Returns the hash identifying a memory image
+    static unsigned long long ImageHash(const int []);
+
+
+private:
+
+    // Finds the locations that can be executed and those that are branched to
+    static void FindCode(const int [], vector<bool>&, vector<bool>&);
+
+    // Writes the translation of the instruction at one location
+    static void TranslateWord(const int [], const int&, const vector<bool>&, ostream&);
+};
+
+#endif
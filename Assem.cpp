@@ -7,7 +7,19 @@
 
 int main(int argc, char *argv[])
 {
+    // Collect metrics if QUACK_METRICS requests them, with hardware counters if QUACK_PERF is 1
+    Metrics::EnableFromEnvironment();
+    
     Assembler assem(argc, argv);
+    
+    // Reuse the results of assembling an unchanged source if QUACK_CACHE_DIR names a cache
+    const char *cacheDir = getenv("QUACK_CACHE_DIR");
+    if (cacheDir != nullptr && *cacheDir != '\0')
+    {
+        const char *cacheMax = getenv("QUACK_CACHE_MAX");
+        assem.UseCache(cacheDir, cacheMax != nullptr ? strtoull(cacheMax, nullptr, 10)
+                                                     : AssemblyCache::DEFAULT_MAX_BYTES);
+    }
 
     // Establish the location of the labels:
     assem.PassI();
@@ -18,8 +30,83 @@ int main(int argc, char *argv[])
     // Output the symbol table and the translation
     assem.PassII();
     
+    // Optimize the translation if QUACK_OPTIMIZE is set (to anything but 0)
+    const char *optimize = getenv("QUACK_OPTIMIZE");
+    if (optimize != nullptr && *optimize != '\0' && strcmp(optimize, "0") != 0)
+        assem.Optimize();
+    
+    // Run a compiled translation of the program if QUACK_AOT names one
+    const char *native = getenv("QUACK_AOT");
+    if (native != nullptr && *native != '\0' && !assem.LoadNativeProgram(native))
+        cerr << "Translated program " << native << " could not be loaded, it will be interpreted." << endl;
+    
+    // Report the changes of the locations QUACK_WATCH names, as "first-last,location,..."
+    const char *watch = getenv("QUACK_WATCH");
+    if (watch != nullptr && *watch != '\0')
+    {
+        stringstream ranges(watch);
+        string range;
+        
+        while (getline(ranges, range, ','))
+        {
+            int first = -1, last = -1;
+            char dash;
+            stringstream parts(range);
+            
+            if (!(parts >> first))
+                first = -1;
+            else if (!(parts >> dash >> last) || dash != '-')
+                last = first;
+            
+            if (!assem.WatchMemory(first, last))
+                cerr << "Locations " << range << " could not be watched." << endl;
+        }
+    }
+    
+    // Stop the program after the number of instructions QUACK_BUDGET gives
+    const char *budget = getenv("QUACK_BUDGET");
+    if (budget != nullptr && *budget != '\0')
+        assem.SetInstructionBudget(strtoll(budget, nullptr, 10));
+    
+    // Trace each instruction executed to the standard error if QUACK_TRACE is 1
+    const char *trace = getenv("QUACK_TRACE");
+    if (trace != nullptr && strcmp(trace, "1") == 0)
+        assem.SetTrace(&cerr);
+    
+    // Connect the ports of RECV and SEND, from port 0 on, to the channels QUACK_RECV and QUACK_SEND
+    // name, as "/name,...", so that programs run by different processes can form a pipeline
+    vector<pair<shared_ptr<Channel>, bool>> channels;
+    
+    for (const char *variable : {"QUACK_RECV", "QUACK_SEND"})
+    {
+        const char *names = getenv(variable);
+        if (names == nullptr || *names == '\0')
+            continue;
+        
+        stringstream list(names);
+        string name;
+        
+        for (int port = 0; getline(list, name, ','); port++)
+        {
+            shared_ptr<Channel> channel = Channel::Open(name);
+            bool sending = strcmp(variable, "QUACK_SEND") == 0;
+            
+            if (channel == nullptr || !(sending ? assem.ConnectSend(port, channel.get())
+                                                : assem.ConnectReceive(port, channel.get())))
+                cerr << "Channel " << name << " could not be connected." << endl;
+            
+            if (channel != nullptr)
+                channels.emplace_back(channel, sending);
+        }
+    }
+    
     // Run the emulator on the Quack3200 program that was generated in Pass II.
     assem.RunProgramInEmulator();
+    
+    // Close the ends of the channels even if the program was not run, so that the other
+    // programs of the pipeline do not wait for it
+    for (const pair<shared_ptr<Channel>, bool>& end : channels)
+        end.second ? end.first->CloseSending() : end.first->CloseReceiving();
    
     // Terminate indicating all is well.  If there is an unrecoverable error, the
     // program will terminate at the point that it occurred with an exit(1) call.
@@ -8,7 +8,12 @@
 // Constructor for the assembler.  Note: passing argc and argv to the file access constructor.
 // See main program.
 // feeding in argc, argv to file to start reading file
-Assembler::Assembler(int argc, char *argv[]): m_facc(argc, argv){}     //file access class object defined
+Assembler::Assembler(int argc, char *argv[]): m_facc(argc, argv), m_listing(true), m_cacheHit(false),
+    m_objectMode(false){}     //file access class object defined
+
+// The source is copied, so the caller may release it once the assembler is constructed.
+Assembler::Assembler(const char *a_data, const size_t& a_size): m_facc(a_data, a_size), m_listing(false),
+    m_cacheHit(false), m_objectMode(false){}
 
 /*
 NAME
@@ -29,6 +34,12 @@ DESCRIPTION
 
 void Assembler::PassI()
 {
+    // the symbol table was restored from the cache
+    if (m_cacheHit)
+        return;
+    
+    Metrics::ScopedTimer timer(Metrics::TM_Parse);
+    
     Errors();        // need this to detect MULTIPLY DEFINED LABELS which are not detected by Pass II
     int loc = 0;     // Tracks the location of the instructions to be generated
 
@@ -37,7 +48,8 @@ void Assembler::PassI()
     {
         // Read the next line from the source file
         string line;
-        if(!m_facc.GetNextLine(line))
+        LineScan scan;
+        if(!m_facc.GetNextLine(line, scan))
         {
             //eliminate errors because same errors will be recorded again in Pass II
             Errors::InitErrorReporting();
@@ -48,7 +60,7 @@ void Assembler::PassI()
         }
         
         // Parse the line and get the instruction type
-        Instruction::InstructionType st =  m_inst.ParseInstruction(line);
+        Instruction::InstructionType st =  m_inst.ParseInstruction(line, scan);
 
         // If this is an end statement, there is nothing left to do in pass I
         // Pass II will determine if the end is the last statement
@@ -59,6 +71,10 @@ void Assembler::PassI()
             
             return;
         }
+        
+        // The imported symbols are resolved by the linker, wherever they are used
+        if (st == Instruction::ST_Linkage && !m_inst.IsExport() && m_objectMode)
+            m_imports.insert(m_inst.GetOperand());
             
         // Labels can only be on machine language and assembler language
         // instructions.  So, skip other instruction types.
@@ -96,13 +112,39 @@ DESCRIPTION
 
 void Assembler::PassII()
 {
+    // the translation was restored from the cache
+    if (m_cacheHit)
+    {
+        Errors::SetErrorMessages(m_cached.m_errors, m_cached.m_errorCodes);
+        
+        if (!m_listing)
+            return;
+        
+        m_listingOut.Append(m_cached.m_listing);
+        m_listingOut.Flush();
+        
+        cout<<endl<<"Press [Enter] to continue . . ."<<endl;
+        cin.get();
+        
+        return;
+    }
+    
+    Metrics::ScopedTimer timer(Metrics::TM_Translation);
+    
     Errors();         // need this to record errors using the error list.
     m_facc.Rewind();  // go to the beginning of the file.
     
     int loc = 0;      // Tracks the location of the instructions to be generated.
     
-    cout<<"TRANSLATION OF PROGRAM: "<<endl<<endl;
-    cout<<"LOCATION "<<"  CONTENTS"<<"     ORIGINAL STATEMENT"<<endl;
+    // the cache keeps a copy of the listing
+    if (m_cache && m_listing)
+        m_listingOut.Capture(&m_cached.m_listing);
+    
+    if (m_listing)
+    {
+        m_listingOut.Append("TRANSLATION OF PROGRAM: \n\n");
+        m_listingOut.Append("LOCATION   CONTENTS     ORIGINAL STATEMENT\n");
+    }
 
     // used to check if there is an END statement
     bool endInstr = false;
@@ -113,12 +155,18 @@ void Assembler::PassII()
     // used to check if there is any instructions before location 100
     bool instrBeforeHundred = false;
     
+    // the extent of the object module is found from the statements occupying memory
+    m_module = ObjectModule();
+    m_module.m_first = Quack3200::MEMSZ;
+    m_module.m_end = 0;
+    
     // Successively process each line of source code.
     for( ; ; )
     {
         // Read the next line from the source file.
         string line;
-        if(!m_facc.GetNextLine(line))
+        LineScan scan;
+        if(!m_facc.GetNextLine(line, scan))
         {
             // if there is no END instruction
             if (!endInstr)
@@ -127,16 +175,31 @@ void Assembler::PassII()
                 Errors::RecordError(17, "*****");
             }
             
-            // if there is no HALT instruction
-            if (!haltInstr)
+            m_module.m_halt = haltInstr;
+            
+            // if there is no HALT instruction, unless the object module is a library
+            if (!haltInstr && !m_objectMode)
             {
                 //Code 14: No HALT Instruction Detected for Execution Termination
                 Errors::RecordError(14, "*****");
             }
             
+            // the translation is complete, do not time the pause
+            timer.Stop();
+            
+            // the warning and the pause are part of the listing
+            if (!m_listing)
+                return;
+            
             // if there is statements before location 100
             if (instrBeforeHundred)
-                cout<<endl<<endl<<endl<<"<WARNING: Instructions Before Location 100 Will Not Be Executed>"<<endl;
+                m_listingOut.Append("\n\n\n<WARNING: Instructions Before Location 100 Will Not Be Executed>\n");
+            
+            // the listing must be out before the pause
+            m_listingOut.Flush();
+            
+            if (m_cache)
+                StoreInCache();
             
             //Now going to report errors or run the emulator
             cout<<endl<<"Press [Enter] to continue . . ."<<endl;
@@ -146,15 +209,20 @@ void Assembler::PassII()
         }
        
         // Parse the line and get the instruction type
-        Instruction::InstructionType st =  m_inst.ParseInstruction(line);
+        Instruction::InstructionType st =  m_inst.ParseInstruction(line, scan);
         
         string content; // holds the numeric translation
+        
+        // == true if the statement occupies memory of the object module
+        bool occupies = false;
             
         //as long as we have not reached the END instruction
         if (!endInstr)
         {
             if (st == Instruction::ST_MachineLanguage)
             {
+                occupies = true;
+                
                 if (haltInstr)
                 {
                     //Code 13: Machine Language Statements Are NOT Allowed After the HALT Instruction
@@ -181,8 +249,12 @@ void Assembler::PassII()
                     haltInstr = true;
                     
                     //address part of HALT instruction translation
-                    content += "00000";
+                    content.append(Quack3200::ADDRESS_DIGITS, '0');
                 }
+                
+                // JOIN, 17, names only the register holding the thread to wait for
+                else if (m_inst.GetOpcode() == "17")
+                    content.append(Quack3200::ADDRESS_DIGITS, '0');
             
                 else
                 {
@@ -190,25 +262,38 @@ void Assembler::PassII()
                   
                     int locForTranslation = 0;
                     
-                    //if symbol is not undefined and not multiply defined
-                    if (!(HasSymbolError(line, content, locForTranslation)))
+                    //if symbol is imported, or is not undefined and not multiply defined
+                    if (ResolveSymbol(line, loc, content, locForTranslation))
                     {
                         //locForTranslation holds the addres portion of the CONTENT of translation
                         //need to replace the actual operand with its location in symbol table
                         
-                        string address = to_string(locForTranslation);
-                                
-                        //append zeros for the remaining digits of the address
-                        //useful when address is less than 5 digits
-                        for (size_t i = 0; i < 5 - address.size(); i++)
-                            content += '0';
-                        
+                        //the address has leading zeros up to ADDRESS_DIGITS (5) digits
                         //now content holds the full translation
-                        content += address;
+                        Numeric::AppendPadded(content, locForTranslation, Quack3200::ADDRESS_DIGITS);
                     }
                 }
             }
                         
+            //EXPORT or IMPORT only names a symbol
+            else if (st == Instruction::ST_Linkage)
+            {
+                int locForTranslation = 0;
+                
+                //the exported symbol must be defined once in the module
+                if (m_inst.IsExport())
+                {
+                    if (!HasSymbolError(line, content, locForTranslation))
+                        m_module.m_exports[m_inst.GetOperand()] = locForTranslation;
+                }
+                
+                else if (m_symtab.LookupSymbol(m_inst.GetOperand(), locForTranslation))
+                {
+                    //Code 36: Imported Symbol Is Defined In The Module
+                    Errors::RecordError(36, line);
+                }
+            }
+            
             //otherwise there is a COMMENT, END, or AssemblerInstruction (ORG, DS, DC)
             else
             {
@@ -219,8 +304,27 @@ void Assembler::PassII()
                     //so we do a quick parsing
                     string assemLanType = QuickParse(line, content);
                     
+                    //the constant of DC with a symbolic operand is the location of the symbol
+                    if (assemLanType == "DC" && !m_inst.IsNumericOperand())
+                    {
+                        int locForTranslation = 0;
+                        
+                        //nothing is translated if the symbol is undefined or multiply defined
+                        if (!ResolveSymbol(line, loc, content, locForTranslation))
+                            content = "";
+                        
+                        else
+                        {
+                            content.clear();
+                            Numeric::AppendPadded(content, locForTranslation, Quack3200::WORD_DIGITS);
+                        }
+                    }
+                    
+                    occupies = (assemLanType != "ORG");
+                    
                     //if HALT instruction is not visited and we have a statement with a DS or DC
-                    if ((!haltInstr) && (assemLanType != "ORG"))
+                    //a library module has no HALT instruction
+                    if ((!haltInstr) && (assemLanType != "ORG") && !m_objectMode)
                     {
                         //Code 12: Assembler Language Statements Are Not Allowed Before HALT Instruction
                         Errors::RecordError(12, line);
@@ -265,7 +369,15 @@ void Assembler::PassII()
         DisplayTranslation(loc, content, line, st);
         
         //update location for next instruction
-        loc = m_inst.LocationNextInstruction(loc);
+        int nextLoc = m_inst.LocationNextInstruction(loc);
+        
+        if (occupies)
+        {
+            m_module.m_first = min(m_module.m_first, loc);
+            m_module.m_end = max(m_module.m_end, nextLoc);
+        }
+        
+        loc = nextLoc;
         
         //to give warning for instructions before 100th location
         if (loc < 100 && loc != 0)
@@ -298,8 +410,14 @@ DESCRIPTION
 
 bool Assembler::HasSymbolError(const string& a_line, string& a_content, int& a_locForTranslation)
 {
+    bool isDefined;
+    {
+        Metrics::ScopedTimer timer(Metrics::TM_SymbolResolution, Metrics::HG_SymbolLookupNanos);
+        isDefined = m_symtab.LookupSymbol(m_inst.GetOperand(), a_locForTranslation);
+    }
+    
     //if the symbol is undefined
-    if (!(m_symtab.LookupSymbol(m_inst.GetOperand(), a_locForTranslation)))
+    if (!isDefined)
     {
         //Code 7: Undefined Symbol
         Errors::RecordError(7, a_line);
@@ -312,9 +430,8 @@ bool Assembler::HasSymbolError(const string& a_line, string& a_content, int& a_l
     
     if (a_locForTranslation == multiplyDefinedSymbol)
     {
-        // show question marks for translation of multiply defined symbols
-        for (int i = 0; i < 5; i++)
-            a_content += '?';
+        // show question marks for the address of multiply defined symbols
+        a_content.append(Quack3200::ADDRESS_DIGITS, '?');
                           
         //Code 6: Multiply Defined Symbol
         Errors::RecordError(6, a_line);
@@ -328,6 +445,52 @@ bool Assembler::HasSymbolError(const string& a_line, string& a_content, int& a_l
   string& a_content, int& a_locForTranslation); */
 
 
+/*
+NAME
+ 
+    ResolveSymbol - Finds the location of the operand for the linker
+
+SYNOPSIS
+ 
+    bool ResolveSymbol(const string& a_line, const int& a_loc, string& a_content,
+        int& a_locForTranslation);
+
+DESCRIPTION
+ 
+   This function places in "a_locForTranslation" the location of the
+   symbolic operand of the statement "a_line" at location "a_loc", as
+   HasSymbolError() does. In object mode, the word at "a_loc" is recorded
+   as a relocation, so that the linker moves the location with the module,
+   or as an import if the symbol is imported, whose location is 0 until
+   the linker adds the location exported by another module.
+ 
+   Returns true - if the location of the symbol is known or imported
+   Returns false - if the symbol is undefined or multiply defined
+*/
+
+bool Assembler::ResolveSymbol(const string& a_line, const int& a_loc, string& a_content,
+                              int& a_locForTranslation)
+{
+    if (m_objectMode && m_imports.count(m_inst.GetOperand()) != 0)
+    {
+        m_module.m_imports.push_back(make_pair(a_loc, m_inst.GetOperand()));
+        a_locForTranslation = 0;
+        
+        return true;
+    }
+    
+    if (HasSymbolError(a_line, a_content, a_locForTranslation))
+        return false;
+    
+    if (m_objectMode)
+        m_module.m_relocations.push_back(a_loc);
+    
+    return true;
+}
+/*bool Assembler::ResolveSymbol(const string& a_line, const int& a_loc, string& a_content,
+  int& a_locForTranslation); */
+
+
 /*
 NAME
  
@@ -341,46 +504,24 @@ DESCRIPTION
  
    This function generates a translation for a defined constant
    based on its sign (negative or positive) and the number of
-   its digits. The result is placed in "a_content".
+   its digits. The result is placed in "a_content". A symbolic
+   operand is translated by PassII().
  
 */
 
 void Assembler::DefinedConstantTranslation(string& a_content) const
 {
-    //need to determine if number is positive or negative
-    //initally assume the number is positive
-    //bc max value for a constant = 99,999,999 (8 characters)
-    int maxChar = 8;
-        
-    //if number is negative
-    if (m_inst.GetOperandValue() < 0)
-    {
-        //bc min value for a constant = -99,999,999 (9 characters)
-        maxChar = 9;
-        
-        //stick the sign in front of translation
+    if (!m_inst.IsNumericOperand())
+        return;
+    
+    int value = m_inst.GetOperandValue();
+    
+    //stick the sign of a negative constant in front of translation
+    if (value < 0)
         a_content += '-';
-    }
-        
-    string operand = m_inst.GetOperand();
-     
-    //add zeros for remaining digits of constant
-    //useful when constant has less than 8 digits
-    for (size_t i = 0; i < (maxChar - operand.size()); i++)
-            a_content += '0';
-        
-    //now append the digits of the positive constant
-    if (m_inst.GetOperandValue() >= 0)
-        a_content += operand;
-        
-    //if constant is negative
-    else
-    {
-        //skip the negative sign because it is already added
-        //now append the digits of negative constant
-        for (size_t i = 1; i < operand.size(); i++)
-            a_content += operand[i];
-    }
+    
+    //the digits of the constant have leading zeros up to WORD_DIGITS (8) digits
+    Numeric::AppendPadded(a_content, value < 0 ? -value : value, Quack3200::WORD_DIGITS);
 }
 /*void Assembler::DefinedConstantTranslation(string& a_content) const; */
 
@@ -405,20 +546,25 @@ DESCRIPTION
 
 string Assembler::QuickParse(const string& a_line, string& a_content) const
 {
-    // holds the capital form of a_line
-    string capitalForm;
-    
-    // need the capital form of assembler language words to detect these instructions
-    for (size_t i = 0; i < a_line.size(); i++)
-        capitalForm += toupper(a_line[i]);
-    
     // will be either DC, DS, or ORG
     string assemLanType;
     
-    //extract the second word in the line since formatting = LABEL ASSEMLAN OPERAND
-    stringstream instruction(capitalForm);
-    instruction>>assemLanType;
-    instruction>>assemLanType;
+    // the parser usually knows the capital form of the first two words
+    string firstWord;
+    if (!m_inst.GetLeadingWords(firstWord, assemLanType))
+    {
+        // holds the capital form of a_line
+        string capitalForm;
+        
+        // need the capital form of assembler language words to detect these instructions
+        for (size_t i = 0; i < a_line.size(); i++)
+            capitalForm += toupper(a_line[i]);
+        
+        //extract the second word in the line since formatting = LABEL ASSEMLAN OPERAND
+        stringstream instruction(capitalForm);
+        instruction>>assemLanType;
+        instruction>>assemLanType;
+    }
     
     if (assemLanType == "DC")
     {
@@ -459,33 +605,56 @@ DESCRIPTION
  
     This function outputs the "a_loc", "a_content", and "a_line" as
     the location, contents and the original statement in three columns
-    and inserts the translation into memory. This is the translation
-    generated by PassII().
+    through the listing writer and inserts the translation into memory. This is the translation
+    generated by PassII(). Only the insertion is performed when the
+    listing is disabled.
 */
 
 void Assembler::DisplayTranslation(const int& a_loc, const string& a_content,
                                    const string& a_line, const Instruction::InstructionType& a_st) 
 {
-    //setting up the formatting of the columns
-    cout<<setw(11)<<left;
+    if (!m_listing)
+    {
+        //only machine language statements and DC have contents to insert
+        if (a_st != Instruction::ST_End && a_st != Instruction::ST_Comment && a_st != Instruction::ST_Linkage
+            && a_content != "")
+            LoadWord(a_loc, Numeric::Value(a_content));
+        
+        return;
+    }
+    
+    //the columns are as wide as "setw(11) << left" used to make them
     
-    //END and COMMENTS have no content or location for translation
-    if (a_st == Instruction::ST_End || a_st == Instruction::ST_Comment)
+    //END, COMMENTS, EXPORT and IMPORT have no content or location for translation
+    if (a_st == Instruction::ST_End || a_st == Instruction::ST_Comment || a_st == Instruction::ST_Linkage)
     {
         if (a_line != "")
-            cout<<setw(25)<<"      "<<setw(10)<<a_line<<endl;
+        {
+            m_listingOut.Pad(25);
+            m_listingOut.AppendLeft(a_line, 10);
+            m_listingOut.Append('\n');
+        }
     }
     
     //DS and ORG have only location for translation
     else if (a_content == "")
-        cout<<a_loc<<setw(14)<<"      "<<setw(10)<<a_line<<endl;
+    {
+        m_listingOut.AppendLeft(a_loc, 11);
+        m_listingOut.Pad(14);
+        m_listingOut.AppendLeft(a_line, 10);
+        m_listingOut.Append('\n');
+    }
     
     //LOCATION -> CONTENT -> ORIGINAL STATEMENT
     else
     {
-        cout<<a_loc<<setw(8)<<a_content<<"      "<<setw(10)<<a_line<<endl;
-        int content_as_num = stoi(a_content);
-        m_emul.InsertMemory(a_loc, content_as_num);
+        m_listingOut.AppendLeft(a_loc, 11);
+        m_listingOut.AppendLeft(a_content, 8);
+        m_listingOut.Append("      ", 6);
+        m_listingOut.AppendLeft(a_line, 10);
+        m_listingOut.Append('\n');
+        
+        LoadWord(a_loc, Numeric::Value(a_content));
     }
     
     return;
@@ -494,6 +663,110 @@ void Assembler::DisplayTranslation(const int& a_loc, const string& a_content,
   const string& a_line, const Instruction::InstructionType& a_st); */
 
 
+/*
+NAME
+ 
+    LoadWord - Inserts one word of the translation into memory
+
+SYNOPSIS
+ 
+    void LoadWord(const int& a_loc, const int& a_contents);
+
+DESCRIPTION
+ 
+    This function inserts "a_contents" into location "a_loc" of the
+    emulator memory and accounts for it in the image load metrics.
+*/
+
+void Assembler::LoadWord(const int& a_loc, const int& a_contents)
+{
+    Metrics::ScopedTimer timer(Metrics::TM_ImageLoad);
+    
+    m_emul.InsertMemory(a_loc, a_contents);
+    Metrics::Add(Metrics::CT_ImageWords, 1);
+}
+/*void Assembler::LoadWord(const int& a_loc, const int& a_contents); */
+
+
+/*
+NAME
+ 
+    Optimize - Rewrites the translation in memory so that it runs faster
+
+SYNOPSIS
+ 
+    int Optimize();
+
+DESCRIPTION
+ 
+    This function applies Optimizer::Optimize() to the translation made
+    in Pass II, if there is no error. It is called after PassII() and
+    before RunProgramInEmulator(); the listing shows the translation
+    before it was optimized.
+ 
+    Returns - the number of words of memory changed
+*/
+
+int Assembler::Optimize()
+{
+    if (Errors::NumErrors() != 0)
+        return 0;
+    
+    vector<int> image(m_emul.GetMemory(), m_emul.GetMemory() + Emulator::MEMSZ);
+    int changed = Optimizer::Optimize(image.data());
+    
+    for (int loc = 0; changed != 0 && loc < Emulator::MEMSZ; loc++)
+    {
+        if (image[loc] != m_emul.GetMemory()[loc])
+            m_emul.InsertMemory(loc, image[loc]);
+    }
+    
+    Metrics::Add(Metrics::CT_OptimizedWords, changed);
+    
+    return changed;
+}
+/*int Assembler::Optimize(); */
+
+
+/*
+NAME
+ 
+    GetObjectModule - Returns the object module made by Pass II
+
+SYNOPSIS
+ 
+    ObjectModule GetObjectModule() const;
+
+DESCRIPTION
+ 
+    This function returns the translation made by PassII() in object
+    mode as a relocatable object module: the non-zero words from the
+    first location of a statement occupying memory to the last one, the
+    relocations, the imports and the exports recorded by Pass II, and
+    whether it has the HALT instruction.
+ 
+    Returns - the object module
+*/
+
+ObjectModule Assembler::GetObjectModule() const
+{
+    ObjectModule module = m_module;
+    
+    // a module with no statement occupying memory is empty
+    if (module.m_first > module.m_end)
+        module.m_first = module.m_end = 0;
+    
+    for (int loc = module.m_first; loc < module.m_end; loc++)
+    {
+        if (m_emul.GetMemory()[loc] != 0)
+            module.m_words.push_back(make_pair(loc, m_emul.GetMemory()[loc]));
+    }
+    
+    return module;
+}
+/*ObjectModule Assembler::GetObjectModule() const; */
+
+
 /*
 NAME
  
@@ -511,6 +784,9 @@ DESCRIPTION
     (2) If there is an error, then the function calls
     a function to display all errors
  
+    (3) The changes of the locations given to WatchMemory() are
+    displayed after the results of the program
+ 
 */
 
 void Assembler::RunProgramInEmulator()
@@ -520,7 +796,16 @@ void Assembler::RunProgramInEmulator()
     //we run emulator only if there is no error
     if (Errors::NumErrors() == 0)
     {
-        m_emul.RunProgram();
+        {
+            Metrics::ScopedTimer timer(Metrics::TM_Emulation);
+            m_emul.RunProgram();
+            
+            // a SEND or RECV waits for the program at the other end of its channel
+            m_emul.AwaitChannels();
+        }
+        
+        Metrics::Add(Metrics::CT_Instructions, m_emul.GetInstructionCount());
+        Metrics::Add(Metrics::CT_RuntimeErrors, Errors::NumErrors() / 2);
         
         //if there are run-time errors
         if (Errors::NumErrors() != 0)
@@ -528,14 +813,108 @@ void Assembler::RunProgramInEmulator()
             cout<<endl<<endl<<"RUN-TIME ";
             Errors::DisplayErrors();
         }
+        
+        //if locations were watched
+        if (m_emul.GetWatchHitCount() != 0)
+        {
+            cout<<endl<<"CHANGES OF WATCHED LOCATIONS: "<<m_emul.GetWatchHitCount()<<endl;
+            
+            for (const Emulator::WatchHit& hit : m_emul.GetWatchHits())
+            {
+                cout<<"LOCATION# "<<hit.m_location<<" CHANGED FROM "<<hit.m_oldValue
+                    <<" TO "<<hit.m_newValue<<" BY INSTRUCTION AT "<<hit.m_pc
+                    <<" (INSTRUCTION "<<hit.m_instruction<<")"<<endl;
+            }
+            
+            if (m_emul.GetWatchHitCount() > (long long)m_emul.GetWatchHits().size())
+                cout<<"(ONLY THE FIRST "<<m_emul.GetWatchHits().size()<<" ARE DISPLAYED)"<<endl;
+        }
     }
         
     //if at least one error has been recorded throughout the translation process 
     else
     {
+        Metrics::Add(Metrics::CT_AssemblyErrors, Errors::NumErrors() / 2);
+        
         cout<<"NUMBER OF ERRORS: "<<Errors::NumErrors()/2<<endl;
         Errors::DisplayErrors();
     }
 }
 /*void Assembler::RunProgramInEmulator(); */
 
+
+
+/*
+NAME
+ 
+    UseCache - Reuses or keeps the results of assembling the source in a cache directory
+
+SYNOPSIS
+ 
+    void UseCache(const string& a_dir, const unsigned long long& a_maxBytes);
+
+DESCRIPTION
+ 
+    This function looks up the source in the assembly cache kept in the
+    directory "a_dir". If it is found, the symbol table, the translation
+    in memory, the errors and the listing are restored and PassI() and
+    PassII() only report them. Otherwise PassII() adds its results to
+    the cache, which is kept under "a_maxBytes" bytes.
+*/
+
+void Assembler::UseCache(const string& a_dir, const unsigned long long& a_maxBytes)
+{
+    m_cache.reset(new AssemblyCache(a_dir, a_maxBytes, m_facc.GetData(), m_facc.GetSize()));
+    m_cacheHit = m_cache->Lookup(m_cached);
+    
+    if (!m_cacheHit)
+    {
+        Metrics::Add(Metrics::CT_CacheMisses, 1);
+        return;
+    }
+    
+    Metrics::Add(Metrics::CT_CacheHits, 1);
+    
+    Errors();   // need this to detect MULTIPLY DEFINED LABELS when the symbol table is displayed
+    m_symtab.SetSymbols(m_cached.m_symbols);
+    
+    for (auto& word : m_cached.m_image)
+        LoadWord(word.first, word.second);
+}
+/*void Assembler::UseCache(const string& a_dir, const unsigned long long& a_maxBytes); */
+
+
+/*
+NAME
+ 
+    StoreInCache - Adds the results of assembling the source to the cache
+
+SYNOPSIS
+ 
+    void StoreInCache();
+
+DESCRIPTION
+ 
+    This function adds the symbol table, the non-zero words of the
+    translation, the errors recorded so far and the listing captured
+    during Pass II to the cache.
+*/
+
+void Assembler::StoreInCache()
+{
+    m_listingOut.Capture(nullptr);
+    
+    m_cached.m_symbols = m_symtab.GetSymbols();
+    m_cached.m_errors = Errors::GetErrorMessages();
+    m_cached.m_errorCodes = Errors::GetErrorCodes();
+    m_cached.m_image.clear();
+    
+    const int *memory = m_emul.GetMemory();
+    
+    for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+        if (memory[loc] != 0)
+            m_cached.m_image.push_back(make_pair(loc, memory[loc]));
+    
+    m_cache->Store(m_cached);
+}
+/*void Assembler::StoreInCache(); */
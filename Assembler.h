@@ -11,12 +11,22 @@ class Assembler
 public:
     
     Assembler(int argc, char *argv[]);
+    
+    // Assembles a source held in memory, without a listing
+    Assembler(const char *a_data, const size_t& a_size);
 
     // Pass I - establish the locations of the symbols
     void PassI();
     
     // Display the symbols in the symbol table
     void DisplaySymbolTable() const {m_symtab.DisplaySymbolTable();}
+    
+    // Records the errors of the symbol table without displaying it
+    void CheckSymbolTable() const {m_symtab.RecordSymbolErrors();}
+    
+    // The symbols and the translation in memory
+    const map<string, int>& GetSymbols() const {return m_symtab.GetSymbols();}
+    const int *GetImage() const {return m_emul.GetMemory();}
 
     // Pass II - generate a translation
     void PassII();
@@ -24,6 +34,9 @@ public:
     // Checks if symbol is defined only once
     bool HasSymbolError(const string&, string&, int&);
     
+    // Finds the location of the operand and records how the linker must change it
+    bool ResolveSymbol(const string&, const int&, string&, int&);
+    
     // Translates a DC statement
     void DefinedConstantTranslation (string&) const;
     
@@ -34,13 +47,64 @@ public:
     void DisplayTranslation(const int&, const string&,
             const string&, const Instruction::InstructionType&);
     
+    // Inserts one word of the translation into memory
+    void LoadWord(const int&, const int&);
+    
+    // Rewrites the translation in memory so that it runs faster
+    int Optimize();
+    
     // Run emulator on the translation
     void RunProgramInEmulator();
     
+    // Writes the translation as a C++ program for AOT compilation
+    void TranslateToNative(ostream& a_out) const {AotTranslator::Translate(m_emul.GetMemory(), a_out);}
+    
+    // Runs a compiled translation of the program instead of interpreting it
+    bool LoadNativeProgram(const string& a_path) {return m_emul.LoadNative(a_path);}
+    
+    // Reports the changes the program makes to a range of locations when it runs
+    bool WatchMemory(const int& a_first, const int& a_last) {return m_emul.Watch(a_first, a_last);}
+    
+    // Stops the program with a run-time error once it has executed a number of instructions
+    void SetInstructionBudget(const long long& a_budget) {m_emul.SetInstructionBudget(a_budget);}
+    
+    // Writes the location and contents of each instruction executed to a stream
+    void SetTrace(ostream *a_trace) {m_emul.SetTrace(a_trace);}
+    
+    // Connects a port of RECV, or of SEND, to a channel
+    bool ConnectReceive(const int& a_port, Channel *a_channel) {return m_emul.ConnectReceive(a_port, a_channel);}
+    bool ConnectSend(const int& a_port, Channel *a_channel) {return m_emul.ConnectSend(a_port, a_channel);}
+    
+    // Reuses or keeps the results of assembling the source in a cache directory
+    void UseCache(const string&, const unsigned long long&);
+    
+    // Enables or disables the listing output of Pass II
+    void SetListing(const bool& a_listing) {m_listing = a_listing;}
+    
+    // Writes the listing of Pass II to a file instead of the standard output
+    bool SetListingFile(const string& a_path) {return m_listingOut.Open(a_path);}
+    
+    // Assembles the source as a relocatable object module, which may be a library without HALT
+    void SetObjectMode(const bool& a_object) {m_objectMode = a_object;}
+    
+    // Returns the object module made by Pass II in object mode
+    ObjectModule GetObjectModule() const;
+    
 private:
 
+    // Adds the results of assembling the source to the cache
+    void StoreInCache();
+
     FileAccess m_facc;          // File Access object
     SymbolTable m_symtab;       // Symbol table object
     Instruction m_inst;         // Instruction object
     Emulator m_emul;            // Emulator object
+    bool m_listing;             // == true if Pass II outputs the translation
+    ListingWriter m_listingOut; // Destination of the listing
+    unique_ptr<AssemblyCache> m_cache;  // Cache of assembled sources, nullptr if not used
+    bool m_cacheHit;                    // == true if the results were found in the cache
+    CachedAssembly m_cached;            // The results found in or added to the cache
+    bool m_objectMode;                  // == true if the source is assembled as an object module
+    set<string> m_imports;              // The symbols imported by the object module
+    ObjectModule m_module;              // The object module, without its words
 };
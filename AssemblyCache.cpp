@@ -0,0 +1,370 @@
+//
+//  Implementation of the assembly cache class.
+//
+//  Each entry is one file named by the hexadecimal FNV-1a hash of the
+//  assembler version and the source. It is written to a temporary file
+//  in the same directory and renamed into place, so that processes
+//  sharing the directory only ever see complete entries. A lookup
+//  touches the modification time of the entry, which eviction uses as
+//  the time of last use.
+//
+
+#include "stdafx.h"
+#include "AssemblyCache.h"
+#include <filesystem>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+const char *const AssemblyCache::VERSION = "Quack3200 assembler 4";
+
+namespace
+{
+
+// Marks the first line of every entry
+const char *const MAGIC = "QUACKCACHE";
+
+// Temporary files older than this were left by a process that did not finish
+const auto STALE_TEMPORARY = chrono::minutes(10);
+
+// Adds "a_size" bytes to a 64-bit FNV-1a hash
+unsigned long long Fnv1a(unsigned long long a_hash, const char *a_data, const size_t& a_size)
+{
+    for (size_t i = 0; i < a_size; i++)
+    {
+        a_hash ^= (unsigned char)a_data[i];
+        a_hash *= 1099511628211ULL;
+    }
+
+    return a_hash;
+}
+
+// Writes a string of any contents
+void WriteString(ostream& a_out, const string& a_str)
+{
+    a_out<<a_str.size()<<'\n';
+    a_out.write(a_str.data(), a_str.size());
+    a_out<<'\n';
+}
+
+// Returns the number of bytes left to read, so that no count read from an entry exceeds them
+size_t Remaining(istream& a_in)
+{
+    streampos here = a_in.tellg();
+
+    if (here < 0 || !a_in.seekg(0, ios::end))
+        return 0;
+
+    streamoff left = a_in.tellg() - here;
+    a_in.seekg(here);
+
+    return left > 0 ? (size_t)left : 0;
+}
+
+// Reads a string written by WriteString()
+bool ReadString(istream& a_in, string& a_str)
+{
+    size_t size;
+
+    if (!(a_in>>size) || a_in.get() != '\n' || size > Remaining(a_in))
+        return false;
+
+    a_str.resize(size);
+    a_in.read(&a_str[0], size);
+
+    return a_in.get() == '\n';
+}
+
+}
+
+
+/*
+NAME
+
+    AssemblyCache - Uses a cache directory for one source
+
+SYNOPSIS
+
+    AssemblyCache(const string& a_dir, const unsigned long long& a_maxBytes,
+                  const char *a_data, const size_t& a_size);
+
+DESCRIPTION
+
+    This constructor names the entry of the source "a_data" of "a_size"
+    bytes in the directory "a_dir", which is created if needed and kept
+    under "a_maxBytes" bytes.
+*/
+
+AssemblyCache::AssemblyCache(const string& a_dir, const unsigned long long& a_maxBytes,
+                             const char *a_data, const size_t& a_size):
+m_dir(a_dir), m_maxBytes(a_maxBytes), m_sourceSize(a_size)
+{
+    unsigned long long key = Fnv1a(14695981039346656037ULL, VERSION, strlen(VERSION) + 1);
+    key = Fnv1a(key, a_data, a_size);
+
+    // an independent hash guards against two sources with the same key
+    m_check = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = a_size; i > 0; i--)
+        m_check = (m_check ^ (unsigned char)a_data[i - 1]) * 0x100000001b3ULL + (m_check >> 29);
+
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", key);
+
+    error_code ec;
+    filesystem::create_directories(m_dir, ec);
+
+    m_path = (filesystem::path(m_dir) / (string(name) + ".qkc")).string();
+}
+
+
+/*
+NAME
+
+    Lookup - Finds the results of assembling the source
+
+SYNOPSIS
+
+    bool Lookup(CachedAssembly& a_entry);
+
+DESCRIPTION
+
+    This function reads the entry of the source into "a_entry" and marks
+    it as the most recently used. Entries that are incomplete, made by
+    another version of the assembler or made from another source with
+    the same key are ignored.
+
+    Returns true - if the entry was found
+    Returns false - Otherwise (the source must be assembled)
+*/
+
+bool AssemblyCache::Lookup(CachedAssembly& a_entry)
+{
+    ifstream in(m_path, ios::in | ios::binary);
+
+    if (!in)
+        return false;
+
+    string magic, version;
+    size_t sourceSize;
+    unsigned long long check;
+
+    if (!(in>>magic) || magic != MAGIC || in.get() != ' ' || !ReadString(in, version) || version != VERSION)
+        return false;
+
+    if (!(in>>sourceSize>>check) || sourceSize != m_sourceSize || check != m_check)
+        return false;
+
+    CachedAssembly entry;
+    size_t count;
+
+    if (!(in>>count))
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        string symbol;
+        int loc;
+
+        if (!ReadString(in, symbol) || !(in>>loc))
+            return false;
+
+        entry.m_symbols[symbol] = loc;
+    }
+
+    // each word is written as two numbers on a line
+    if (!(in>>count) || count > Remaining(in))
+        return false;
+
+    entry.m_image.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+        if (!(in>>entry.m_image[i].first>>entry.m_image[i].second)
+            || entry.m_image[i].first < 0 || entry.m_image[i].first >= Emulator::MEMSZ)
+            return false;
+
+    if (!(in>>count) || count > Remaining(in))
+        return false;
+
+    entry.m_errors.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+        if (!ReadString(in, entry.m_errors[i]))
+            return false;
+
+    // each error has a statement and a message
+    entry.m_errorCodes.resize(count / 2);
+
+    for (size_t i = 0; i < count / 2; i++)
+        if (!(in>>entry.m_errorCodes[i]))
+            return false;
+
+    string trailer;
+
+    if (!ReadString(in, entry.m_listing) || !(in>>trailer) || trailer != "END")
+        return false;
+
+    a_entry = move(entry);
+
+    // the entry is now the most recently used
+    error_code ec;
+    filesystem::last_write_time(m_path, filesystem::file_time_type::clock::now(), ec);
+
+    return true;
+}
+/*bool AssemblyCache::Lookup(CachedAssembly& a_entry); */
+
+
+/*
+NAME
+
+    Store - Stores the results of assembling the source
+
+SYNOPSIS
+
+    bool Store(const CachedAssembly& a_entry);
+
+DESCRIPTION
+
+    This function writes "a_entry" to a temporary file and renames it to
+    the entry of the source, replacing any entry with the same name in
+    one step. The least recently used entries are then removed if the
+    directory is over its size limit.
+
+    Returns true - if the entry was stored
+    Returns false - Otherwise (the cache is left unchanged)
+*/
+
+bool AssemblyCache::Store(const CachedAssembly& a_entry)
+{
+    // unique among the processes and the stores of this process
+    static atomic<unsigned> sequence(0);
+    string temporary = m_path + ".tmp." + to_string(getpid()) + "." + to_string(sequence++);
+
+    {
+        ofstream out(temporary, ios::out | ios::binary | ios::trunc);
+
+        out<<MAGIC<<' ';
+        WriteString(out, VERSION);
+        out<<m_sourceSize<<' '<<m_check<<'\n';
+
+        out<<a_entry.m_symbols.size()<<'\n';
+        for (auto& symbol : a_entry.m_symbols)
+        {
+            WriteString(out, symbol.first);
+            out<<symbol.second<<'\n';
+        }
+
+        out<<a_entry.m_image.size()<<'\n';
+        for (auto& word : a_entry.m_image)
+            out<<word.first<<' '<<word.second<<'\n';
+
+        out<<a_entry.m_errors.size()<<'\n';
+        for (const string& error : a_entry.m_errors)
+            WriteString(out, error);
+
+        for (const int& code : a_entry.m_errorCodes)
+            out<<code<<'\n';
+
+        WriteString(out, a_entry.m_listing);
+        out<<"END\n";
+
+        out.close();
+
+        if (!out)
+        {
+            error_code ec;
+            filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+
+    error_code ec;
+    filesystem::rename(temporary, m_path, ec);
+
+    if (ec)
+    {
+        filesystem::remove(temporary, ec);
+        return false;
+    }
+
+    Evict();
+
+    return true;
+}
+/*bool AssemblyCache::Store(const CachedAssembly& a_entry); */
+
+
+/*
+NAME
+
+    Evict - Removes the least recently used entries beyond the size limit
+
+SYNOPSIS
+
+    void Evict();
+
+DESCRIPTION
+
+    This function removes the entries with the oldest modification times
+    until the entries of the cache directory fit in its size limit, and
+    removes temporary files abandoned by processes that did not finish a
+    store. Files removed by other processes at the same time are skipped.
+*/
+
+void AssemblyCache::Evict()
+{
+    struct Entry
+    {
+        filesystem::file_time_type m_used;
+        unsigned long long m_size;
+        filesystem::path m_path;
+    };
+
+    vector<Entry> entries;
+    unsigned long long total = 0;
+    auto now = filesystem::file_time_type::clock::now();
+
+    error_code ec;
+
+    for (filesystem::directory_iterator it(m_dir, ec), end; !ec && it != end; it.increment(ec))
+    {
+        error_code entryEc;
+        const filesystem::path& path = it->path();
+        auto used = filesystem::last_write_time(path, entryEc);
+        auto size = filesystem::file_size(path, entryEc);
+
+        if (entryEc)
+            continue;
+
+        if (path.extension() == ".qkc")
+        {
+            entries.push_back({used, size, path});
+            total += size;
+        }
+
+        else if (path.string().find(".qkc.tmp.") != string::npos && now - used > STALE_TEMPORARY)
+            filesystem::remove(path, entryEc);
+    }
+
+    if (total <= m_maxBytes)
+        return;
+
+    sort(entries.begin(), entries.end(), [](const Entry& a_lhs, const Entry& a_rhs)
+    {
+        return a_lhs.m_used < a_rhs.m_used;
+    });
+
+    for (const Entry& entry : entries)
+    {
+        if (total <= m_maxBytes)
+            break;
+
+        filesystem::remove(entry.m_path, ec);
+        total -= entry.m_size;
+    }
+}
+/*void AssemblyCache::Evict(); */
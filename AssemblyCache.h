@@ -0,0 +1,57 @@
+//
+//        Assembly cache - keeps the results of assembling a source file in
+//        a directory, named by a hash of the source and the assembler
+//        version, so that an unchanged source is not assembled again.
+//        Entries are written atomically and the least recently used ones
+//        are removed when the directory grows beyond its size limit.
+//
+
+#ifndef _ASSEMBLYCACHE_H
+#define _ASSEMBLYCACHE_H
+
+#include "stdafx.h"
+
+// The results of assembling one source file
+struct CachedAssembly
+{
+    map<string, int> m_symbols;             // The symbol table made by Pass I
+    vector<pair<int, int>> m_image;         // Location and contents of each non-zero word
+    vector<string> m_errors;                // The errors recorded up to the end of Pass II
+    vector<int> m_errorCodes;               // The code of each error
+    string m_listing;                       // The listing written by Pass II
+};
+
+class AssemblyCache
+{
+
+public:
+
+    // Changes whenever the same source could be assembled differently
+    static const char *const VERSION;
+
+    // The size limit of the cache directory unless QUACK_CACHE_MAX gives one
+    const static unsigned long long DEFAULT_MAX_BYTES = 64ULL << 20;
+
+    // Uses the directory "a_dir" for the source "a_data"
+    AssemblyCache(const string&, const unsigned long long&, const char *, const size_t&);
+
+    // Finds the results of assembling the source
+    bool Lookup(CachedAssembly&);
+
+    // Stores the results of assembling the source
+    bool Store(const CachedAssembly&);
+
+
+private:
+
+    // Removes the least recently used entries beyond the size limit
+    void Evict();
+
+    string m_dir;                           // The cache directory
+    unsigned long long m_maxBytes;          // Size limit of the cache directory
+    string m_path;                          // The entry of the source
+    size_t m_sourceSize;                    // Size of the source
+    unsigned long long m_check;             // Second hash of the source, stored in the entry
+};
+
+#endif
@@ -0,0 +1,295 @@
+//
+//  Implementation of the channel class.
+//
+//  The ring of a channel is one block: the indices of its two ends, each
+//  on a cache line of its own so that the ends do not slow each other
+//  down, followed by its words. A channel of this process allocates the
+//  block; a channel in shared memory maps it from a POSIX shared memory
+//  object, which the first process to open the name creates and sizes
+//  while the others wait for it to be ready. The name is removed once
+//  both ends are closed.
+//
+
+#include "stdafx.h"
+#include "Channel.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// The most words of a ring
+const uint32_t MAX_CAPACITY = 1u << 24;
+
+// The times a process opening a channel in shared memory waits 100 microseconds for it to be made
+const int READY_TRIES = 10000;
+
+// Rounds a capacity up to a power of 2 within the limits of a ring
+uint32_t RingCapacity(const int& a_capacity)
+{
+    uint32_t capacity = 2;
+
+    while (capacity < MAX_CAPACITY && (int)capacity < a_capacity)
+        capacity *= 2;
+
+    return capacity;
+}
+
+// The channels of this process with a name, kept while one of their ends is open
+map<string, weak_ptr<Channel>>& NamedChannels()
+{
+    static map<string, weak_ptr<Channel>> channels;
+    return channels;
+}
+
+mutex& NamedChannelsMutex()
+{
+    static mutex namedMutex;
+    return namedMutex;
+}
+
+}
+
+Channel::Channel(const int& a_capacity):
+    m_mask(RingCapacity(a_capacity) - 1), m_sendHead(0), m_receiveTail(0)
+{
+    void *block = ::operator new(RingBytes(m_mask + 1), align_val_t(alignof(Ring)));
+
+    m_ring = new (block) Ring();
+    m_words = (int *)(m_ring + 1);
+}
+
+Channel::Channel(Ring *a_ring, const uint32_t& a_words, const string& a_name):
+    m_ring(a_ring), m_words((int *)(a_ring + 1)), m_mask(a_words - 1), m_name(a_name)
+{
+    m_sendHead = m_ring->m_head.load(memory_order_acquire);
+    m_receiveTail = m_ring->m_tail.load(memory_order_acquire);
+}
+
+Channel::~Channel()
+{
+    if (m_name.empty())
+    {
+        m_ring->~Ring();
+        ::operator delete(m_ring, align_val_t(alignof(Ring)));
+        return;
+    }
+
+#ifndef _WIN32
+    munmap(m_ring, RingBytes(m_mask + 1));
+#endif
+}
+
+
+/*
+NAME
+
+    Open - Opens the channel with a name
+
+SYNOPSIS
+
+    static shared_ptr<Channel> Open(const string& a_name, const int& a_capacity = DEFAULT_CAPACITY);
+
+DESCRIPTION
+
+    This function returns the channel named "a_name", making it with a
+    ring of at least "a_capacity" words (rounded up to a power of 2) if
+    it does not exist yet. A name starting with '/' is a channel in shared
+    memory, which every process opening the name shares; the others are
+    channels of this process, which exist while one of their ends is
+    open. The sending and the receiving end of a channel each open it
+    once, and each end is used by one thread at a time.
+
+    Returns nullptr - if the channel in shared memory could not be opened
+*/
+
+shared_ptr<Channel> Channel::Open(const string& a_name, const int& a_capacity)
+{
+    if (!a_name.empty() && a_name[0] == '/')
+        return OpenShared(a_name, a_capacity);
+
+    lock_guard<mutex> lock(NamedChannelsMutex());
+    weak_ptr<Channel>& named = NamedChannels()[a_name];
+
+    shared_ptr<Channel> channel = named.lock();
+
+    if (channel == nullptr)
+    {
+        channel = make_shared<Channel>(a_capacity);
+        named = channel;
+    }
+
+    // the names of the channels whose ends are all gone
+    for (auto entry = NamedChannels().begin(); entry != NamedChannels().end(); )
+    {
+        if (entry->second.expired())
+            entry = NamedChannels().erase(entry);
+        else
+            ++entry;
+    }
+
+    return channel;
+}
+/*shared_ptr<Channel> Channel::Open(const string& a_name, const int& a_capacity); */
+
+
+/*
+NAME
+
+    OpenShared - Opens the channel with a name in shared memory
+
+SYNOPSIS
+
+    static shared_ptr<Channel> OpenShared(const string& a_name, const int& a_capacity);
+
+DESCRIPTION
+
+    This function maps the shared memory object "a_name" holding the ring
+    of a channel. The process that creates the object sizes it for
+    "a_capacity" words and makes the ring; a process that finds it waits
+    until the ring is made and takes its capacity from its size.
+
+    Returns nullptr - if the object could not be made or mapped, or was not made in time
+*/
+
+shared_ptr<Channel> Channel::OpenShared(const string& a_name, const int& a_capacity)
+{
+#ifndef _WIN32
+    uint32_t words = RingCapacity(a_capacity);
+    bool created = true;
+
+    int fd = shm_open(a_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd < 0 && errno == EEXIST)
+    {
+        created = false;
+        fd = shm_open(a_name.c_str(), O_RDWR, 0600);
+    }
+
+    if (fd < 0)
+        return nullptr;
+
+    if (created && ftruncate(fd, (off_t)RingBytes(words)) != 0)
+    {
+        close(fd);
+        shm_unlink(a_name.c_str());
+        return nullptr;
+    }
+
+    // the process that made the object may not have sized it yet
+    struct stat status = {};
+    int tries = 0;
+
+    while (fstat(fd, &status) == 0 && (size_t)status.st_size < RingBytes(2) && ++tries < READY_TRIES)
+        this_thread::sleep_for(chrono::microseconds(100));
+
+    words = (uint32_t)(((size_t)status.st_size - sizeof(Ring)) / sizeof(int));
+
+    // the size is not that of a ring
+    if ((size_t)status.st_size < RingBytes(2) || words > MAX_CAPACITY || (words & (words - 1)) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void *mapping = mmap(nullptr, RingBytes(words), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    Ring *ring = (Ring *)mapping;
+
+    if (created)
+    {
+        new (ring) Ring();
+        ring->m_ready.store(1, memory_order_release);
+    }
+
+    for (tries = 0; ring->m_ready.load(memory_order_acquire) == 0 && tries < READY_TRIES; tries++)
+        this_thread::sleep_for(chrono::microseconds(100));
+
+    if (ring->m_ready.load(memory_order_acquire) == 0)
+    {
+        munmap(mapping, RingBytes(words));
+        return nullptr;
+    }
+
+    return shared_ptr<Channel>(new Channel(ring, words, a_name));
+#else
+    (void)a_name;
+    (void)a_capacity;
+    return nullptr;
+#endif
+}
+/*shared_ptr<Channel> Channel::OpenShared(const string& a_name, const int& a_capacity); */
+
+
+/*
+NAME
+
+    RemoveShared - Removes the name of a channel in shared memory
+
+SYNOPSIS
+
+    static bool RemoveShared(const string& a_name);
+
+DESCRIPTION
+
+    This function removes the shared memory object "a_name", which is
+    only left behind by a process that stopped before closing its end of
+    the channel, so that the next Open() makes a new channel. The
+    processes that have it open keep using it.
+
+    Returns true - if the name was removed
+    Returns false - Otherwise
+*/
+
+bool Channel::RemoveShared(const string& a_name)
+{
+#ifndef _WIN32
+    return shm_unlink(a_name.c_str()) == 0;
+#else
+    (void)a_name;
+    return false;
+#endif
+}
+/*bool Channel::RemoveShared(const string& a_name); */
+
+
+/*
+NAME
+
+    Close - Closes one end of the channel
+
+SYNOPSIS
+
+    void Close(atomic<uint32_t>& a_closed);
+
+DESCRIPTION
+
+    This function marks the end whose flag is "a_closed" as closed, once.
+    The words sent before the sending end was closed can still be
+    received. Once both ends are closed, the name of a channel in shared
+    memory is removed, so that it can name a new channel.
+*/
+
+void Channel::Close(atomic<uint32_t>& a_closed)
+{
+    if (a_closed.exchange(1, memory_order_acq_rel) != 0)
+        return;
+
+#ifndef _WIN32
+    if (m_ring->m_endsClosed.fetch_add(1, memory_order_acq_rel) == 1 && !m_name.empty())
+        shm_unlink(m_name.c_str());
+#else
+    m_ring->m_endsClosed.fetch_add(1, memory_order_acq_rel);
+#endif
+}
+/*void Channel::Close(atomic<uint32_t>& a_closed); */
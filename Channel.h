@@ -0,0 +1,132 @@
+//
+//        Channel class - carries words from the SEND instructions of one
+//        program to the RECV instructions of another. A channel is a ring
+//        of words with one sending and one receiving end, neither of which
+//        waits for the other or takes a lock: each end only advances its
+//        own index of the ring and reads the other's.
+//
+//        A channel named with a leading '/' (as "/stage1") is kept in
+//        shared memory, so that programs run by different processes can
+//        open its two ends; any other name is a channel of this process.
+//
+
+#ifndef _CHANNEL_H
+#define _CHANNEL_H
+
+#include "stdafx.h"
+
+class Channel
+{
+
+public:
+
+    // The words a channel holds unless Open() is given another capacity
+    static constexpr int DEFAULT_CAPACITY = 1024;
+
+    // A channel of this process holding at least "a_capacity" words, known by no name
+    explicit Channel(const int& a_capacity = DEFAULT_CAPACITY);
+
+    // Unmaps a channel in shared memory or releases the ring
+    ~Channel();
+
+    // Opens the channel with a name, made with "a_capacity" words by the first to open it, nullptr if it cannot be
+    static shared_ptr<Channel> Open(const string&, const int& a_capacity = DEFAULT_CAPACITY);
+
+    // Removes the name of a channel in shared memory left by a process that did not close it
+    static bool RemoveShared(const string&);
+
+    // Sends a word, false if the channel is full (by the sending end only)
+    bool Send(const int& a_word)
+    {
+        uint32_t tail = m_ring->m_tail.load(memory_order_relaxed);
+
+        // the receiving end is only asked how far it is once the ring seems full
+        if (tail - m_sendHead > m_mask)
+        {
+            m_sendHead = m_ring->m_head.load(memory_order_acquire);
+
+            if (tail - m_sendHead > m_mask)
+                return false;
+        }
+
+        m_words[tail & m_mask] = a_word;
+        m_ring->m_tail.store(tail + 1, memory_order_release);
+
+        return true;
+    }
+
+    // Receives a word, false if the channel is empty (by the receiving end only)
+    bool Receive(int& a_word)
+    {
+        uint32_t head = m_ring->m_head.load(memory_order_relaxed);
+
+        // the sending end is only asked how far it is once the ring seems empty
+        if (head == m_receiveTail)
+        {
+            m_receiveTail = m_ring->m_tail.load(memory_order_acquire);
+
+            if (head == m_receiveTail)
+                return false;
+        }
+
+        a_word = m_words[head & m_mask];
+        m_ring->m_head.store(head + 1, memory_order_release);
+
+        return true;
+    }
+
+    // Marks that no more words will be sent
+    void CloseSending() {Close(m_ring->m_sendClosed);}
+
+    // Marks that no more words will be received
+    void CloseReceiving() {Close(m_ring->m_receiveClosed);}
+
+    // Determines if the sending end was closed
+    bool IsSendingClosed() const {return m_ring->m_sendClosed.load(memory_order_acquire) != 0;}
+
+    // Determines if the receiving end was closed
+    bool IsReceivingClosed() const {return m_ring->m_receiveClosed.load(memory_order_acquire) != 0;}
+
+    // Returns the number of words the channel holds
+    int GetCapacity() const {return (int)m_mask + 1;}
+
+
+private:
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // The state of the ring shared by its two ends, followed by its words
+    struct Ring
+    {
+        alignas(64) atomic<uint32_t> m_head;        // The number of words received
+        alignas(64) atomic<uint32_t> m_tail;        // The number of words sent
+        alignas(64) atomic<uint32_t> m_sendClosed;  // != 0 once no more words will be sent
+        atomic<uint32_t> m_receiveClosed;           // != 0 once no more words will be received
+        atomic<uint32_t> m_endsClosed;              // The number of ends closed
+        atomic<uint32_t> m_ready;                   // != 0 once the ring in shared memory is made
+    };
+
+    static_assert(atomic<uint32_t>::is_always_lock_free, "the ends of a ring must not take locks");
+
+    // A channel whose ring is "a_ring", in shared memory under "a_name" if it is not empty
+    Channel(Ring *, const uint32_t&, const string&);
+
+    // Opens the channel with a name in shared memory
+    static shared_ptr<Channel> OpenShared(const string&, const int&);
+
+    // Returns the number of bytes of a ring of "a_words" words
+    static size_t RingBytes(const uint32_t& a_words) {return sizeof(Ring) + a_words * sizeof(int);}
+
+    // Closes one end, removing the name of the channel once both are closed
+    void Close(atomic<uint32_t>&);
+
+    Ring *m_ring;                           // The state of the ring
+    int *m_words;                           // The words of the ring
+    uint32_t m_mask;                        // The capacity, a power of 2, less 1
+    string m_name;                          // The name in shared memory, empty for a ring of this process
+    alignas(64) uint32_t m_sendHead;        // The number of words received as last seen by the sending end
+    alignas(64) uint32_t m_receiveTail;     // The number of words sent as last seen by the receiving end
+};
+
+#endif
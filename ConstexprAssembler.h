@@ -0,0 +1,741 @@
+//
+//        ConstexprAssembler - the assembler as constant expressions, so
+//        that a program fixed in the source of a C++ program becomes its
+//        memory image when that program is compiled:
+//
+//            constexpr ConstexprAssembler::Image PROGRAM = ConstexprAssembler::Assemble(R"(
+//                       org 100
+//                       read X
+//                       write X
+//                       halt 0
+//              X        ds 1
+//                       end
+//            )");
+//
+//            Toolchain::Run(vector<int>(PROGRAM.begin(), PROGRAM.end()), io);
+//
+//        It follows the rules of Instruction, SymbolTable and Pass II of
+//        Assembler for the Quack3200, and an image it makes is the one
+//        Toolchain::Assemble() makes from the same source. The first error
+//        is thrown as an EmbeddedAssemblyError, which is a compile error
+//        (pointing at the error code and the line) when the image is
+//        constexpr. EXPORT and IMPORT are checked as outside object mode.
+//        Tabs and carriage returns are treated as
+//        Instruction::ParseInstruction() treats them. A program may have
+//        at most MAXSYMBOLS labels (BasicConstexprAssembler<N> allows N).
+//        Large programs may need a higher limit on the steps of constant
+//        evaluation (for example -fconstexpr-ops-limit with g++ or
+//        -fconstexpr-steps with clang).
+//
+
+#ifndef _CONSTEXPRASSEMBLER_H
+#define _CONSTEXPRASSEMBLER_H
+
+#include "stdafx.h"
+#include <array>
+#include <string_view>
+
+// The first error found in a source by ConstexprAssembler
+struct EmbeddedAssemblyError
+{
+    int m_code;                             // The error code (see Errors)
+    int m_line;                             // The line of the source holding the error, from 1
+};
+
+template <int MAXSYMBOLS_>
+class BasicConstexprAssembler
+{
+
+public:
+
+    // The memory image of a program, one word per location
+    typedef array<int, Quack3200::MEMSZ> Image;
+
+    // The most labels in a program
+    static constexpr int MAXSYMBOLS = MAXSYMBOLS_;
+
+    // Assembles a source into its memory image, at compile time if the image is constexpr
+    static constexpr Image Assemble(const string_view a_source)
+    {
+        SymbolTable symtab{};
+        PassI(a_source, symtab);
+
+        Image image{};
+        PassII(a_source, symtab, image);
+
+        return image;
+    }
+
+
+private:
+
+    //the type of statement, as Instruction::InstructionType
+    enum StatementType
+    {
+        ST_MachineLanguage,
+        ST_AssemblerInstr,
+        ST_Comment,
+        ST_End,
+        ST_Linkage
+    };
+
+    //the assembler language statements
+    enum Directive
+    {
+        AL_None,
+        AL_DS,
+        AL_DC,
+        AL_ORG
+    };
+
+    // The elements of a statement
+    struct Statement
+    {
+        StatementType m_type = ST_Comment;  // The type of statement
+        string_view m_label;                // The label, empty if there is none
+        int m_opcode = 0;                   // The numeric opcode (see Instruction::GetOpcode)
+        int m_register = 9;                 // The register, 9 if none is given
+        int m_secondRegister = 0;           // The second register of MOVE and FILL
+        int m_index = -1;                   // The index register of the operand, -1 if it is not indexed
+        string_view m_operand;              // The symbolic operand
+        Directive m_directive = AL_None;    // DS, DC or ORG
+        bool m_numeric = false;             // == true if the operand of DC is numeric
+        int m_value = 0;                    // The value of a numeric operand
+        bool m_export = false;              // == true for EXPORT, false for IMPORT
+    };
+
+    // The labels of the program and their locations
+    struct SymbolTable
+    {
+        string_view m_symbols[MAXSYMBOLS];  // The labels, in the order they are defined
+        int m_locations[MAXSYMBOLS] = {};   // Their locations
+        int m_count = 0;                    // The number of labels
+    };
+
+    // The opcodes and their numeric values
+    static constexpr string_view OPCODES[] =
+    {
+        "ADD", "SUB", "MULT", "DIV", "LOAD", "STORE", "READ", "WRITE", "B", "BM", "BZ", "BP", "HALT",
+        "READV", "WRITEV", "FORK", "JOIN", "FADD", "SEND", "RECV", "MOVE", "FILL"
+    };
+
+    static constexpr int OPCODE_VALUES[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 19, 20, 30};
+
+    // Numeric opcodes used by the rules (see Emulator::OpcodeType)
+    static constexpr int ADD = 1, STORE = 6, READ = 7, WRITE = 8, B = 9, HALT = 13, JOIN = 17, CHANNEL = 19;
+    static constexpr int CHANNEL_PORTS = 5;
+    static constexpr int MOVE = 20, FILL = 30, INDEXED = 40;
+
+    // Throws the error "a_code" of line "a_line" unless "a_valid"
+    static constexpr void Check(const bool a_valid, const int a_code, const int a_line)
+    {
+        if (!a_valid)
+            throw EmbeddedAssemblyError{a_code, a_line};
+    }
+
+    static constexpr bool IsDigit(const char a_ch)
+    {
+        return a_ch >= '0' && a_ch <= '9';
+    }
+
+    static constexpr bool IsAlpha(const char a_ch)
+    {
+        return (a_ch >= 'a' && a_ch <= 'z') || (a_ch >= 'A' && a_ch <= 'Z');
+    }
+
+    // White space in the C locale, or a comma
+    static constexpr bool IsSeparator(const char a_ch)
+    {
+        return a_ch == ' ' || a_ch == ',' || (a_ch >= '\t' && a_ch <= '\r');
+    }
+
+    static constexpr char ToUpper(const char a_ch)
+    {
+        return (a_ch >= 'a' && a_ch <= 'z') ? a_ch - ('a' - 'A') : a_ch;
+    }
+
+    // Determines if a word is a keyword in any case
+    static constexpr bool IsKeyword(const string_view a_word, const string_view a_keyword)
+    {
+        if (a_word.size() != a_keyword.size())
+            return false;
+
+        for (size_t i = 0; i < a_word.size(); i++)
+            if (ToUpper(a_word[i]) != a_keyword[i])
+                return false;
+
+        return true;
+    }
+
+    // Finds the numeric opcode of a word, -1 if it is not an opcode
+    static constexpr int FindOpcode(const string_view a_word)
+    {
+        for (size_t i = 0; i < size(OPCODES); i++)
+            if (IsKeyword(a_word, OPCODES[i]))
+                return OPCODE_VALUES[i];
+
+        return -1;
+    }
+
+    // The value of a word checked by IsInteger()
+    static constexpr int ToInt(const string_view a_word)
+    {
+        bool negative = !a_word.empty() && a_word[0] == '-';
+        int value = 0;
+
+        for (size_t i = negative ? 1 : 0; i < a_word.size(); i++)
+            value = 10 * value + (a_word[i] - '0');
+
+        return negative ? -value : value;
+    }
+
+    // As Instruction::IsInteger()
+    static constexpr bool IsInteger(const string_view a_word, const int a_line)
+    {
+        size_t start = 0;
+
+        if (!a_word.empty() && a_word[0] == '-')
+        {
+            if (a_word.size() == 1)
+                return false;
+
+            //Code 30: Negative Sign Cannot Be Followed By 0
+            Check(a_word[1] != '0', 30, a_line);
+
+            start = 1;
+        }
+
+        for (size_t i = start; i < a_word.size(); i++)
+            if (!IsDigit(a_word[i]))
+                return false;
+
+        return true;
+    }
+
+    // As Instruction::IsSymbol()
+    static constexpr bool IsSymbol(const string_view a_symbol)
+    {
+        bool valid = !a_symbol.empty() && IsAlpha(a_symbol[0]) && a_symbol.size() <= 10;
+
+        for (size_t i = 1; valid && i < a_symbol.size(); i++)
+            valid = IsAlpha(a_symbol[i]) || IsDigit(a_symbol[i]);
+
+        return valid;
+    }
+
+    // As Instruction::SymbolValidation()
+    static constexpr void ValidateSymbol(const string_view a_symbol, const int a_line)
+    {
+        //Code 8: Symbol Does Not Meet Quack3200 Symbol Specification
+        Check(IsSymbol(a_symbol), 8, a_line);
+    }
+
+    // As Instruction::CommaChecker() for a statement with one comma and the opcode "a_opcode"
+    static constexpr bool CommaRuleMet(const string_view a_text, const string_view a_opcode)
+    {
+        if (a_text.size() < 3)
+            return false;
+
+        // the register pair of MOVE and FILL has two digits
+        size_t digits = (IsKeyword(a_opcode, "MOVE") || IsKeyword(a_opcode, "FILL")) ? 2 : 1;
+
+        bool firstEmptyChar = false;
+
+        for (size_t i = 0; i < a_text.size() - 3; i++)
+        {
+            if (a_text[i] != ' ' || !IsDigit(a_text[i + 1]))
+                continue;
+
+            for (size_t j = (digits == 2 && IsDigit(a_text[i + 2])) ? i + 3 : i + 2; j < a_text.size() - 1; j++)
+            {
+                if (a_text[j] == ' ')
+                    continue;
+
+                if (a_text[j] == ',' && !firstEmptyChar)
+                    return true;
+
+                firstEmptyChar = true;
+            }
+        }
+
+        return false;
+    }
+
+    // As Instruction::IndexChecker(), returns the operand without its index register
+    static constexpr string_view CheckIndex(const string_view a_operand, Statement& a_st, const int a_line)
+    {
+        size_t open = a_operand.find('(');
+
+        if (open == string_view::npos && a_operand.find(')') == string_view::npos)
+            return a_operand;
+
+        string_view index;
+
+        if (open != string_view::npos && a_operand.back() == ')')
+            index = a_operand.substr(open + 1, a_operand.size() - open - 2);
+
+        //Code 32: Invalid Index Register Specified
+        Check(IsInteger(index, a_line) && index.size() == 1, 32, a_line);
+
+        //Code 33: Only ADD, SUB, MULT, DIV, LOAD And STORE Can Be Indexed
+        Check(a_st.m_opcode >= ADD && a_st.m_opcode <= STORE, 33, a_line);
+
+        a_st.m_index = index[0] - '0';
+
+        return a_operand.substr(0, open);
+    }
+
+    // As Instruction::ThreeWordMachineLan()
+    static constexpr void ThreeWordMachineLan(const int a_opcode, const bool a_send, const string_view a_reg,
+                                              const string_view a_operand, Statement& a_st, const int a_line)
+    {
+        a_st.m_type = ST_MachineLanguage;
+        a_st.m_opcode = a_opcode;
+
+        bool block = (a_opcode == MOVE || a_opcode == FILL);
+        bool integer = IsInteger(a_reg, a_line);
+
+        //Code 21: Invalid Register Specified
+        Check(integer && a_reg.size() == (block ? 2 : 1) && IsDigit(a_reg[0])
+              && (a_opcode != CHANNEL || a_reg[0] - '0' < CHANNEL_PORTS), 21, a_line);
+
+        a_st.m_register = a_reg[0] - '0' + (a_send ? CHANNEL_PORTS : 0);
+
+        if (block)
+            a_st.m_secondRegister = a_reg[1] - '0';
+
+        a_st.m_operand = CheckIndex(a_operand, a_st, a_line);
+
+        //Code 0: Operand Must Be Symbolic
+        Check(!IsInteger(a_st.m_operand, a_line), 0, a_line);
+    }
+
+    // As Instruction::TwoWordMachineLan()
+    static constexpr bool TwoWordMachineLan(const string_view a_opcode, const string_view a_operand,
+                                            Statement& a_st, const int a_line)
+    {
+        if (IsKeyword(a_opcode, "READ") || IsKeyword(a_opcode, "WRITE") || IsKeyword(a_opcode, "B"))
+        {
+            a_st.m_type = ST_MachineLanguage;
+            a_st.m_opcode = FindOpcode(a_opcode);
+            a_st.m_operand = CheckIndex(a_operand, a_st, a_line);
+
+            //Code 0: Operand Must Be Symbolic
+            Check(!IsInteger(a_st.m_operand, a_line), 0, a_line);
+
+            return true;
+        }
+
+        if (IsKeyword(a_opcode, "HALT") || IsKeyword(a_opcode, "JOIN"))
+        {
+            a_st.m_type = ST_MachineLanguage;
+            a_st.m_opcode = FindOpcode(a_opcode);
+
+            //Code 21: Invalid Register Specified
+            Check(IsInteger(a_operand, a_line) && a_operand.size() == 1, 21, a_line);
+
+            a_st.m_register = a_operand[0] - '0';
+
+            return true;
+        }
+
+        return false;
+    }
+
+    // As Instruction::OriginInstr()
+    static constexpr void OriginInstr(const string_view a_operand, Statement& a_st, const int a_line)
+    {
+        a_st.m_type = ST_AssemblerInstr;
+        a_st.m_directive = AL_ORG;
+
+        //Code 5: Operand Exceeds Quack3200 Final Location
+        Check(a_operand.size() <= (size_t)Quack3200::ADDRESS_DIGITS, 5, a_line);
+
+        a_st.m_value = ToInt(a_operand);
+
+        //Code 1: Operand Must Be Positive Integer
+        Check(a_st.m_value > 0, 1, a_line);
+    }
+
+    // As Instruction::ThreeWordAssembly()
+    static constexpr void ThreeWordAssembly(const string_view a_assemLan, const string_view a_operand,
+                                            Statement& a_st, const int a_line)
+    {
+        a_st.m_type = ST_AssemblerInstr;
+
+        if (IsInteger(a_operand, a_line))
+        {
+            if (IsKeyword(a_assemLan, "ORG"))
+                OriginInstr(a_operand, a_st, a_line);
+
+            else if (IsKeyword(a_assemLan, "DS"))
+            {
+                a_st.m_directive = AL_DS;
+
+                //Code 4: Operand Too Large For Quack3200
+                Check(a_operand.size() <= (size_t)Quack3200::ADDRESS_DIGITS, 4, a_line);
+
+                a_st.m_value = ToInt(a_operand);
+
+                //Code 1: Operand Must Be Positive Integer
+                Check(a_st.m_value > 0, 1, a_line);
+            }
+
+            else
+            {
+                a_st.m_directive = AL_DC;
+                a_st.m_numeric = true;
+
+                //Code 19: Constant Too Large For Quack3200
+                Check(a_operand.size() <= (size_t)Quack3200::WORD_DIGITS + (a_operand[0] == '-' ? 1 : 0),
+                      19, a_line);
+
+                a_st.m_value = ToInt(a_operand);
+            }
+        }
+
+        //the location of the symbol is the constant
+        else if (IsKeyword(a_assemLan, "DC") && IsSymbol(a_operand))
+        {
+            a_st.m_directive = AL_DC;
+            a_st.m_operand = a_operand;
+        }
+
+        else
+        {
+            //Code 2: Operand Must Be Numeric
+            Check(false, 2, a_line);
+        }
+    }
+
+    // As Instruction::ParseInstruction()
+    static constexpr Statement Parse(const string_view a_line, const int a_lineNumber)
+    {
+        Statement st{};
+
+        string_view text = a_line.substr(0, a_line.find(';'));
+
+        int commas = 0;
+
+        for (char ch : text)
+            if (ch == ',')
+                commas++;
+
+        // as Instruction::WordsToReadFinder(), the words are only counted at spaces and commas
+        int count = 0;
+
+        for (size_t i = 0; i < text.size(); i++)
+            if (text[i] != ' ' && text[i] != ',' && (i + 1 == text.size() || text[i + 1] == ' ' || text[i + 1] == ','))
+                count++;
+
+        // but, as stringstream extraction, they are split at any white space
+        string_view words[4];
+        int tokens = 0;
+
+        for (size_t i = 0; i < text.size() && tokens < 4; )
+        {
+            if (IsSeparator(text[i]))
+            {
+                i++;
+                continue;
+            }
+
+            size_t end = i;
+
+            while (end < text.size() && !IsSeparator(text[end]))
+                end++;
+
+            words[tokens++] = text.substr(i, end - i);
+            i = end;
+        }
+
+        // the opcode follows the label of a 4-word statement
+        //Code 24: Comma Can Only Be Used To Separate Register From Operand
+        Check(commas == 0 || (commas == 1 && CommaRuleMet(text, words[count == 4 ? 1 : 0])), 24, a_lineNumber);
+
+        if (tokens == 0)
+            return st;
+
+        //Code 3: Extra Operands
+        Check(count <= 4, 3, a_lineNumber);
+
+        if (count == 4)
+        {
+            ValidateSymbol(words[0], a_lineNumber);
+            st.m_label = words[0];
+
+            int opcode = FindOpcode(words[1]);
+
+            //Code 22: Invalid Assembly Language Statement
+            Check(opcode >= 0, 22, a_lineNumber);
+
+            ThreeWordMachineLan(opcode, IsKeyword(words[1], "SEND"), words[2], words[3], st, a_lineNumber);
+        }
+
+        else if (count == 3)
+        {
+            int opcode = FindOpcode(words[0]);
+
+            if (opcode >= 0)
+                ThreeWordMachineLan(opcode, IsKeyword(words[0], "SEND"), words[1], words[2], st, a_lineNumber);
+
+            else if (TwoWordMachineLan(words[1], words[2], st, a_lineNumber))
+            {
+                ValidateSymbol(words[0], a_lineNumber);
+                st.m_label = words[0];
+            }
+
+            else
+            {
+                //Code 22: Invalid Assembly Language Statement
+                Check(IsKeyword(words[1], "DS") || IsKeyword(words[1], "DC") || IsKeyword(words[1], "ORG"),
+                      22, a_lineNumber);
+
+                ValidateSymbol(words[0], a_lineNumber);
+                ThreeWordAssembly(words[1], words[2], st, a_lineNumber);
+                st.m_label = words[0];
+            }
+        }
+
+        else if (count == 2)
+        {
+            if (TwoWordMachineLan(words[0], words[1], st, a_lineNumber))
+                return st;
+
+            if (IsKeyword(words[0], "ORG"))
+            {
+                //Code 2: Operand Must Be Numeric
+                Check(IsInteger(words[1], a_lineNumber), 2, a_lineNumber);
+
+                OriginInstr(words[1], st, a_lineNumber);
+            }
+
+            else if (IsKeyword(words[0], "EXPORT") || IsKeyword(words[0], "IMPORT"))
+            {
+                ValidateSymbol(words[1], a_lineNumber);
+
+                st.m_type = ST_Linkage;
+                st.m_export = IsKeyword(words[0], "EXPORT");
+                st.m_operand = words[1];
+            }
+
+            else
+            {
+                //Code 15: END Instruction cannot have a label
+                Check(!IsKeyword(words[1], "END"), 15, a_lineNumber);
+
+                //Code 22: Invalid Assembly Language Statement
+                Check(false, 22, a_lineNumber);
+            }
+        }
+
+        else if (IsKeyword(words[0], "HALT"))
+        {
+            st.m_type = ST_MachineLanguage;
+            st.m_opcode = HALT;
+        }
+
+        else
+        {
+            //Code 22: Invalid Assembly Language Statement
+            Check(IsKeyword(words[0], "END"), 22, a_lineNumber);
+
+            st.m_type = ST_End;
+        }
+
+        return st;
+    }
+
+    // As Instruction::LocationNextInstruction()
+    static constexpr int NextLocation(const Statement& a_st, const int a_loc, const int a_line)
+    {
+        if (a_st.m_type == ST_Comment || a_st.m_type == ST_End || a_st.m_type == ST_Linkage)
+            return a_loc;
+
+        if (a_st.m_directive == AL_DS)
+        {
+            //Code 5: Operand Exceeds Quack3200 Final Location
+            Check(a_loc + a_st.m_value < Quack3200::MEMSZ, 5, a_line);
+
+            return a_loc + a_st.m_value;
+        }
+
+        if (a_st.m_directive == AL_ORG)
+        {
+            //Code 23: The Origin's Operand Must be Higher Than Current Location
+            Check(a_st.m_value > a_loc, 23, a_line);
+
+            return a_st.m_value;
+        }
+
+        //Code 20: Insufficient Memory for Translation
+        Check(a_loc + 1 <= Quack3200::MEMSZ - 1, 20, a_line);
+
+        return a_loc + 1;
+    }
+
+    // Finds the location of a symbol, -1 if it is not defined
+    static constexpr int LookupSymbol(const SymbolTable& a_symtab, const string_view a_symbol)
+    {
+        for (int i = 0; i < a_symtab.m_count; i++)
+            if (a_symtab.m_symbols[i] == a_symbol)
+                return a_symtab.m_locations[i];
+
+        return -1;
+    }
+
+    // Finds the location of the operand of a statement, as Assembler::HasSymbolError()
+    static constexpr int ResolveSymbol(const SymbolTable& a_symtab, const string_view a_symbol, const int a_line)
+    {
+        int loc = LookupSymbol(a_symtab, a_symbol);
+
+        //Code 7: Undefined Symbol
+        Check(loc >= 0, 7, a_line);
+
+        return loc;
+    }
+
+    // Gets the line of "a_source" starting at "a_pos", false after the last line
+    static constexpr bool NextLine(const string_view a_source, size_t& a_pos, string_view& a_line)
+    {
+        if (a_pos >= a_source.size())
+            return false;
+
+        size_t end = a_source.find('\n', a_pos);
+
+        if (end == string_view::npos)
+            end = a_source.size();
+
+        a_line = a_source.substr(a_pos, end - a_pos);
+        a_pos = end + 1;
+
+        return true;
+    }
+
+    // As Assembler::PassI(), with the multiply defined labels found by Assembler::CheckSymbolTable()
+    static constexpr void PassI(const string_view a_source, SymbolTable& a_symtab)
+    {
+        size_t pos = 0;
+        string_view line;
+        int loc = 0;
+
+        for (int lineNumber = 1; NextLine(a_source, pos, line); lineNumber++)
+        {
+            Statement st = Parse(line, lineNumber);
+
+            if (st.m_type == ST_End)
+                return;
+
+            if (st.m_type != ST_MachineLanguage && st.m_type != ST_AssemblerInstr)
+                continue;
+
+            if (!st.m_label.empty())
+            {
+                //Code 9: Multiply Defined Label
+                Check(LookupSymbol(a_symtab, st.m_label) < 0, 9, lineNumber);
+
+                //Code 20: Insufficient Memory for Translation
+                Check(a_symtab.m_count < MAXSYMBOLS, 20, lineNumber);
+
+                a_symtab.m_symbols[a_symtab.m_count] = st.m_label;
+                a_symtab.m_locations[a_symtab.m_count] = loc;
+                a_symtab.m_count++;
+            }
+
+            loc = NextLocation(st, loc, lineNumber);
+        }
+    }
+
+    // As Assembler::PassII(), placing the translation in "a_image"
+    static constexpr void PassII(const string_view a_source, const SymbolTable& a_symtab, Image& a_image)
+    {
+        size_t pos = 0;
+        string_view line;
+        int loc = 0;
+        int lineNumber = 1;
+        bool endInstr = false;
+        bool haltInstr = false;
+
+        for ( ; NextLine(a_source, pos, line); lineNumber++)
+        {
+            Statement st = Parse(line, lineNumber);
+
+            if (endInstr)
+            {
+                //Code 16: END Instruction Can Only Be Included Once
+                Check(st.m_type != ST_End, 16, lineNumber);
+
+                //Code 18: Only Comments Are Allowed After END Instruction
+                Check(st.m_type == ST_Comment, 18, lineNumber);
+            }
+
+            else if (st.m_type == ST_MachineLanguage)
+            {
+                //Code 13: Machine Language Statements Are NOT Allowed After the HALT Instruction
+                Check(!haltInstr, 13, lineNumber);
+
+                if (st.m_opcode == HALT)
+                {
+                    //Code 11: HALT Instruction Before Location 100 Will Not Be Detected By Emulator
+                    Check(loc >= 100, 11, lineNumber);
+
+                    haltInstr = true;
+                    a_image[loc] = Quack3200::Translation(HALT, st.m_register, 0);
+                }
+
+                // JOIN names only the register holding the thread
+                else if (st.m_opcode == JOIN)
+                    a_image[loc] = Quack3200::Translation(JOIN, st.m_register, 0);
+
+                else
+                {
+                    int opcode = st.m_opcode;
+
+                    if (opcode == MOVE || opcode == FILL)
+                        opcode += st.m_secondRegister;
+
+                    else if (st.m_index >= 0)
+                        opcode = INDEXED + 10 * (opcode - ADD) + st.m_index;
+
+                    a_image[loc] = Quack3200::Translation(opcode, st.m_register,
+                                                          ResolveSymbol(a_symtab, st.m_operand, lineNumber));
+                }
+            }
+
+            else if (st.m_type == ST_Linkage)
+            {
+                if (st.m_export)
+                    ResolveSymbol(a_symtab, st.m_operand, lineNumber);
+
+                //Code 36: Imported Symbol Is Defined In The Module
+                else
+                    Check(LookupSymbol(a_symtab, st.m_operand) < 0, 36, lineNumber);
+            }
+
+            else if (st.m_type == ST_AssemblerInstr)
+            {
+                if (st.m_directive == AL_DC)
+                    a_image[loc] = st.m_numeric ? st.m_value : ResolveSymbol(a_symtab, st.m_operand, lineNumber);
+
+                //Code 12: Assembler Language Statements Are Not Allowed Before HALT Instruction
+                Check(haltInstr || st.m_directive == AL_ORG, 12, lineNumber);
+            }
+
+            else if (st.m_type == ST_End)
+                endInstr = true;
+
+            loc = NextLocation(st, loc, lineNumber);
+        }
+
+        //Code 17: No END Instruction Was Detected
+        Check(endInstr, 17, lineNumber);
+
+        //Code 14: No HALT Instruction Detected for Execution Termination
+        Check(haltInstr, 14, lineNumber);
+    }
+};
+
+// Enough labels for most embedded programs; use BasicConstexprAssembler for more
+typedef BasicConstexprAssembler<1000> ConstexprAssembler;
+
+#endif
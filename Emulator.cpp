@@ -1,8 +1,128 @@
 //
-//  Implementation of the emulator class
+//  Implementation of the emulator class template, made for the machines
+//  instantiated at the end of this file
 //
 
 #include "stdafx.h"
+#include <type_traits>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// The memory of the emulator interpreting a program on this thread, nullptr if none
+thread_local WatchedMemory *t_running = nullptr;
+
+// Makes an emulator the one running on this thread while it exists
+class RunningEmulator
+{
+
+public:
+
+    RunningEmulator(WatchedMemory *a_memory) : m_previous(t_running)
+    {
+        t_running = a_memory;
+    }
+
+    ~RunningEmulator()
+    {
+        t_running = m_previous;
+    }
+
+private:
+
+    WatchedMemory *m_previous;              // The memory of the emulator running before this one
+};
+
+#ifndef _WIN32
+
+// The size of a page of the machine
+size_t PageSize()
+{
+    static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return page;
+}
+
+// The size of a memory of "a_words" words rounded up to whole pages
+size_t MemoryBytes(const int& a_words)
+{
+    return (a_words * sizeof(int) + PageSize() - 1) / PageSize() * PageSize();
+}
+
+// The start of the page holding an address
+char *PageOf(const void *a_address)
+{
+    return (char *)((uintptr_t)a_address & ~(uintptr_t)(PageSize() - 1));
+}
+
+#endif
+
+}
+
+#ifndef _WIN32
+
+// The handler of writes to watched pages
+struct WatchSignal
+{
+    static struct sigaction m_previous;     // The handler replaced by this one
+    
+    static void Install();
+    static void Handle(int, siginfo_t *, void *);
+};
+
+struct sigaction WatchSignal::m_previous;
+
+#endif
+
+template <class Machine>
+BasicEmulator<Machine>::~BasicEmulator()
+{
+    // the memory belongs to the program, and its threads belong to it
+    if (m_threadNumber != 0)
+        return;
+    
+    EndThreads(false);
+    
+#ifndef _WIN32
+    if (m_nativeLib != nullptr)
+        dlclose(m_nativeLib);
+    
+    munmap(m_memory, MemoryBytes(MEMSZ));
+#else
+    delete[] m_memory;
+#endif
+}
+
+
+template <class Machine>
+BasicEmulator<Machine>::BasicEmulator(BasicEmulator& a_parent, const int& a_threadNumber)
+{
+    m_memory = a_parent.m_memory;
+    m_watched = {m_memory, MEMSZ, a_parent.m_watched.m_watching, -1, 0};
+    copy(a_parent.m_reg, a_parent.m_reg + 10, m_reg);
+    m_instrCount = 0;
+    m_resumeAt = -1;
+    m_channelWait = false;
+    m_io = a_parent.m_io;
+    m_watches = a_parent.m_watches;
+    m_watchHitCount = 0;
+    m_nativeLib = nullptr;
+    m_native = nullptr;
+    m_budget = a_parent.m_budget;
+    m_trace = a_parent.m_trace;
+    m_threadInstrCount = 0;
+    m_group = a_parent.m_group;
+    m_threadNumber = a_threadNumber;
+    m_waits = 0;
+    m_waitingForInput = false;
+    copy(a_parent.m_channels, a_parent.m_channels + 2 * CHANNEL_PORTS, m_channels);
+}
 
 /*
 NAME
@@ -19,71 +139,340 @@ DESCRIPTION
     until the HALT instruction is detected in a memory location or a run-time
     error is detected. The translated machine language statements are executed
     and the translated assembler language statements hold the values of the
-    constants in the program.
+    constants in the program. If a translation of this program was loaded by
+    LoadNative(), it is run instead of interpreting the instructions.
+ 
+    If the input given to SetIO() has no input ready for a READ instruction,
+    the program is suspended at that READ and this function returns, so
+    that a thread can run other programs while this one waits. Resume()
+    continues it once the input is ready; a program is suspended in the
+    same way at a SEND to a full channel or a RECV from an empty one,
+    and its channels are closed once it halts or records a run-time
+    error. The threads started by FORK
+    keep running while the program is suspended, and the program is
+    suspended at a JOIN while a thread waits for input that is not ready; once it halts or records
+    a run-time error they are stopped and their errors are reported.
+ 
+    The changes of locations given to Watch() are recorded for
+    GetWatchHits(), the instructions are limited by SetInstructionBudget()
+    and traced by SetTrace(); the program is then always interpreted.
 */
 
-bool Emulator::RunProgram()
+template <class Machine>
+bool BasicEmulator<Machine>::RunProgram()
 {
-    cout<<"RESULTS FROM EMULATING PROGRAM:"<<endl<<endl;
+    // the threads of a run that was left suspended
+    EndThreads(false);
     
-    // used to extract the opcode portion of the translation
-    int opcodeDivisor = 1'000'000;
+    m_io->Begin();
     
-    // used to extract the register portion of the translation
-    int regDivisor = 100'000;
+    m_instrCount = 0;
+    m_threadInstrCount = 0;
+    m_resumeAt = -1;
+    m_watchHits.clear();
+    m_watchHitCount = 0;
     
     // starting location for execution of Quack3200
     int executionIndex = 100;
     
+    // the translated program writes memory where no location can be told from its page,
+    // and it neither counts nor traces its instructions one at a time
+    if (m_native != nullptr && m_watches.empty() && m_budget == 0 && m_trace == nullptr)
+        executionIndex = ExecuteNative();
+    
+    // the translated program may leave the rest of the program to the interpreter
+    if (executionIndex >= 0)
+        Execute(executionIndex);
+    
+    if (m_resumeAt < 0)
+    {
+        EndThreads(true);
+        CloseChannels();
+    }
+    
+    return true;
+}
+/*bool emulator::runProgram(); */
+
+
+/*
+NAME
+ 
+    Resume - Continues a program suspended at a READ, SEND, RECV or JOIN instruction
+
+SYNOPSIS
+ 
+    bool Resume();
+
+DESCRIPTION
+ 
+    This function runs the program suspended by RunProgram() or by an
+    earlier call to Resume(), starting with the READ, SEND, RECV or JOIN
+    instruction it was suspended at, until it halts, records a run-time error or is
+    suspended again. The instructions are interpreted, even when the
+    program was started as a translated program.
+ 
+    Returns true - if the program was suspended
+    Returns false - Otherwise (nothing was run)
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::Resume()
+{
+    if (m_resumeAt < 0)
+        return false;
+    
+    int executionIndex = m_resumeAt;
+    m_resumeAt = -1;
+    
+    Execute(executionIndex);
+    
+    if (m_resumeAt < 0)
+    {
+        EndThreads(true);
+        CloseChannels();
+    }
+    
+    return true;
+}
+/*bool Emulator::Resume(); */
+
+
+/*
+NAME
+ 
+    AwaitChannels - Resumes the program while it waits for a channel
+
+SYNOPSIS
+ 
+    void AwaitChannels();
+
+DESCRIPTION
+ 
+    This function resumes a program suspended at a SEND to a full channel
+    or a RECV from an empty one until it halts, records a run-time error
+    or is suspended at a READ, which is left to the caller. While the
+    program at the other end makes no room or sends no word, the thread
+    yields a few times and then sleeps for longer and longer, up to a
+    millisecond, so that a program waiting for a slow peer does not keep
+    a processor busy.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::AwaitChannels()
+{
+    // the yields before the first sleep, and the longest sleep in microseconds
+    const int YIELDS = 16;
+    const int MAX_SLEEP = 1000;
+    
+    int idle = 0;
+    
+    while (IsWaitingForChannel())
+    {
+        if (idle < YIELDS)
+            this_thread::yield();
+        
+        else
+            this_thread::sleep_for(chrono::microseconds(min(MAX_SLEEP, 1 << min(idle - YIELDS, 10))));
+        
+        long long executed = m_instrCount;
+        Resume();
+        
+        // the channel was ready, so the next wait starts again with yields
+        idle = (m_instrCount != executed) ? 0 : idle + 1;
+    }
+}
+/*void Emulator::AwaitChannels(); */
+
+
+/*
+NAME
+ 
+    Execute - Interprets instructions starting at a location
+
+SYNOPSIS
+ 
+    void Execute(int a_executionIndex);
+
+DESCRIPTION
+ 
+    This function interprets the program starting at location
+    "a_executionIndex" with the loop of LOOPS made for the features in
+    use: watched locations, an instruction budget, a trace and threads
+    sharing the memory. The loop is chosen once, so that a feature that is
+    not in use costs nothing for each instruction; it is chosen again when
+    the first FORK starts sharing the memory.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::Execute(int a_executionIndex)
+{
+    int loop = (m_watches.empty() ? 0 : 1) + (m_budget > 0 ? 2 : 0) + (m_trace != nullptr ? 4 : 0);
+    
+    while (a_executionIndex >= 0)
+        a_executionIndex = (this->*LOOPS[loop + (m_group != nullptr ? 8 : 0)])(a_executionIndex);
+}
+/*void Emulator::Execute(int a_executionIndex); */
+
+
+template <class Machine>
+const typename BasicEmulator<Machine>::InterpretLoop BasicEmulator<Machine>::LOOPS[16] =
+{
+    &BasicEmulator::Interpret<NoWatch, NoBudget, NoTrace, NoThreads>,
+    &BasicEmulator::Interpret<CheckWatch, NoBudget, NoTrace, NoThreads>,
+    &BasicEmulator::Interpret<NoWatch, CheckBudget, NoTrace, NoThreads>,
+    &BasicEmulator::Interpret<CheckWatch, CheckBudget, NoTrace, NoThreads>,
+    &BasicEmulator::Interpret<NoWatch, NoBudget, WriteTrace, NoThreads>,
+    &BasicEmulator::Interpret<CheckWatch, NoBudget, WriteTrace, NoThreads>,
+    &BasicEmulator::Interpret<NoWatch, CheckBudget, WriteTrace, NoThreads>,
+    &BasicEmulator::Interpret<CheckWatch, CheckBudget, WriteTrace, NoThreads>,
+    &BasicEmulator::Interpret<NoWatch, NoBudget, NoTrace, SharedThreads>,
+    &BasicEmulator::Interpret<CheckWatch, NoBudget, NoTrace, SharedThreads>,
+    &BasicEmulator::Interpret<NoWatch, CheckBudget, NoTrace, SharedThreads>,
+    &BasicEmulator::Interpret<CheckWatch, CheckBudget, NoTrace, SharedThreads>,
+    &BasicEmulator::Interpret<NoWatch, NoBudget, WriteTrace, SharedThreads>,
+    &BasicEmulator::Interpret<CheckWatch, NoBudget, WriteTrace, SharedThreads>,
+    &BasicEmulator::Interpret<NoWatch, CheckBudget, WriteTrace, SharedThreads>,
+    &BasicEmulator::Interpret<CheckWatch, CheckBudget, WriteTrace, SharedThreads>
+};
+
+
+/*
+NAME
+ 
+    Interpret - Interprets instructions with the checks of the policies
+
+SYNOPSIS
+ 
+    template <class Watch, class Budget, class Trace, class Threads>
+    int Interpret(int a_executionIndex);
+
+DESCRIPTION
+ 
+    This function executes the instructions recorded in memory one at
+    a time starting at location "a_executionIndex" until the HALT
+    instruction is detected, a run-time error is recorded or a READ
+    instruction has no input ready. "Watch" records the changes of
+    watched locations, "Budget" stops the run once it has executed
+    the instructions it may and "Trace" writes each instruction.
+    "Threads" reads and writes the memory as shared with the threads
+    started by FORK, and stops once any of them records an error.
+ 
+    A thread other than the program itself waits at a READ with no
+    input ready, or at a SEND or RECV whose channel is not ready, rather
+    than being suspended, and its HALT ends only
+    the thread.
+ 
+    Returns the location to continue from with the loop for threads,
+    after the first FORK of a loop without them, or -1.
+*/
+
+template <class Machine>
+template <class Watch, class Budget, class Trace, class Threads>
+int BasicEmulator<Machine>::Interpret(int a_executionIndex)
+{
+    // location of the next instruction
+    int executionIndex = a_executionIndex;
+    
     // used to terminate emulator
     bool haltInstr = false;
     
     int translation, opcode, regNumber, address;
+    
+    // writes to watched pages are traced back to this emulator
+    RunningEmulator running(&m_watched);
        
     //executionIndex will never go beyond memory because emulator will not
     //be called unless there is a HALT instruction within the range of memory
     
     //to stop immediately if we have run-time errors to prevent program from breaking
-    while ((!haltInstr) && (Errors::NumErrors() == 0))
+    while ((!haltInstr) && (Errors::NumErrors() == 0) && !Threads::Stopped(*this))
     {
+        if (Budget::Exhausted(*this))
+        {
+            // to specify the instruction that was not executed
+            string errorMsg = "LOCATION# ";
+            errorMsg += to_string(executionIndex);
+            
+            //Code 40: Instruction Budget Exhausted
+            Errors::RecordError(40, errorMsg);
+            break;
+        }
+        
         //extracting elements of the translation
-        translation = m_memory[executionIndex];
-        opcode = translation / opcodeDivisor;
-        regNumber = (translation % opcodeDivisor) / regDivisor;
-        address = (translation % opcodeDivisor) % regDivisor;
+        translation = Threads::Load(m_memory[executionIndex]);
+        Trace::Step(*this, executionIndex, translation);
+        
+        opcode = Machine::Opcode(translation);
+        regNumber = Machine::Register(translation);
+        address = Machine::Address(translation);
+        m_instrCount++;
+        
+        //the address of an indexed ADD to STORE is offset by its index register
+        if (opcode >= INDEXED)
+        {
+            int indexReg = opcode % 10;
+            address += m_reg[indexReg];
+            opcode = ADD + (opcode - INDEXED) / 10;
+            
+            if (address < 0 || address >= MEMSZ)
+            {
+                // to specify the index register
+                string errorMsg = "REG# ";
+                errorMsg += to_string(indexReg);
+                
+                //Code 34: Indexed Address Outside Quack3200 Memory
+                Errors::RecordError(34, errorMsg);
+                break;
+            }
+        }
             
         //check this first to make sure we do not attempt to execute assembler language instructions
         if (opcode == HALT)
         {
-            cout<<endl<<"END OF EMULATION"<<endl<<endl<<endl;
+            // the HALT of a thread ends only the thread
+            if (m_threadNumber == 0)
+            {
+                typename Threads::Lock lock(*this);
+                m_io->Halt();
+            }
+            
             haltInstr = true;
         }
             
         else if (opcode == ADD)
         {
+            int word = Threads::Load(m_memory[address]);
+            
             //if the result can be stored in register
-            if (ResultChecker(regNumber, m_reg[regNumber], m_memory[address], ADD))
-                m_reg[regNumber] += m_memory[address];
+            if (ResultChecker(regNumber, m_reg[regNumber], word, ADD))
+                m_reg[regNumber] += word;
         }
                     
         else if (opcode == SUB)
         {
+            int word = Threads::Load(m_memory[address]);
+            
             //if the result can be stored in register
-            if (ResultChecker(regNumber, m_reg[regNumber], m_memory[address], SUB))
-                m_reg[regNumber] -= m_memory[address];
+            if (ResultChecker(regNumber, m_reg[regNumber], word, SUB))
+                m_reg[regNumber] -= word;
         }
                     
         else if (opcode == MULT)
         {
+            int word = Threads::Load(m_memory[address]);
+            
             //if the result can be stored in register
-            if (ResultChecker(regNumber, m_reg[regNumber], m_memory[address], MULT))
-                m_reg[regNumber] *= m_memory[address];
+            if (ResultChecker(regNumber, m_reg[regNumber], word, MULT))
+                m_reg[regNumber] *= word;
         }
                     
         else if (opcode == DIV)
         {
-            if (m_memory[address] != 0)
-                m_reg[regNumber] /= m_memory[address];
+            int word = Threads::Load(m_memory[address]);
+            
+            if (word != 0)
+                m_reg[regNumber] /= word;
             
             else
             {
@@ -97,28 +486,100 @@ bool Emulator::RunProgram()
         }
         
         else if (opcode == LOAD)
-            m_reg[regNumber] = m_memory[address];
+            m_reg[regNumber] = Threads::Load(m_memory[address]);
                     
         else if (opcode == STORE)
-            m_memory[address] = m_reg[regNumber];
+        {
+            Threads::Store(m_memory[address], m_reg[regNumber]);
+            
+            // the location may be on a watched page
+            Watch::Written(*this, executionIndex);
+        }
                     
-        else if (opcode == READ)
+        else if (opcode == READ || opcode == READV || opcode == WRITEV || opcode == CHANNEL)
         {
-            string input;
-            cout<<"? ";
-            cin>>input;
-            cin.ignore();
+            bool ready;
             
-            //if we have a valid input
-            if (InputChecker(input))
             {
-                int inputValue = stoi(input);
-                m_memory[address] = inputValue;
+                typename Threads::Lock lock(*this);
+                
+                if (opcode == CHANNEL)
+                    ready = ChannelInstruction(regNumber, address, executionIndex);
+                
+                else if (opcode != READ)
+                    ready = VectorInstruction(opcode, regNumber, address, executionIndex);
+                
+                else if ((ready = m_io->Ready()))
+                    ReadInput(address);
+            }
+            
+            // the input or the channel is not ready yet, so stop and execute this instruction
+            // again on Resume(), or wait for it in a thread
+            if (!ready)
+            {
+                m_instrCount--;
+                
+                if (m_threadNumber == 0)
+                {
+                    m_resumeAt = executionIndex;
+                    m_channelWait = (opcode == CHANNEL);
+                    return -1;
+                }
+                
+                AwaitReady(opcode == READ || opcode == READV);
+                continue;
             }
+            
+            if (m_waits > 0)
+                EndWait();
+            
+            if (opcode == READ || opcode == CHANNEL)
+                Watch::Written(*this, executionIndex);
         }
                     
         else if (opcode == WRITE)
-            cout<<m_memory[address]<<endl;
+        {
+            int word = Threads::Load(m_memory[address]);
+            
+            typename Threads::Lock lock(*this);
+            m_io->Write(word);
+        }
+        
+        else if (opcode == FORK)
+        {
+            // the memory is shared from the first thread on, so the loop for threads takes over
+            if (StartThread(regNumber, address, executionIndex) && is_same<Threads, NoThreads>::value)
+                return executionIndex + 1;
+        }
+        
+        else if (opcode == JOIN)
+        {
+            // a thread waits for input that is only given while the program is suspended,
+            // so stop and execute this instruction again on Resume()
+            if (!JoinThread(regNumber))
+            {
+                m_instrCount--;
+                m_resumeAt = executionIndex;
+                m_channelWait = false;
+                return -1;
+            }
+        }
+        
+        else if (opcode == FADD)
+        {
+            int word = Threads::Load(m_memory[address]);
+            
+            // another thread may change the word between the load and the exchange
+            while (ResultChecker(regNumber, m_reg[regNumber], word, ADD))
+            {
+                if (Threads::CompareExchange(m_memory[address], word, word + m_reg[regNumber]))
+                {
+                    m_reg[regNumber] = word;
+                    Watch::Written(*this, executionIndex);
+                    break;
+                }
+            }
+        }
               
         //go to address
         else if (opcode == B)
@@ -157,6 +618,9 @@ bool Emulator::RunProgram()
             }
         }
         
+        else if (opcode >= MOVE && opcode < INDEXED)
+            BlockInstruction(opcode, regNumber, address, executionIndex);
+        
         // otherwise we have zeros in memory since nothing
         // has been inserted into memory in those locations
         // so we do nothing
@@ -167,123 +631,947 @@ bool Emulator::RunProgram()
         // cause jumps to other memory locations)
     }
     
-    return true;
+    return -1;
 }
-/*bool emulator::runProgram(); */
+/*template <class Watch, class Budget, class Trace, class Threads>
+  int Emulator::Interpret(int a_executionIndex); */
 
 
 /*
 NAME
  
-    InputChecker - Checks the input at run-time
+    ReadInput - Reads a run-time input into a memory location
 
 SYNOPSIS
  
-    bool InputChecker(const string& a_input) const;
+    bool ReadInput(const int& a_address);
 
 DESCRIPTION
  
-    This function determines if all characters of "a_input"
-    are numeric (except for the first character which could be a
-    negative sign). It also determines whether "a_input" fits
-    the memory location of Quack3200.
+    This function gets an input from the input of the program and
+    stores it at location "a_address" if it is valid.
  
-    Returns true - if conditions are met
-    Returns false - Otherwise
+    Returns true - if the input was stored
+    Returns false - Otherwise (a run-time error was recorded)
 */
 
-bool Emulator::InputChecker(const string& a_input) const
+template <class Machine>
+bool BasicEmulator<Machine>::ReadInput(const int& a_address)
 {
-    //will be 8 if input is positive and 9 if input is negative (because of the sign)
-    //maxVal = 99,999,999 (8 digits)
-    size_t maxChar = 8;
-    
-    //if number is positive, all characters must be numeric starting at index 0
-    int startIndex = 0;
+    string input;
     
-    //if number is negative, all characters must be digits starting at index 1
-    if (a_input[0] == '-')
+    if (!m_io->Read(input))
     {
-        //minVal = -99,999,999 (9 characters)
-        maxChar = 9;
-        startIndex = 1;
+        // to specify the location that could not be read
+        string errorMsg = "LOCATION# ";
+        errorMsg += to_string(a_address);
+        
+        //Code 31: No Input Available For READ Instruction
+        Errors::RecordError(31, errorMsg);
+        
+        return false;
     }
     
-    //Test 1: Is input an integer?
-    for (int i = startIndex; i < (int)a_input.size(); i++)
+    int inputValue;
+    
+    //if we have a valid input
+    if (InputChecker(input, inputValue))
     {
-        if (!(isdigit(a_input[i])))
-        {
-            //Code 28: Only Integers Are Supported by Quack3200
-            Errors::RecordError(28, a_input);
-            
-            return false;
-        }
+        m_memory[a_address] = inputValue;
+        
+        return true;
     }
     
-    //Test 2: Does it fit Quack3200 memory?
-    if (a_input.size() > maxChar)
+    return false;
+}
+/*bool Emulator::ReadInput(const int& a_address); */
+
+
+/*
+NAME
+ 
+    VectorInstruction - Executes a READV or WRITEV instruction
+
+SYNOPSIS
+ 
+    bool VectorInstruction(const int& a_opcode, const int& a_regNumber,
+                           const int& a_address, const int& a_pc);
+
+DESCRIPTION
+ 
+    This function executes the instruction at location "a_pc". Register
+    "a_regNumber" holds the number of words of the block starting at
+    location "a_address". READV reads that many inputs into the block
+    with one call to the input of the program and WRITEV writes the
+    block with one call to its output. Each input is checked as a READ
+    checks it (see InputChecker) and the inputs before an invalid one
+    are stored. A block that is not all in memory is a run-time error.
+ 
+    Returns false - if READV has no input ready (see EmulatorIO::Ready)
+    Returns true - Otherwise
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::VectorInstruction(const int& a_opcode, const int& a_regNumber,
+                                               const int& a_address, const int& a_pc)
+{
+    int length = m_reg[a_regNumber];
+    
+    if (length < 0 || length > MEMSZ - a_address)
     {
-        //Code 19: Constant Too Large For Quack3200
-        Errors::RecordError(19, a_input);
+        // to specify the register holding the number of words
+        string errorMsg = "REG# ";
+        errorMsg += to_string(a_regNumber);
         
-        return false;
+        //Code 35: Block Exceeds Quack3200 Memory
+        Errors::RecordError(35, errorMsg);
+        return true;
     }
-       
+    
+    if (length == 0)
+        return true;
+    
+    if (a_opcode == WRITEV)
+        m_io->WriteWords(m_memory + a_address, length);
+    
+    else if (!m_io->Ready())
+        return false;
+    
+    else
+        ReadWords(a_address, length, a_pc);
+    
     return true;
 }
-/*bool emulator::InputChecker(const string& a_input) const; */
+/*bool Emulator::VectorInstruction(const int& a_opcode, const int& a_regNumber,
+  const int& a_address, const int& a_pc); */
 
 
 /*
 NAME
  
-    ResultChecker - Checks the result of an operation at run-time
+    ReadWords - Reads run-time inputs into a block of memory
 
 SYNOPSIS
  
-    bool ResultChecker(const int& a_regNumber, const int& a_regVal,
-                const int& a_memVal, const opcodeName& a_operation) const;
+    bool ReadWords(const int& a_address, const int& a_count, const int& a_pc);
 
 DESCRIPTION
  
-    This function performs the "a_operation" (ADD, SUB, or MULT)
-    on the "a_regVal", the register value
-    and the "a_memVal", the value in memory location
-    to determine whether the result can be stored into Quack3200 register.
-    "a_regNumber" is used to specify register number when giving errors
-    if there is any.
+    This function gets "a_count" inputs from the input of the program
+    at once, for the READV instruction at location "a_pc", and stores
+    them from location "a_address" on. The inputs are checked until
+    one is invalid or missing.
  
-    Returns true - if result fits into register
-    Returns false - Otherwise
+    Returns true - if all the inputs were stored
+    Returns false - Otherwise (a run-time error was recorded)
 */
 
-bool Emulator::ResultChecker(const int& a_regNumber, const int& a_regVal,
-                             const int& a_memVal, const OpcodeType& a_operation) const
+template <class Machine>
+bool BasicEmulator<Machine>::ReadWords(const int& a_address, const int& a_count, const int& a_pc)
 {
-    // to specify the register number with the overflow if there is an error
-    string errorMsg = "REG# ";
-    errorMsg += to_string(a_regNumber);
+    string input, word;
+    int parsed = 0;
     
-    int maxVal = 99'999'999;
-    int minVal = -99'999'999;
+    if (!m_io->ReadWords(input, a_count))
+        input.clear();
     
-    if (a_operation == ADD)
+    // the values go straight to memory unless its changes are recorded
+    vector<int> values(m_watched.m_watching ? a_count : 0);
+    int *target = m_watched.m_watching ? values.data() : m_memory + a_address;
+    
+    int errorCode = InputWords(input, target, a_count, parsed, word);
+    
+    for (int i = 0; m_watched.m_watching && i < parsed; i++)
     {
-        //if addition results in a number bigger than maxVal or smaller than minVal
-        if ( (a_regVal + a_memVal > maxVal) || (a_regVal + a_memVal < minVal) )
-        {
-            //Code 25: ADD Instruction Causes Overflow In a Register
-            Errors::RecordError(25, errorMsg);
-            
-            return false;
-        }
+        m_memory[a_address + i] = values[i];
+        
+        if (m_watched.m_fault >= 0)
+            RecordWatchHit(a_pc);
+    }
+    
+    if (errorCode == 31)
+    {
+        // to specify the location that could not be read
+        string errorMsg = "LOCATION# ";
+        errorMsg += to_string(a_address + parsed);
+        
+        //Code 31: No Input Available For READ Instruction
+        Errors::RecordError(31, errorMsg);
+    }
+    
+    else if (errorCode >= 0)
+    {
+        //Code 28: Only Integers Are Supported by Quack3200
+        //Code 19: Constant Too Large For Quack3200
+        Errors::RecordError(errorCode, word);
+    }
+    
+    return errorCode < 0;
+}
+/*bool Emulator::ReadWords(const int& a_address, const int& a_count, const int& a_pc); */
+
+
+/*
+NAME
+ 
+    BlockInstruction - Executes a MOVE or FILL instruction
+
+SYNOPSIS
+ 
+    void BlockInstruction(const int& a_opcode, const int& a_regNumber,
+                          const int& a_address, const int& a_pc);
+
+DESCRIPTION
+ 
+    This function executes the instruction at location "a_pc". Register
+    "a_regNumber" holds the number of words of the block starting at
+    location "a_address". MOVE (opcode MOVE + s) copies the block from
+    the location held in register s, even if the two overlap. FILL
+    (opcode FILL + v) stores the contents of register v into every word
+    of the block. A block that is not all in memory is a run-time error.
+ 
+    The words are copied one at a time while locations are watched, so
+    that each change is recorded.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::BlockInstruction(const int& a_opcode, const int& a_regNumber,
+                                              const int& a_address, const int& a_pc)
+{
+    int length = m_reg[a_regNumber];
+    int second = a_opcode % 10;
+    int source = a_opcode < FILL ? m_reg[second] : 0;
+    
+    if (length < 0 || length > MEMSZ - a_address || source < 0 || source > MEMSZ - length)
+    {
+        // to specify the register holding the number of words
+        string errorMsg = "REG# ";
+        errorMsg += to_string(a_regNumber);
+        
+        //Code 35: Block Exceeds Quack3200 Memory
+        Errors::RecordError(35, errorMsg);
+        return;
+    }
+    
+    if (!m_watched.m_watching)
+    {
+        if (a_opcode < FILL)
+            memmove(m_memory + a_address, m_memory + source, length * sizeof(int));
+        else
+            fill_n(m_memory + a_address, length, m_reg[second]);
+        
+        return;
+    }
+    
+    // copy backwards when the block moves up over itself
+    bool backwards = a_opcode < FILL && source < a_address;
+    
+    for (int i = 0; i < length; i++)
+    {
+        int word = backwards ? length - 1 - i : i;
+        
+        m_memory[a_address + word] = a_opcode < FILL ? m_memory[source + word] : m_reg[second];
+        
+        if (m_watched.m_fault >= 0)
+            RecordWatchHit(a_pc);
+    }
+}
+/*void Emulator::BlockInstruction(const int& a_opcode, const int& a_regNumber,
+  const int& a_address, const int& a_pc); */
+
+
+/*
+NAME
+ 
+    ChannelInstruction - Executes a SEND or RECV instruction
+
+SYNOPSIS
+ 
+    bool ChannelInstruction(const int& a_port, const int& a_address, const int& a_pc);
+
+DESCRIPTION
+ 
+    This function executes the instruction at location "a_pc" with the
+    port "a_port" in its register: RECV receives a word into location
+    "a_address" from the channel connected to a port below CHANNEL_PORTS,
+    and SEND sends the word at "a_address" on the channel connected to
+    port "a_port" - CHANNEL_PORTS of SEND. A RECV from a channel whose
+    sender closed it, once every word sent is received, and a SEND on a
+    channel whose receiver closed it are run-time errors.
+ 
+    Returns false - if the channel is full for SEND or empty for RECV
+    Returns true - Otherwise
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::ChannelInstruction(const int& a_port, const int& a_address, const int& a_pc)
+{
+    Channel *channel = m_channels[a_port];
+    bool sending = a_port >= CHANNEL_PORTS;
+    
+    if (channel == nullptr)
+    {
+        // to specify the SEND or RECV instruction
+        string errorMsg = "LOCATION# ";
+        errorMsg += to_string(a_pc);
+        
+        //Code 43: No Channel Connected To The Port
+        Errors::RecordError(43, errorMsg);
+        return true;
+    }
+    
+    // no word is sent once no more will be received
+    if (sending && !channel->IsReceivingClosed())
+    {
+        if (channel->Send(m_memory[a_address]))
+            return true;
+        
+        if (!channel->IsReceivingClosed())
+            return false;
+    }
+    
+    else if (!sending)
+    {
+        if (channel->Receive(m_memory[a_address]))
+            return true;
+        
+        if (!channel->IsSendingClosed())
+            return false;
+        
+        // the last words may have been sent just before the channel was closed
+        if (channel->Receive(m_memory[a_address]))
+            return true;
+    }
+    
+    // to specify the SEND or RECV instruction
+    string errorMsg = "LOCATION# ";
+    errorMsg += to_string(a_pc);
+    
+    //Code 44: Channel Closed
+    Errors::RecordError(44, errorMsg);
+    
+    return true;
+}
+/*bool Emulator::ChannelInstruction(const int& a_port, const int& a_address, const int& a_pc); */
+
+
+/*
+NAME
+ 
+    CloseChannels - Closes the ends of the channels connected to the ports
+
+SYNOPSIS
+ 
+    void CloseChannels();
+
+DESCRIPTION
+ 
+    This function closes the sending end of the channels connected to the
+    ports of SEND and the receiving end of those connected to the ports of
+    RECV, once the program has halted or recorded a run-time error, so
+    that the programs at their other ends stop waiting for it.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::CloseChannels()
+{
+    for (int port = 0; port < CHANNEL_PORTS; port++)
+    {
+        if (m_channels[port] != nullptr)
+            m_channels[port]->CloseReceiving();
+        
+        if (m_channels[CHANNEL_PORTS + port] != nullptr)
+            m_channels[CHANNEL_PORTS + port]->CloseSending();
+    }
+}
+/*void Emulator::CloseChannels(); */
+
+
+/*
+NAME
+ 
+    StartThread - Starts a thread for a FORK instruction
+
+SYNOPSIS
+ 
+    bool StartThread(const int& a_regNumber, const int& a_address, const int& a_pc);
+
+DESCRIPTION
+ 
+    This function starts a thread executing the program from location
+    "a_address", for the FORK instruction at location "a_pc", on a host
+    thread of its own. The thread shares the memory and the input and
+    output of the program and starts with a copy of the registers of the
+    thread executing the FORK, except for register "a_regNumber", which
+    holds 0. That register of this thread is given the number of the
+    new thread, for JOIN. The threads of a run are numbered from 1, the
+    program itself being 0.
+ 
+    Returns true - if the thread was started
+    Returns false - Otherwise (the threads are being stopped or there are too many)
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::StartThread(const int& a_regNumber, const int& a_address, const int& a_pc)
+{
+    // only the program starts without threads
+    if (m_group == nullptr)
+    {
+        m_threads.reset(new ThreadGroup);
+        m_group = m_threads.get();
+    }
+    
+    lock_guard<mutex> lock(m_group->m_mutex);
+    
+    // an error or the end of the run is stopping every thread
+    if (m_group->m_stop)
+        return false;
+    
+    int number = (int)m_group->m_threads.size() + 1;
+    
+    if (number <= MAX_THREADS)
+    {
+        unique_ptr<ProgramThread> started(new ProgramThread);
+        started->m_emul.reset(new BasicEmulator(*this, number));
+        started->m_emul->m_reg[a_regNumber] = 0;
+        started->m_parent = m_threadNumber;
+        started->m_joined = false;
+        started->m_finished = false;
+        
+        ProgramThread *programThread = started.get();
+        m_group->m_threads.push_back(move(started));
+        
+        try
+        {
+            programThread->m_thread = thread(&BasicEmulator::RunThread, programThread->m_emul.get(),
+                                             a_address, programThread);
+            
+            m_reg[a_regNumber] = number;
+            return true;
+        }
+        catch (const system_error&)
+        {
+            m_group->m_threads.pop_back();
+        }
+    }
+    
+    // to specify the FORK instruction
+    string errorMsg = "LOCATION# ";
+    errorMsg += to_string(a_pc);
+    
+    //Code 41: Too Many Threads Started
+    Errors::RecordError(41, errorMsg);
+    
+    return false;
+}
+/*bool Emulator::StartThread(const int& a_regNumber, const int& a_address, const int& a_pc); */
+
+
+/*
+NAME
+ 
+    JoinThread - Waits for a thread for a JOIN instruction
+
+SYNOPSIS
+ 
+    bool JoinThread(const int& a_regNumber);
+
+DESCRIPTION
+ 
+    This function waits until the thread whose number register
+    "a_regNumber" holds has halted or stopped, and adds its run-time
+    errors, its instructions and its changes of watched locations to
+    those of this thread. A thread may only be waited for once, by the
+    thread that started it, so that no threads wait for each other.
+ 
+    The input of a READ is only given while the program is suspended, so
+    the program does not wait while a thread waits for input that is not
+    ready: it leaves the thread to be waited for again when it is resumed.
+ 
+    Returns true - if the thread was waited for, or could not be (the
+                   error is recorded)
+    Returns false - if the program must be suspended at the JOIN
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::JoinThread(const int& a_regNumber)
+{
+    int number = m_reg[a_regNumber];
+    ProgramThread *joined = nullptr;
+    
+    if (m_group != nullptr)
+    {
+        unique_lock<mutex> lock(m_group->m_mutex);
+        
+        if (number >= 1 && number <= (int)m_group->m_threads.size()
+            && m_group->m_threads[number - 1]->m_parent == m_threadNumber
+            && !m_group->m_threads[number - 1]->m_joined)
+        {
+            joined = m_group->m_threads[number - 1].get();
+            joined->m_joined = true;
+            
+            // only the program is suspended; a thread waits for the program to give the input
+            m_group->m_changed.wait(lock, [&]
+            {
+                return joined->m_finished
+                       || (m_threadNumber == 0 && m_group->m_waitingForInput > 0 && !m_io->Ready());
+            });
+            
+            if (!joined->m_finished)
+            {
+                joined->m_joined = false;
+                return false;
+            }
+        }
+    }
+    
+    if (joined == nullptr)
+    {
+        // to specify the register holding the number of the thread
+        string errorMsg = "REG# ";
+        errorMsg += to_string(a_regNumber);
+        
+        //Code 42: Thread Cannot Be Joined
+        Errors::RecordError(42, errorMsg);
+        return true;
+    }
+    
+    joined->m_thread.join();
+    
+    AdoptThread(*joined);
+    
+    return true;
+}
+/*bool Emulator::JoinThread(const int& a_regNumber); */
+
+
+/*
+NAME
+ 
+    AwaitReady - Waits in a thread for the input or the channel of an instruction
+
+SYNOPSIS
+ 
+    void AwaitReady(const bool& a_input);
+
+DESCRIPTION
+ 
+    This function is called each time a thread other than the program
+    finds the input of a READ or READV, or the channel of a SEND or RECV,
+    not ready; the instruction is then executed again. The thread yields
+    a few times and then sleeps for longer and longer, up to a
+    millisecond, as AwaitChannels() does. A thread waiting for input
+    ("a_input") is counted in its group, so that a JOIN of the program
+    suspends the program for the input rather than waiting forever.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::AwaitReady(const bool& a_input)
+{
+    // the yields before the first sleep, and the longest sleep in microseconds
+    const int YIELDS = 16;
+    const int MAX_SLEEP = 1000;
+    
+    if (a_input && !m_waitingForInput)
+    {
+        lock_guard<mutex> lock(m_group->m_mutex);
+        
+        m_waitingForInput = true;
+        m_group->m_waitingForInput++;
+        m_group->m_changed.notify_all();
+    }
+    
+    if (m_waits < YIELDS)
+        this_thread::yield();
+    
+    else
+        this_thread::sleep_for(chrono::microseconds(min(MAX_SLEEP, 1 << min(m_waits - YIELDS, 10))));
+    
+    m_waits++;
+}
+/*void Emulator::AwaitReady(const bool& a_input); */
+
+
+/*
+NAME
+ 
+    EndWait - Ends the wait of a thread for the input or the channel of an instruction
+
+SYNOPSIS
+ 
+    void EndWait();
+
+DESCRIPTION
+ 
+    This function is called once the input or the channel a thread
+    waited for was ready, or the thread finished while it waited, so that
+    the next wait starts again with yields and the thread is no longer
+    counted as waiting for input.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::EndWait()
+{
+    m_waits = 0;
+    
+    if (m_waitingForInput)
+    {
+        lock_guard<mutex> lock(m_group->m_mutex);
+        
+        m_waitingForInput = false;
+        m_group->m_waitingForInput--;
+    }
+}
+/*void Emulator::EndWait(); */
+
+
+/*
+NAME
+ 
+    RunThread - Runs a thread started by FORK
+
+SYNOPSIS
+ 
+    void RunThread(const int a_start, ProgramThread *a_thread);
+
+DESCRIPTION
+ 
+    This function is run on the host thread of "a_thread". It interprets
+    the program from location "a_start" until the thread halts, records a
+    run-time error or is stopped. The errors are recorded apart from those
+    of the other threads and kept in "a_thread", each statement starting
+    with the number of the thread that recorded it; an error stops every
+    thread of the run.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::RunThread(const int a_start, ProgramThread *a_thread)
+{
+    Errors::Scope errors;
+    
+    Execute(a_start);
+    
+    string number = "THREAD# " + to_string(m_threadNumber) + " ";
+    const vector<string>& messages = Errors::GetErrorMessages();
+    
+    // the messages alternate between the statement and the description of each error,
+    // and the errors of the threads this one waited for are already numbered
+    for (size_t i = 0; i < messages.size(); i += 2)
+        a_thread->m_errorStatements.push_back(messages[i].compare(0, 8, "THREAD# ") == 0
+                                              ? messages[i] : number + messages[i]);
+    
+    a_thread->m_errorCodes = Errors::GetErrorCodes();
+    
+    if (!a_thread->m_errorCodes.empty())
+        m_group->m_stop = true;
+    
+    EndWait();
+    
+    // the thread that started this one may be waiting for it at a JOIN
+    lock_guard<mutex> lock(m_group->m_mutex);
+    
+    a_thread->m_finished = true;
+    m_group->m_changed.notify_all();
+}
+/*void Emulator::RunThread(const int a_start, ProgramThread *a_thread); */
+
+
+/*
+NAME
+ 
+    AdoptThread - Adds what a finished thread did to this one
+
+SYNOPSIS
+ 
+    void AdoptThread(const ProgramThread& a_thread);
+
+DESCRIPTION
+ 
+    This function records the run-time errors of "a_thread", which has
+    finished, as errors of this thread, and adds its instructions and its
+    changes of watched locations to those of this thread.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::AdoptThread(const ProgramThread& a_thread)
+{
+    for (size_t i = 0; i < a_thread.m_errorCodes.size(); i++)
+        Errors::RecordError(a_thread.m_errorCodes[i], a_thread.m_errorStatements[i]);
+    
+    m_threadInstrCount += a_thread.m_emul->GetInstructionCount();
+    m_watchHitCount += a_thread.m_emul->m_watchHitCount;
+    
+    for (const WatchHit& hit : a_thread.m_emul->m_watchHits)
+        if ((int)m_watchHits.size() < MAX_WATCH_HITS)
+            m_watchHits.push_back(hit);
+}
+/*void Emulator::AdoptThread(const ProgramThread& a_thread); */
+
+
+/*
+NAME
+ 
+    EndThreads - Stops the threads of the run and waits for them
+
+SYNOPSIS
+ 
+    void EndThreads(const bool& a_report);
+
+DESCRIPTION
+ 
+    This function stops every thread started by the program that has not
+    been waited for by a JOIN and waits for them, once the program has
+    halted, recorded a run-time error or is being discarded. If "a_report",
+    their errors, instructions and changes of watched locations are added
+    to those of the program.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::EndThreads(const bool& a_report)
+{
+    if (m_threads == nullptr)
+        return;
+    
+    m_group->m_stop = true;
+    
+    while (true)
+    {
+        ProgramThread *ended = nullptr;
+        
+        {
+            lock_guard<mutex> lock(m_group->m_mutex);
+            
+            for (const unique_ptr<ProgramThread>& programThread : m_group->m_threads)
+            {
+                if (!programThread->m_joined)
+                {
+                    ended = programThread.get();
+                    ended->m_joined = true;
+                    break;
+                }
+            }
+        }
+        
+        if (ended == nullptr)
+            break;
+        
+        // a thread waited for by another has ended once that one has
+        ended->m_thread.join();
+        
+        if (a_report)
+            AdoptThread(*ended);
+    }
+    
+    m_threads.reset();
+    m_group = nullptr;
+}
+/*void Emulator::EndThreads(const bool& a_report); */
+
+
+/*
+NAME
+ 
+    InputChecker - Checks the input at run-time
+
+SYNOPSIS
+ 
+    bool InputChecker(const string& a_input, int& a_value) const;
+
+DESCRIPTION
+ 
+    This function records the error found by InputError() in "a_input",
+    if there is one, and places its value in "a_value" otherwise.
+ 
+    Returns true - if "a_input" is a valid input
+    Returns false - Otherwise
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::InputChecker(const string& a_input, int& a_value) const
+{
+    int errorCode = InputError(a_input, a_value);
+    
+    if (errorCode >= 0)
+    {
+        //Code 28: Only Integers Are Supported by Quack3200
+        //Code 19: Constant Too Large For Quack3200
+        Errors::RecordError(errorCode, a_input);
+        
+        return false;
+    }
+    
+    return true;
+}
+/*bool emulator::InputChecker(const string& a_input, int& a_value) const; */
+
+
+/*
+NAME
+ 
+    InputError - Finds the error in a run-time input
+
+SYNOPSIS
+ 
+    static int InputError(const string& a_input, int& a_value);
+    static int InputError(const char *a_first, const char *a_last, int& a_value);
+
+DESCRIPTION
+ 
+    This function determines if all characters of the input are
+    numeric (except for the first character which could be a
+    negative sign). It also determines whether the input fits
+    the memory location of Quack3200. The input is "a_input", or the
+    characters from "a_first" up to "a_last", whose value is placed
+    in "a_value" if it is valid. The checks and the value come from
+    one pass of Numeric::Parse().
+ 
+    Returns -1 - if conditions are met
+    Returns the code of the error otherwise (28 or 19)
+*/
+
+template <class Machine>
+int BasicEmulator<Machine>::InputError(const string& a_input, int& a_value)
+{
+    return InputError(a_input.data(), a_input.data() + a_input.size(), a_value);
+}
+
+template <class Machine>
+int BasicEmulator<Machine>::InputError(const char *a_first, const char *a_last, int& a_value)
+{
+    //at most WORD_DIGITS digits after the sign: maxVal = 99,999,999 on the Quack3200
+    Numeric::ParseStatus status = Numeric::Parse(a_first, a_last, Machine::WORD_DIGITS, a_value);
+    
+    //Test 1: Is input an integer? (there must be at least one digit)
+    if (status == Numeric::NS_NotInteger)
+    {
+        //Code 28: Only Integers Are Supported by Quack3200
+        return 28;
+    }
+    
+    //Test 2: Does it fit Quack3200 memory?
+    if (status == Numeric::NS_TooLong)
+    {
+        //Code 19: Constant Too Large For Quack3200
+        return 19;
+    }
+    
+    return -1;
+}
+/*int Emulator::InputError(const char *a_first, const char *a_last, int& a_value); */
+
+
+/*
+NAME
+ 
+    InputWords - Finds the values of the input of a READV instruction
+
+SYNOPSIS
+ 
+    static int InputWords(const string& a_input, int a_values[], const int& a_count,
+                          int& a_parsed, string& a_word);
+
+DESCRIPTION
+ 
+    This function places the values of the first "a_count" words of
+    "a_input", which are separated by white space, in "a_values". Each
+    word is checked by InputError(). The number of values found before
+    the first error is placed in "a_parsed", and the word in error in
+    "a_word".
+ 
+    Returns -1 - if all the values were found
+    Returns 31 - if "a_input" has fewer words
+    Returns the code of the error of the invalid word otherwise (28 or 19)
+*/
+
+template <class Machine>
+int BasicEmulator<Machine>::InputWords(const string& a_input, int a_values[], const int& a_count,
+                                       int& a_parsed, string& a_word)
+{
+    const char *next = a_input.data();
+    const char *end = next + a_input.size();
+    
+    for (a_parsed = 0; a_parsed < a_count; a_parsed++)
+    {
+        while (next != end && isspace(*next))
+            next++;
+        
+        //Code 31: No Input Available For READ Instruction
+        if (next == end)
+            return 31;
+        
+        const char *first = next;
+        
+        while (next != end && !isspace(*next))
+            next++;
+        
+        int errorCode = InputError(first, next, a_values[a_parsed]);
+        
+        if (errorCode >= 0)
+        {
+            a_word.assign(first, next);
+            return errorCode;
+        }
+    }
+    
+    return -1;
+}
+/*int Emulator::InputWords(const string& a_input, int a_values[], const int& a_count,
+  int& a_parsed, string& a_word); */
+
+
+/*
+NAME
+ 
+    ResultChecker - Checks the result of an operation at run-time
+
+SYNOPSIS
+ 
+    bool ResultChecker(const int& a_regNumber, const int& a_regVal,
+                const int& a_memVal, const opcodeName& a_operation) const;
+
+DESCRIPTION
+ 
+    This function performs the "a_operation" (ADD, SUB, or MULT)
+    on the "a_regVal", the register value
+    and the "a_memVal", the value in memory location
+    to determine whether the result can be stored into Quack3200 register.
+    "a_regNumber" is used to specify register number when giving errors
+    if there is any.
+ 
+    Returns true - if result fits into register
+    Returns false - Otherwise
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::ResultChecker(const int& a_regNumber, const int& a_regVal,
+                             const int& a_memVal, const OpcodeType& a_operation) const
+{
+    // to specify the register number with the overflow if there is an error
+    string errorMsg = "REG# ";
+    errorMsg += to_string(a_regNumber);
+    
+    int maxVal = Machine::MAXVAL;
+    int minVal = Machine::MINVAL;
+    
+    // the sum and the difference of two words of 9 digits may not fit an int
+    long long regVal = a_regVal;
+    
+    if (a_operation == ADD)
+    {
+        //if addition results in a number bigger than maxVal or smaller than minVal
+        if ( (regVal + a_memVal > maxVal) || (regVal + a_memVal < minVal) )
+        {
+            //Code 25: ADD Instruction Causes Overflow In a Register
+            Errors::RecordError(25, errorMsg);
+            
+            return false;
+        }
     }
     
     else if (a_operation == SUB)
     {
         //if subtraction results in a number bigger than maxVal or smaller than minVal
-        if ( (a_regVal - a_memVal > maxVal) || (a_regVal - a_memVal < minVal) )
+        if ( (regVal - a_memVal > maxVal) || (regVal - a_memVal < minVal) )
         {
             //Code 26: SUB Instruction Causes Overflow In a Register
             Errors::RecordError(26, errorMsg);
@@ -305,10 +1593,494 @@ bool Emulator::ResultChecker(const int& a_regNumber, const int& a_regVal,
     }
     
     // we do not have to worry about the division operation because numbers
-    // will stay within the Quack3200 constant range (-99,999,999 - 99,999,999)
+    // will stay within the constant range (-99,999,999 - 99,999,999 on the Quack3200)
     // since fractions are not allowed
     
     return true;
 }
 /*bool emulator::resultChecker(const int& a_regNumber, const int& a_regVal,
   const int& a_memVal, const opcodeName& a_operation) const; */
+
+
+/*
+NAME
+ 
+    LoadNative - Loads a translation of the program made by AotTranslator
+
+SYNOPSIS
+ 
+    bool LoadNative(const string& a_path);
+
+DESCRIPTION
+ 
+    This function loads the shared library "a_path", compiled from the
+    output of AotTranslator::Translate(), so that RunProgram() runs the
+    translated program. The translation is only run if it was made from
+    the program that is in memory when RunProgram() is called.
+    AotTranslator only translates programs of the Quack3200.
+ 
+    Returns true - if the library holds a translated program
+    Returns false - Otherwise (the program will be interpreted)
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::LoadNative(const string& a_path)
+{
+#ifndef _WIN32
+    if (!is_same<Machine, Quack3200>::value)
+        return false;
+    
+    void *lib = dlopen(a_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    
+    if (lib == nullptr)
+        return false;
+    
+    void *entry = dlsym(lib, QUACK_AOT_ENTRY);
+    void *image = dlsym(lib, QUACK_AOT_IMAGE);
+    
+    if (entry == nullptr || image == nullptr)
+    {
+        dlclose(lib);
+        return false;
+    }
+    
+    if (m_nativeLib != nullptr)
+        dlclose(m_nativeLib);
+    
+    m_nativeLib = lib;
+    m_native = (QuackAotEntry)entry;
+    m_nativeImage = *(const unsigned long long *)image;
+    
+    return true;
+#else
+    (void)a_path;
+    return false;
+#endif
+}
+/*bool Emulator::LoadNative(const string& a_path); */
+
+
+/*
+NAME
+ 
+    ExecuteNative - Runs the translated program
+
+SYNOPSIS
+ 
+    int ExecuteNative();
+
+DESCRIPTION
+ 
+    This function runs the translated program loaded by LoadNative()
+    if it was made from the program in memory, and records a run-time
+    error otherwise. The output, the run-time errors and the number of
+    instructions dispatched are the same as those of the interpreter.
+ 
+    Returns -1 - if the program halted, recorded a run-time error or was suspended
+    Returns the location at which the interpreter must continue otherwise
+*/
+
+template <class Machine>
+int BasicEmulator<Machine>::ExecuteNative()
+{
+    if (AotTranslator::ImageHash(m_memory) != m_nativeImage)
+    {
+        //Code 45: Translated Program Does Not Match The Program In Memory
+        Errors::RecordError(45, "LOCATION# 100");
+        return -1;
+    }
+    
+    QuackAotContext ctx;
+    ctx.m_memory = m_memory;
+    ctx.m_reg = m_reg;
+    ctx.m_instrCount = m_instrCount;
+    ctx.m_pc = 100;
+    ctx.m_host = this;
+    ctx.m_read = NativeRead;
+    ctx.m_write = NativeWrite;
+    ctx.m_error = NativeError;
+    ctx.m_readWords = NativeReadWords;
+    ctx.m_writeWords = NativeWriteWords;
+    
+    int status = m_native(&ctx);
+    m_instrCount = ctx.m_instrCount;
+    
+    if (status == AOT_HALT)
+    {
+        m_io->Halt();
+        return -1;
+    }
+    
+    // a READ without input ready left the program, which continues on Resume()
+    if (status == AOT_ERROR && m_suspendedRead)
+    {
+        m_suspendedRead = false;
+        m_instrCount--;
+        m_resumeAt = ctx.m_pc - 1;
+        m_channelWait = false;
+        return -1;
+    }
+    
+    if (status == AOT_ERROR)
+        return -1;
+    
+    // the program changed its own code
+    return ctx.m_pc;
+}
+/*int Emulator::ExecuteNative(); */
+
+
+/*
+NAME
+ 
+    NativeRead, NativeWrite, NativeError, NativeReadWords, NativeWriteWords -
+    Services of the emulator for a translated program
+
+SYNOPSIS
+ 
+    static bool NativeRead(void *a_host, int a_address);
+    static void NativeWrite(void *a_host, int a_value);
+    static void NativeError(void *a_host, int a_errorCode, int a_regNumber);
+    static bool NativeReadWords(void *a_host, int a_address, int a_count);
+    static void NativeWriteWords(void *a_host, const int *a_values, int a_count);
+
+DESCRIPTION
+ 
+    These functions perform the READ, WRITE, READV and WRITEV instructions
+    (whose block is in memory) and record
+    the run-time errors of the translated program the same way as the
+    interpreter, through the input and output given to SetIO(). "a_host"
+    is the emulator running the program.
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::NativeRead(void *a_host, int a_address)
+{
+    BasicEmulator *emul = (BasicEmulator *)a_host;
+    
+    // the translated program leaves as if in error, see ExecuteNative()
+    if (!emul->m_io->Ready())
+    {
+        emul->m_suspendedRead = true;
+        return false;
+    }
+    
+    return emul->ReadInput(a_address);
+}
+
+template <class Machine>
+void BasicEmulator<Machine>::NativeWrite(void *a_host, int a_value)
+{
+    ((BasicEmulator *)a_host)->m_io->Write(a_value);
+}
+
+template <class Machine>
+void BasicEmulator<Machine>::NativeError(void *, int a_errorCode, int a_regNumber)
+{
+    // to specify the register where error is happening in
+    string errorMsg = "REG# ";
+    errorMsg += to_string(a_regNumber);
+    
+    Errors::RecordError(a_errorCode, errorMsg);
+}
+
+template <class Machine>
+bool BasicEmulator<Machine>::NativeReadWords(void *a_host, int a_address, int a_count)
+{
+    BasicEmulator *emul = (BasicEmulator *)a_host;
+    
+    if (!emul->m_io->Ready())
+    {
+        emul->m_suspendedRead = true;
+        return false;
+    }
+    
+    // no location is watched while a translated program runs
+    return emul->ReadWords(a_address, a_count, -1);
+}
+
+template <class Machine>
+void BasicEmulator<Machine>::NativeWriteWords(void *a_host, const int *a_values, int a_count)
+{
+    ((BasicEmulator *)a_host)->m_io->WriteWords(a_values, a_count);
+}
+/*bool Emulator::NativeReadWords(void *a_host, int a_address, int a_count); */
+
+
+/*
+NAME
+ 
+    AllocateMemory - Allocates the memory of the Quack3200 on pages of its own
+
+SYNOPSIS
+ 
+    static int *AllocateMemory();
+
+DESCRIPTION
+ 
+    This function maps the memory of an emulator at the start of a page,
+    so that the pages holding watched locations can be made read-only
+    without affecting anything else.
+*/
+
+template <class Machine>
+int *BasicEmulator<Machine>::AllocateMemory()
+{
+#ifndef _WIN32
+    void *memory = mmap(nullptr, MemoryBytes(MEMSZ), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    
+    if (memory == MAP_FAILED)
+        throw bad_alloc();
+    
+    return (int *)memory;
+#else
+    return new int[MEMSZ];
+#endif
+}
+/*int *Emulator::AllocateMemory(); */
+
+
+/*
+NAME
+ 
+    Watch - Records the changes the program makes to a range of locations
+
+SYNOPSIS
+ 
+    bool Watch(const int& a_first, const int& a_last);
+
+DESCRIPTION
+ 
+    This function watches the locations "a_first" to "a_last". The pages
+    of memory holding them are made read-only, so the instructions of the
+    program run without any check until one writes to such a page. The
+    fault is caught by a handler of SIGSEGV and the write is traced back
+    to the location and to the instruction that made it, which are
+    recorded for GetWatchHits() if the location is watched.
+ 
+    Only writes to the pages of watched locations are slowed down.
+    Watching programs are always interpreted, not run from a translation
+    loaded by LoadNative().
+ 
+    Returns true - if the locations are watched
+    Returns false - Otherwise (the range is not in memory or pages cannot be protected)
+*/
+
+template <class Machine>
+bool BasicEmulator<Machine>::Watch(const int& a_first, const int& a_last)
+{
+#ifndef _WIN32
+    if (a_first < 0 || a_last >= MEMSZ || a_first > a_last)
+        return false;
+    
+    WatchSignal::Install();
+    
+    m_watches.push_back({a_first, a_last});
+    m_watched.m_watching = true;
+    ProtectWatches(true);
+    
+    return true;
+#else
+    (void)a_first;
+    (void)a_last;
+    return false;
+#endif
+}
+/*bool Emulator::Watch(const int& a_first, const int& a_last); */
+
+
+/*
+NAME
+ 
+    ClearWatches - Removes every watched range
+
+SYNOPSIS
+ 
+    void ClearWatches();
+
+DESCRIPTION
+ 
+    This function makes the whole memory writable again. The changes
+    recorded by the last run are kept.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::ClearWatches()
+{
+    ProtectWatches(false);
+    m_watches.clear();
+    m_watched.m_watching = false;
+}
+/*void Emulator::ClearWatches(); */
+
+
+/*
+NAME
+ 
+    ProtectWatches - Makes the pages holding watched locations read-only, or writable again
+
+SYNOPSIS
+ 
+    void ProtectWatches(const bool& a_protect);
+
+DESCRIPTION
+ 
+    This function makes every page holding a watched location read-only
+    if "a_protect" is true, and the whole memory writable otherwise, so
+    that the emulator can load a program without being stopped.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::ProtectWatches(const bool& a_protect)
+{
+#ifndef _WIN32
+    if (m_watches.empty())
+        return;
+    
+    if (!a_protect)
+    {
+        mprotect(m_memory, MemoryBytes(MEMSZ), PROT_READ | PROT_WRITE);
+        return;
+    }
+    
+    for (const pair<int, int>& watch : m_watches)
+    {
+        char *first = PageOf(m_memory + watch.first);
+        char *last = PageOf(m_memory + watch.second);
+        
+        mprotect(first, last - first + PageSize(), PROT_READ);
+    }
+#else
+    (void)a_protect;
+#endif
+}
+/*void Emulator::ProtectWatches(const bool& a_protect); */
+
+
+/*
+NAME
+ 
+    RecordWatchHit - Records the change of the location whose page was written by an instruction
+
+SYNOPSIS
+ 
+    void RecordWatchHit(const int& a_pc);
+
+DESCRIPTION
+ 
+    This function is called after the instruction at location "a_pc"
+    wrote to a watched page. If the location it wrote to is watched, its
+    old and new contents are recorded. The page, made writable by the
+    handler of the fault, is made read-only again.
+*/
+
+template <class Machine>
+void BasicEmulator<Machine>::RecordWatchHit(const int& a_pc)
+{
+#ifndef _WIN32
+    int location = m_watched.m_fault;
+    m_watched.m_fault = -1;
+    
+    for (const pair<int, int>& watch : m_watches)
+    {
+        // other locations share the pages of watched ones
+        if (location < watch.first || location > watch.second)
+            continue;
+        
+        m_watchHitCount++;
+        
+        if ((int)m_watchHits.size() < MAX_WATCH_HITS)
+            m_watchHits.push_back({location, a_pc, m_watched.m_old, m_memory[location], m_instrCount});
+        
+        break;
+    }
+    
+    mprotect(PageOf(m_memory + location), PageSize(), PROT_READ);
+#else
+    (void)a_pc;
+#endif
+}
+/*void Emulator::RecordWatchHit(const int& a_pc); */
+
+
+#ifndef _WIN32
+
+/*
+NAME
+ 
+    Install, Handle - The handler of writes to watched pages
+
+SYNOPSIS
+ 
+    static void Install();
+    static void Handle(int a_signal, siginfo_t *a_info, void *a_context);
+
+DESCRIPTION
+ 
+    Install() makes Handle() the handler of SIGSEGV, once for the process.
+ 
+    Handle() is called when an instruction writes to a read-only page. If
+    the page belongs to the memory of the emulator interpreting a program
+    on this thread, the location and its contents are kept for
+    RecordWatchHit() and the page is made writable, so that the write is
+    done when the handler returns. Any other fault is passed on to the
+    handler that was replaced.
+*/
+
+void WatchSignal::Install()
+{
+    static const bool installed = []()
+    {
+        // the page size must be known before the handler runs
+        PageSize();
+        
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = Handle;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        
+        return sigaction(SIGSEGV, &action, &m_previous) == 0;
+    }();
+    
+    (void)installed;
+}
+
+void WatchSignal::Handle(int a_signal, siginfo_t *a_info, void *a_context)
+{
+    WatchedMemory *watched = t_running;
+    const char *address = (const char *)a_info->si_addr;
+    
+    if (watched != nullptr && watched->m_watching
+        && address >= (const char *)watched->m_memory
+        && address < (const char *)(watched->m_memory + watched->m_words))
+    {
+        int location = (int)((address - (const char *)watched->m_memory) / sizeof(int));
+        
+        watched->m_old = watched->m_memory[location];
+        watched->m_fault = location;
+        mprotect(PageOf(address), PageSize(), PROT_READ | PROT_WRITE);
+        
+        return;
+    }
+    
+    // not a watched page
+    if (m_previous.sa_flags & SA_SIGINFO)
+        m_previous.sa_sigaction(a_signal, a_info, a_context);
+    
+    else if (m_previous.sa_handler != SIG_DFL && m_previous.sa_handler != SIG_IGN)
+        m_previous.sa_handler(a_signal);
+    
+    // the fault happens again and is handled as if there were no watches
+    else
+        sigaction(SIGSEGV, &m_previous, nullptr);
+}
+/*void WatchSignal::Handle(int a_signal, siginfo_t *a_info, void *a_context); */
+
+#endif
+
+
+// The machines the emulator is made for
+template class BasicEmulator<Quack3200>;
+template class BasicEmulator<Quack3200Wide>;
@@ -1,5 +1,48 @@
 //
-//        Emulator class - supports the emulation of Quack3200 programs
+//        Emulator class - supports the emulation of Quack3200 programs,
+//        on machines of the geometry given by the traits of Machine.h
+//
+//        A program may start threads with FORK, each with its own
+//        registers and host thread, which share its memory and its input
+//        and output. The memory model of the threads:
+//
+//          - LOAD, STORE and the words read by ADD, SUB, MULT, DIV and
+//            WRITE are read and written whole, but another thread may see
+//            the STOREs of a thread later, and in another order, than
+//            they were made.
+//          - FADD r,X adds register r to X and places the previous
+//            contents of X in r in one indivisible step. The FADDs of all
+//            threads happen in one order, and each is ordered with the
+//            instructions before and after it in its thread, so that a
+//            word STOREd before a FADD on a flag is seen by a thread
+//            whose FADD (of 0, to read the flag) sees the change.
+//          - Everything a thread did before a FORK is seen by the thread
+//            it starts, and everything a thread did is seen by the
+//            thread after its JOIN.
+//          - READ, READV, RECV, MOVE and FILL write their words in no
+//            particular order; another thread may only use them once a
+//            FADD or a JOIN orders them before its use.
+//
+//        Programs pass words to each other over channels (see Channel.h):
+//        RECV c,X receives a word into X from the channel connected to
+//        port c (0 to 4) of RECV, and SEND c,X sends the word at X on the
+//        channel connected to port c of SEND. A program is suspended at a
+//        SEND to a full channel or a RECV from an empty one, as at a READ
+//        without input. When a run ends, the channels it used are closed:
+//        a RECV once the sender closed the channel and the words sent are
+//        all received, or a SEND once the receiver closed it, is a
+//        run-time error. The threads of a program share its ports, one
+//        thread at a time, and the words received by RECV are published to
+//        the other threads as those of READ are.
+//
+//        A thread ends when it reaches the HALT instruction, and the
+//        threads still running when the program itself halts are stopped.
+//        A thread waiting for the input of a READ or READV suspends the
+//        program at a JOIN waiting for it, so that the input can be given.
+//        Each thread has the instruction budget of the program. A run-time
+//        error in any thread stops every thread, and the errors of a thread
+//        other than the program itself are reported with its number
+//        (THREAD# n).
 //
 
 #ifndef _EMULATOR_H
@@ -7,7 +50,134 @@
 
 #include "stdafx.h"
 
-class Emulator
+// The input and output of the programs run by the emulator
+class EmulatorIO
+{
+
+public:
+    
+    virtual ~EmulatorIO() {}
+    
+    // Called before the program starts
+    virtual void Begin() {}
+    
+    // Determines if the input of a READ instruction is available now; if not,
+    // the program is suspended at the READ until Emulator::Resume() is called
+    virtual bool Ready() {return true;}
+    
+    // Supplies the input of a READ instruction, false if there is none
+    virtual bool Read(string&) = 0;
+    
+    // Receives the value of a WRITE instruction
+    virtual void Write(const int&) = 0;
+    
+    // Supplies the input of a READV instruction, words separated by white space,
+    // false if there is none. The words are read one at a time unless overridden.
+    virtual bool ReadWords(string& a_input, const int& a_count)
+    {
+        string word;
+        a_input.clear();
+        
+        for (int i = 0; i < a_count && Read(word); i++)
+        {
+            a_input += word;
+            a_input += ' ';
+        }
+        
+        return !a_input.empty();
+    }
+    
+    // Receives the values of a WRITEV instruction, written one at a time unless overridden
+    virtual void WriteWords(const int a_values[], const int& a_count)
+    {
+        for (int i = 0; i < a_count; i++)
+            Write(a_values[i]);
+    }
+    
+    // Called when the program executes HALT
+    virtual void Halt() {}
+};
+
+// The input and output of the assembler's console
+class ConsoleIO : public EmulatorIO
+{
+
+public:
+    
+    void Begin()
+    {
+        cout<<"RESULTS FROM EMULATING PROGRAM:"<<endl<<endl;
+    }
+    
+    bool Read(string& a_input)
+    {
+        cout<<"? ";
+        cin>>a_input;
+        cin.ignore();
+        
+        return true;
+    }
+    
+    void Write(const int& a_value)
+    {
+        char line[Numeric::MAXCHARS + 1];
+        char *end = Numeric::Format(line, a_value);
+        *end++ = '\n';
+        
+        cout.write(line, end - line)<<flush;
+    }
+    
+    // The words of a READV have one prompt
+    bool ReadWords(string& a_input, const int& a_count)
+    {
+        string word;
+        a_input.clear();
+        cout<<"? ";
+        
+        for (int i = 0; i < a_count && cin>>word; i++)
+        {
+            a_input += word;
+            a_input += ' ';
+        }
+        cin.ignore();
+        
+        return true;
+    }
+    
+    // The values of a WRITEV are formatted together and flushed once
+    void WriteWords(const int a_values[], const int& a_count)
+    {
+        string output;
+        char digits[Numeric::MAXCHARS];
+        
+        for (int i = 0; i < a_count; i++)
+        {
+            output.append(digits, Numeric::Format(digits, a_values[i]));
+            output += '\n';
+        }
+        
+        cout<<output<<flush;
+    }
+    
+    void Halt()
+    {
+        cout<<endl<<"END OF EMULATION"<<endl<<endl<<endl;
+    }
+};
+
+// The memory of an emulator as seen by the handler of writes to watched pages
+struct WatchedMemory
+{
+    int *m_memory;                          // The memory of the machine, aligned to pages
+    int m_words;                            // Its size in words
+    bool m_watching;                        // == true if a range of it is watched
+    volatile int m_fault;                   // The location of the last write to a watched page, -1 if none
+    int m_old;                              // Its contents before the write
+};
+
+// Emulates a machine of the geometry given by "Machine" (see Machine.h)
+template <class Machine = Quack3200>
+class BasicEmulator
 {
 
 public:
@@ -27,48 +197,459 @@ public:
         BM,         // BRANCH MINUS    10
         BZ,         // BRANCH ZERO     11
         BP,         // BRANCH POSITIVE 12
-        HALT        // HALT            13
+        HALT,       // HALT            13
+        READV,      // VECTOR READ     14
+        WRITEV,     // VECTOR WRITE    15
+        FORK,       // START THREAD    16
+        JOIN,       // WAIT FOR THREAD 17
+        FADD,       // FETCH AND ADD   18
+        
+        // SEND and RECV, with the port of SEND after those of RECV in the register (see CHANNEL_PORTS)
+        CHANNEL,    // SEND OR RECV    19
+        
+        // MOVE and FILL with their second register added (20 to 29 and 30 to 39)
+        MOVE = 20,  // BLOCK MOVE      20
+        FILL = 30,  // BLOCK FILL      30
+        
+        // ADD to STORE with their address indexed by a register, as
+        // INDEXED + 10 * (opcode - ADD) + index register (40 to 99)
+        INDEXED = 40
     };
     
     // The size of the memory of the Quack3200
-    const static int MEMSZ = 100000;
+    static constexpr int MEMSZ = Machine::MEMSZ;
     
-    Emulator()
+    // A change of a watched location made by the program
+    struct WatchHit
     {
+        int m_location;                     // The location that was changed
+        int m_pc;                           // The location of the instruction changing it
+        int m_oldValue;                     // Its contents before the change
+        int m_newValue;                     // Its contents after the change
+        long long m_instruction;            // The number of the instruction in the run
+    };
+    
+    // The most changes of watched locations recorded by one run
+    const static int MAX_WATCH_HITS = 10000;
+    
+    // The most threads the FORKs of one run may start
+    const static int MAX_THREADS = 64;
+    
+    // The ports of RECV, and of SEND, that channels may be connected to
+    const static int CHANNEL_PORTS = 5;
+    
+    BasicEmulator()
+    {
+        m_memory = AllocateMemory();
         memset(m_memory, 0, MEMSZ * sizeof(int));
+        m_watched = {m_memory, MEMSZ, false, -1, 0};
         
         for (int i = 0; i < 10; i++)
             m_reg[i] = 0;
+        
+        m_instrCount = 0;
+        m_resumeAt = -1;
+        m_suspendedRead = false;
+        m_channelWait = false;
+        m_nativeLib = nullptr;
+        m_native = nullptr;
+        m_nativeImage = 0;
+        m_io = &m_console;
+        m_watchHitCount = 0;
+        m_budget = 0;
+        m_trace = nullptr;
+        m_threadInstrCount = 0;
+        m_group = nullptr;
+        m_threadNumber = 0;
+        m_waits = 0;
+        m_waitingForInput = false;
+        fill_n(m_channels, 2 * CHANNEL_PORTS, nullptr);
     }
     
+    // Stops the threads of the program, unloads the translated program and releases the memory
+    ~BasicEmulator();
+    
     // Records instructions and data into Quack3200 memory
     bool InsertMemory(const int& a_location, const int& a_contents)
     {
-        if (a_location >= 0 && a_location < 100'000)
+        if (a_location >= 0 && a_location < MEMSZ)
+        {
+            // watched pages are read-only while the program runs
+            if (!m_watches.empty())
+                ProtectWatches(false);
+            
             m_memory[a_location] = a_contents;
+            
+            if (!m_watches.empty())
+                ProtectWatches(true);
+        }
         
-        // location will never exceed 99,999 as it is checked
+        // location will never exceed MEMSZ - 1 as it is checked
         // by LocationNextInstruction Function
         
         return true;
     }
     
+    // Replaces the whole memory with an image and clears the registers
+    void LoadImage(const int a_image[])
+    {
+        ProtectWatches(false);
+        memcpy(m_memory, a_image, MEMSZ * sizeof(int));
+        ProtectWatches(true);
+        
+        for (int i = 0; i < 10; i++)
+            m_reg[i] = 0;
+    }
+    
     // Runs the Quack3200 program recorded in memory
     bool RunProgram();
     
-    // Checks run-time inputs
-    bool InputChecker(const string&) const;
+    // Continues a program suspended at a READ, SEND, RECV or JOIN instruction
+    bool Resume();
+    
+    // Determines if the program is waiting for the input of a READ instruction, or for a channel
+    bool IsSuspended() const
+    {
+        return m_resumeAt >= 0;
+    }
+    
+    // Determines if the program is waiting for the channel of a SEND or RECV instruction
+    bool IsWaitingForChannel() const
+    {
+        return m_resumeAt >= 0 && m_channelWait;
+    }
+    
+    // Resumes the program while it waits for a channel, backing off while the channel is not ready
+    void AwaitChannels();
+    
+    // Uses other input and output than the console (nullptr for the console)
+    void SetIO(EmulatorIO *a_io)
+    {
+        m_io = a_io != nullptr ? a_io : &m_console;
+    }
+    
+    // Connects port "a_port" of RECV to the receiving end of a channel, nullptr for none
+    bool ConnectReceive(const int& a_port, Channel *a_channel)
+    {
+        if (a_port < 0 || a_port >= CHANNEL_PORTS)
+            return false;
+        
+        m_channels[a_port] = a_channel;
+        return true;
+    }
+    
+    // Connects port "a_port" of SEND to the sending end of a channel, nullptr for none
+    bool ConnectSend(const int& a_port, Channel *a_channel)
+    {
+        if (a_port < 0 || a_port >= CHANNEL_PORTS)
+            return false;
+        
+        m_channels[CHANNEL_PORTS + a_port] = a_channel;
+        return true;
+    }
+    
+    // Loads a translation of the program made by AotTranslator
+    bool LoadNative(const string&);
+    
+    // Returns the memory of the Quack3200
+    const int *GetMemory() const
+    {
+        return m_memory;
+    }
+    
+    // Records the changes the program makes to a range of locations
+    bool Watch(const int&, const int&);
+    
+    // Removes every watched range
+    void ClearWatches();
+    
+    // Returns the changes of watched locations recorded by the last run
+    const vector<WatchHit>& GetWatchHits() const
+    {
+        return m_watchHits;
+    }
+    
+    // Returns the number of changes of watched locations made by the last run
+    long long GetWatchHitCount() const
+    {
+        return m_watchHitCount;
+    }
+    
+    // Stops each run with a run-time error once it has executed a number of instructions, 0 for no limit
+    void SetInstructionBudget(const long long& a_budget)
+    {
+        m_budget = a_budget;
+    }
+    
+    // Writes the location and contents of each instruction executed to a stream, nullptr for none,
+    // followed by the number of the thread executing it once the program has started threads
+    void SetTrace(ostream *a_trace)
+    {
+        m_trace = a_trace;
+    }
+    
+    // Checks a run-time input and finds its value
+    bool InputChecker(const string&, int&) const;
+    
+    // Finds the error in a run-time input and its value, -1 if there is none
+    static int InputError(const string&, int&);
+    
+    // Finds the error in a run-time input and its value, -1 if there is none
+    static int InputError(const char *, const char *, int&);
+    
+    // Finds the values of the input of a READV instruction, returns the code of the first error or -1
+    static int InputWords(const string&, int [], const int&, int&, string&);
     
     // Checks the result of operations at run-time
     bool ResultChecker(const int&, const int&, const int&, const OpcodeType&) const;
     
+    // Returns the number of instructions dispatched by the last run, including its threads
+    long long GetInstructionCount() const
+    {
+        return m_instrCount + m_threadInstrCount;
+    }
+    
     
 private:
     
-    int m_memory[MEMSZ];                    // The memory of the Quack3200
+    BasicEmulator(const BasicEmulator&) = delete;
+    BasicEmulator& operator=(const BasicEmulator&) = delete;
+    
+    // The emulator of a thread started by FORK, sharing the memory and the input and output of another
+    BasicEmulator(BasicEmulator&, const int&);
+    
+    // A thread started by FORK
+    struct ProgramThread
+    {
+        unique_ptr<BasicEmulator> m_emul;   // The emulator running it
+        thread m_thread;                    // The host thread running it
+        int m_parent;                       // The number of the thread that started it
+        bool m_joined;                      // == true once a JOIN or the end of the run waits for it
+        bool m_finished;                    // == true once it has halted or stopped
+        vector<string> m_errorStatements;   // The statement of each of its run-time errors
+        vector<int> m_errorCodes;           // The code of each of its run-time errors
+    };
+    
+    // The threads of one run, shared by the emulators running them
+    struct ThreadGroup
+    {
+        ThreadGroup(): m_stop(false), m_waitingForInput(0) {}
+        
+        mutex m_mutex;                      // Guards the threads, the input and output and the trace
+        condition_variable m_changed;       // Signalled when a thread finishes or starts waiting for input
+        atomic<bool> m_stop;                // == true once every thread must stop
+        int m_waitingForInput;              // The number of threads waiting for the input of a READ or READV
+        vector<unique_ptr<ProgramThread>> m_threads;  // The threads, by number - 1
+    };
+    
+    // Interprets instructions starting at a location, with the loop made for the features in use
+    void Execute(int);
+    
+    // The policies of the interpreter: each feature is only checked by the loops made with it
+    struct NoWatch
+    {
+        static void Written(BasicEmulator&, const int&) {}
+    };
+    
+    struct CheckWatch
+    {
+        // Records the change made by the instruction at "a_pc" if it wrote a watched page
+        static void Written(BasicEmulator& a_emul, const int& a_pc)
+        {
+            if (a_emul.m_watched.m_fault >= 0)
+                a_emul.RecordWatchHit(a_pc);
+        }
+    };
+    
+    struct NoBudget
+    {
+        static bool Exhausted(const BasicEmulator&) {return false;}
+    };
+    
+    struct CheckBudget
+    {
+        // Determines if the run has executed all the instructions it may
+        static bool Exhausted(const BasicEmulator& a_emul) {return a_emul.m_instrCount >= a_emul.m_budget;}
+    };
+    
+    struct NoTrace
+    {
+        static void Step(BasicEmulator&, const int&, const int&) {}
+    };
+    
+    struct WriteTrace
+    {
+        // Writes the location and the contents of the instruction about to be executed
+        static void Step(BasicEmulator& a_emul, const int& a_pc, const int& a_translation)
+        {
+            if (a_emul.m_group == nullptr)
+            {
+                *a_emul.m_trace<<a_pc<<' '<<a_translation<<'\n';
+                return;
+            }
+            
+            lock_guard<mutex> lock(a_emul.m_group->m_mutex);
+            *a_emul.m_trace<<a_pc<<' '<<a_translation<<' '<<a_emul.m_threadNumber<<'\n';
+        }
+    };
+    
+    struct NoThreads
+    {
+        static int Load(const int& a_word) {return a_word;}
+        static void Store(int& a_word, const int& a_value) {a_word = a_value;}
+        
+        static bool CompareExchange(int& a_word, int&, const int& a_desired)
+        {
+            a_word = a_desired;
+            return true;
+        }
+        
+        static bool Stopped(const BasicEmulator&) {return false;}
+        
+        // The input and output belong to the program alone
+        struct Lock
+        {
+            Lock(BasicEmulator&) {}
+        };
+    };
+    
+    struct SharedThreads
+    {
+        static_assert(sizeof(atomic<int>) == sizeof(int) && atomic<int>::is_always_lock_free,
+                      "a word must be usable as an atomic");
+        
+        // A word of the memory shared by the threads, as an atomic
+        static atomic<int>& Shared(const int& a_word)
+        {
+            return *reinterpret_cast<atomic<int> *>(const_cast<int *>(&a_word));
+        }
+        
+        static int Load(const int& a_word) {return Shared(a_word).load(memory_order_relaxed);}
+        static void Store(int& a_word, const int& a_value) {Shared(a_word).store(a_value, memory_order_relaxed);}
+        
+        // Replaces "a_word" if it holds "a_expected", which is given its contents otherwise
+        static bool CompareExchange(int& a_word, int& a_expected, const int& a_desired)
+        {
+            return Shared(a_word).compare_exchange_weak(a_expected, a_desired, memory_order_seq_cst);
+        }
+        
+        // Determines if an error or the end of the program stopped the threads
+        static bool Stopped(const BasicEmulator& a_emul)
+        {
+            return a_emul.m_group->m_stop.load(memory_order_relaxed);
+        }
+        
+        // The input and output are used by one thread at a time
+        struct Lock
+        {
+            Lock(BasicEmulator& a_emul): m_lock(a_emul.m_group->m_mutex) {}
+            
+            lock_guard<mutex> m_lock;
+        };
+    };
+    
+    // Interprets instructions starting at a location with the checks of the policies,
+    // returns the location to interpret from with another loop or -1
+    template <class Watch, class Budget, class Trace, class Threads>
+    int Interpret(int);
+    
+    // The loop made for each combination of the policies, indexed by
+    // watch + 2 * budget + 4 * trace + 8 * threads
+    typedef int (BasicEmulator::*InterpretLoop)(int);
+    static const InterpretLoop LOOPS[16];
+    
+    // Runs the translated program, returns the location to interpret from or -1
+    int ExecuteNative();
+    
+    // Reads a run-time input into a memory location
+    bool ReadInput(const int&);
+    
+    // Reads run-time inputs into a block of memory
+    bool ReadWords(const int&, const int&, const int&);
+    
+    // Executes a READV or WRITEV instruction
+    bool VectorInstruction(const int&, const int&, const int&, const int&);
+    
+    // Executes a MOVE or FILL instruction
+    void BlockInstruction(const int&, const int&, const int&, const int&);
+    
+    // Executes a SEND or RECV instruction, false if it must wait for the channel
+    bool ChannelInstruction(const int&, const int&, const int&);
+    
+    // Closes the ends of the channels connected to the ports
+    void CloseChannels();
+    
+    // Starts a thread for a FORK instruction, false if it was not started
+    bool StartThread(const int&, const int&, const int&);
+    
+    // Waits for the thread whose number a register holds, for a JOIN instruction, false if the program
+    // must be suspended for the input that thread waits for
+    bool JoinThread(const int&);
+    
+    // Waits in a thread for the input or the channel of an instruction, backing off while it is not ready
+    void AwaitReady(const bool&);
+    
+    // Ends the wait of a thread once the input or the channel of its instruction was ready
+    void EndWait();
+    
+    // Runs a thread from a location on its host thread
+    void RunThread(const int, ProgramThread *);
+    
+    // Adds the errors, instructions and changes of watched locations of a finished thread to this one's
+    void AdoptThread(const ProgramThread&);
+    
+    // Stops the threads of the run and waits for them, reporting their errors if "a_report"
+    void EndThreads(const bool&);
+    
+    // Allocates the memory of the Quack3200 on pages of its own
+    static int *AllocateMemory();
+    
+    // Makes the pages holding watched locations read-only, or writable again
+    void ProtectWatches(const bool&);
+    
+    // Records the change of the location whose page was written by an instruction
+    void RecordWatchHit(const int&);
+    
+    // The services of the emulator called by a translated program
+    static bool NativeRead(void *, int);
+    static void NativeWrite(void *, int);
+    static void NativeError(void *, int, int);
+    static bool NativeReadWords(void *, int, int);
+    static void NativeWriteWords(void *, const int *, int);
+    
+    int *m_memory;                          // The memory of the Quack3200, aligned to pages
     int m_reg[10];                          // The accumulator for the Quack3200
+    long long m_instrCount;                 // Instructions dispatched by the last run
+    int m_resumeAt;                         // The READ, SEND, RECV or JOIN the program is suspended at, -1 if none
+    bool m_suspendedRead;                   // == true if the translated program left at a READ
+    bool m_channelWait;                     // == true if the program is suspended at a SEND or RECV
+    void *m_nativeLib;                      // The library holding the translated program
+    QuackAotEntry m_native;                 // The translated program, nullptr if none
+    unsigned long long m_nativeImage;       // Hash of the image it was translated from
+    ConsoleIO m_console;                    // The input and output of the console
+    EmulatorIO *m_io;                       // The input and output of the program
+    vector<pair<int, int>> m_watches;       // The first and last location of each watched range
+    WatchedMemory m_watched;                // The memory as seen by the handler of writes to watched pages
+    vector<WatchHit> m_watchHits;           // The changes of watched locations made by the last run
+    long long m_watchHitCount;              // Their number, including those not recorded
+    long long m_budget;                     // The most instructions a run may execute, 0 for no limit
+    ostream *m_trace;                       // The stream tracing the instructions executed, nullptr if none
+    long long m_threadInstrCount;           // Instructions dispatched by the threads it waited for
+    unique_ptr<ThreadGroup> m_threads;      // The threads started by the program, nullptr if none
+    ThreadGroup *m_group;                   // The threads of the run this emulator belongs to, nullptr if none
+    int m_threadNumber;                     // 0 for the program, the number given by FORK for its threads
+    int m_waits;                            // The times in a row the thread found its instruction not ready
+    bool m_waitingForInput;                 // == true if the thread is counted as waiting for input
+    Channel *m_channels[2 * CHANNEL_PORTS]; // The channel of each port of RECV, then of SEND, nullptr if none
 };
 
+// The emulator of the Quack3200
+typedef BasicEmulator<Quack3200> Emulator;
+
+// Made in Emulator.cpp for these machines only
+extern template class BasicEmulator<Quack3200>;
+extern template class BasicEmulator<Quack3200Wide>;
+
 #endif
 
 
@@ -5,8 +5,9 @@
 #include "stdafx.h"
 
 //"giving life" to static data members
-vector<string> Errors::m_ErrorMsgs;
-map<int, string> Errors::m_ErrorList;
+Errors::Context Errors::m_Global;
+thread_local Errors::Context *Errors::m_Current = &Errors::m_Global;
+const map<int, string> Errors::m_ErrorList = Errors::BuildErrorList();
 
 /*
 NAME
@@ -30,13 +31,15 @@ void Errors::DisplayErrors()
     
     int errorIndex = 0;
     
-    for (size_t i = 0; i < m_ErrorMsgs.size() / 2; i++)
+    const vector<string>& errorMsgs = m_Current->m_ErrorMsgs;
+    
+    for (size_t i = 0; i < errorMsgs.size() / 2; i++)
     {
         // offending statement
-        cout<<m_ErrorMsgs[errorIndex]<<endl;
+        cout<<errorMsgs[errorIndex]<<endl;
         
         // error message
-        cout<<"<ERROR: "<<m_ErrorMsgs[errorIndex+1]<<">"<<endl<<endl;
+        cout<<"<ERROR: "<<errorMsgs[errorIndex+1]<<">"<<endl<<endl;
         
         // skip one because each pair is one error
         // (offending statement + error message)
@@ -44,3 +47,183 @@ void Errors::DisplayErrors()
     }
 }
 /*void Errors::DisplayErrors(); */
+
+
+/*
+NAME
+ 
+    BuildErrorList - Builds the list of all possible errors
+
+SYNOPSIS
+ 
+    static map<int, string> BuildErrorList();
+
+DESCRIPTION
+ 
+   This function returns every error code with its error message.
+   The list is built once, before any error is recorded, so that
+   it can be read by any number of threads.
+*/
+
+map<int, string> Errors::BuildErrorList()
+{
+    map<int, string> list;
+
+    /*                        Errors involving operands                                  */
+    
+    list.insert(pair<int, string>(0, "Operand Must Be Symbolic"));
+    //when operand for opcodes is numeric
+    
+    list.insert(pair<int, string>(1, "Operand Must Be Positive Integer"));
+    //when operand for ORG or DS is negative
+    
+    list.insert(pair<int, string>(2, "Operand Must Be Numeric"));
+    //when operand for ORG, DC, or DS is symbolic
+    
+    list.insert(pair<int, string>(3, "Extra Operands"));
+    //when there are more than 4 words in an instruction
+    
+    list.insert(pair<int, string>(4, "Operand Too Large For Quack3200"));
+    //when operand for DS has more than 5 digits
+    
+    list.insert(pair<int, string>(5, "Operand Exceeds Quack3200 Final Location"));
+    //when DS or ORG operands make program go beyond 99,999
+    
+    /*                                                                                   */
+    
+    /*                        Errors involving symbols/labels                            */
+    
+    list.insert(pair<int, string>(6, "Multiply Defined Symbol"));
+    //when a constant is defined more than once
+    
+    list.insert(pair<int, string>(7, "Undefined Symbol"));
+    //when a constant cannot be found in symbol table
+    
+    list.insert(pair<int, string>(8, "Symbol Does Not Meet Quack3200 Symbol Specification"));
+    // when symbol is not 1-10 char long OR
+    // does not start with an alphabetical character OR the remaining
+    // characters after first char are NOT numbers and alphabetical characters
+    
+    list.insert(pair<int, string>(9, "Multiply Defined Label"));
+    //when a "label" (NOT a constant) is used twice but there is no jump to it
+    //and so its address is not in memory to be detected by code 6
+    
+    /*                                                                                    */
+    
+    /*                        Errors involving HALT instruction                           */
+            
+    list.insert(pair<int, string>(10, "HALT Instruction Can Only Be Included Once"));
+    
+    list.insert(pair<int, string>(11, "HALT Instruction Before Location 100 Will Not Be Detected By Emulator"));
+    //to prevent emulator from going to an infinite loop looking for a HALT Instruction that is not there
+    
+    list.insert(pair<int, string>(12, "Assembler Language Statements Are Not Allowed Before HALT Instruction"));
+    list.insert(pair<int, string>(13, "Machine Language Statements Are Not Allowed After HALT Instruction"));
+    list.insert(pair<int, string>(14, "No HALT Instruction Detected for Execution Termination"));
+    
+    /*                                                                                    */
+           
+    /*                        Errors involving END instruction                            */
+
+    list.insert(pair<int, string>(15, "END Instruction Cannot Have A Label"));
+    list.insert(pair<int, string>(16, "END Instruction Can Only Be Included Once"));
+    list.insert(pair<int, string>(17, "No END Instruction Detected"));
+    list.insert(pair<int, string>(18, "Only Comments Are Allowed After END Instruction"));
+    
+    /*                                                                                    */
+    
+    /*               Errors involving location and memory of Quack3200                    */
+    
+    list.insert(pair<int, string>(19, "Constant Too Large For Quack3200"));
+    //when a large constant is defined OR a large constant is read as input
+    
+    list.insert(pair<int, string>(20, "Insufficient Memory For Translation"));
+    //when location exceeds 99,999
+    
+    /*                                                                                    */
+    
+    /*                                Other Errors                                        */
+    
+    list.insert(pair<int, string>(21, "Invalid Register Specified"));
+    //when register is not in range 0-9
+    
+    list.insert(pair<int, string>(22, "Invalid Assembly Language Statement"));
+    //when no valid instruction can be retrieved from statement
+    
+    list.insert(pair<int, string>(23, "The Origin's Operand Must be Higher Than Current Location"));
+    list.insert(pair<int, string>(24, "Comma Can Only Be Used To Separate Register From Operand"));
+    
+    list.insert(pair<int, string>(32, "Invalid Index Register Specified"));
+    //when the index of an operand (Ex: TABLE(2)) is not a register in range 0-9
+    
+    list.insert(pair<int, string>(33, "Only ADD, SUB, MULT, DIV, LOAD And STORE Can Be Indexed"));
+    
+    /*                                                                                    */
+    
+    /*                        Errors involving object modules                             */
+    
+    list.insert(pair<int, string>(36, "Imported Symbol Is Defined In The Module"));
+    
+    list.insert(pair<int, string>(37, "Imported Symbol Is Not Exported By Any Module"));
+    //when the modules are linked
+    
+    list.insert(pair<int, string>(38, "Symbol Exported By More Than One Module"));
+    //when the modules are linked
+    
+    list.insert(pair<int, string>(39, "Modules Exceed Quack3200 Memory"));
+    //when the modules placed one after the other go beyond 99,999
+    
+    /*                                                                                    */
+    
+    /*                                Run-Time Errors                                     */
+    
+    list.insert(pair<int, string>(25, "ADD Instruction Causes Overflow In a Register"));
+    //when addition of a constant and a register results in a number too large to be stored in register
+    
+    list.insert(pair<int, string>(26, "SUB Instruction Causes Overflow In a Register"));
+    //when subtraction of a constant and a register results in a number too large to be stored in register
+    
+    list.insert(pair<int, string>(27, "MULT Instruction Causes Overflow In a Register"));
+    //when multiplication of a constant and a register results in a number too large to be stored in register
+    
+    list.insert(pair<int, string>(28, "Only Integers Are Supported by Quack3200"));
+    //when input contains non-numeric characters
+    
+    list.insert(pair<int, string>(29, "Division By Zero Is Undefined"));
+    //when register value is divided by 0
+    
+    list.insert(pair<int, string>(30, "Negative Sign Cannot Be Followed By 0"));
+    //when a constant is defined as -0 (Ex: Duck dc -0)
+    
+    list.insert(pair<int, string>(31, "No Input Available For READ Instruction"));
+    //when the input of a program run through the library has ended
+    
+    list.insert(pair<int, string>(34, "Indexed Address Outside Quack3200 Memory"));
+    //when the address plus the index register is not a location of memory
+    
+    list.insert(pair<int, string>(35, "Block Exceeds Quack3200 Memory"));
+    //when the words of a MOVE or FILL instruction are not all in memory
+    
+    list.insert(pair<int, string>(40, "Instruction Budget Exhausted"));
+    //when the program has executed as many instructions as the emulator allows it
+    
+    list.insert(pair<int, string>(41, "Too Many Threads Started"));
+    //when a FORK would start more threads than the emulator allows a run
+    
+    list.insert(pair<int, string>(42, "Thread Cannot Be Joined"));
+    //when the register of a JOIN does not hold a thread started, and not yet joined, by this thread
+    
+    list.insert(pair<int, string>(43, "No Channel Connected To The Port"));
+    //when no channel is connected to the port of a SEND or RECV instruction
+    
+    list.insert(pair<int, string>(44, "Channel Closed"));
+    //when a RECV finds its channel empty and closed by the sender, or a SEND finds it closed by the receiver
+    
+    list.insert(pair<int, string>(45, "Translated Program Does Not Match The Program In Memory"));
+    //when the library given to LoadNative() was translated from another program
+    
+    /*                                                                                    */
+    
+    return list;
+}
+/*map<int, string> Errors::BuildErrorList(); */
@@ -4,8 +4,18 @@
 
 #include "stdafx.h"
 
-FileAccess::FileAccess(int argc, char *argv[])
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FileAccess::FileAccess(int argc, char *argv[]):
+m_data(nullptr), m_size(0), m_mapping(nullptr), m_nextLine(0), m_linesCounted(0)
 {
+    Metrics::ScopedTimer timer(Metrics::TM_SourceOpen);
+    
     // Check that there is exactly one run time parameter
     if(argc != 2)
     {
@@ -13,20 +23,67 @@ FileAccess::FileAccess(int argc, char *argv[])
         exit(1);
     }
     
-    // Open the file
-    m_sfile.open(argv[1], ios::in);
-
-    // If the open failed, report the error and terminate.
-    if(!m_sfile)
+#ifndef _WIN32
+    // Map the file so that it can be scanned in place
+    int fd = open(argv[1], O_RDONLY);
+    struct stat info;
+    
+    if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
     {
-        cerr << "Source file could not be opened, assembler terminated." << endl;
-        exit(1);
+        void *mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        
+        if (mapping != MAP_FAILED)
+        {
+            madvise(mapping, (size_t)info.st_size, MADV_SEQUENTIAL);
+            m_mapping = mapping;
+            m_data = (const char *)mapping;
+            m_size = (size_t)info.st_size;
+        }
     }
+    
+    if (fd >= 0)
+        close(fd);
+#endif
+    
+    // Otherwise read the whole file (empty files cannot be mapped)
+    if (m_mapping == nullptr)
+    {
+        ifstream sfile(argv[1], ios::in);
+        
+        // If the open failed, report the error and terminate.
+        if(!sfile)
+        {
+            cerr << "Source file could not be opened, assembler terminated." << endl;
+            exit(1);
+        }
+        
+        m_contents.assign(istreambuf_iterator<char>(sfile), istreambuf_iterator<char>());
+        m_data = m_contents.data();
+        m_size = m_contents.size();
+    }
+    
+    // Classify every line once, for both passes
+    SourceScanner::Scan(m_data, m_size, m_lines);
+}
+
+// Unlike the file constructor, this one cannot fail and never terminates the program.
+FileAccess::FileAccess(const char *a_data, const size_t& a_size):
+m_data(nullptr), m_size(0), m_mapping(nullptr), m_contents(a_data, a_size), m_nextLine(0),
+m_linesCounted(0)
+{
+    m_data = m_contents.data();
+    m_size = m_contents.size();
+    
+    // Classify every line once, for both passes
+    SourceScanner::Scan(m_data, m_size, m_lines);
 }
 
 FileAccess::~FileAccess()
 {
-    m_sfile.close();
+#ifndef _WIN32
+    if (m_mapping != nullptr)
+        munmap(m_mapping, m_size);
+#endif
 }
 
 
@@ -49,16 +106,57 @@ DESCRIPTION
 */
 
 bool FileAccess::GetNextLine(string &a_buff)
+{
+    LineScan scan;
+    
+    return GetNextLine(a_buff, scan);
+}
+/*bool FileAccess::GetNextLine(string &a_buff); */
+
+
+/*
+NAME
+ 
+    GetNextLine - Gets the next line from the file and its pre-scan
+
+SYNOPSIS
+ 
+    bool GetNextLine(string &a_buff, LineScan &a_scan);
+
+DESCRIPTION
+ 
+   This function gets the next line from the file and stores it
+   in "a_buff". The classification of the line made by the source
+   scanner when the file was opened is stored in "a_scan". As with
+   getline(), a file that ends with a newline has a final empty line.
+   Each line is counted in the metrics the first time it is read.
+ 
+   Returns false - If end of file is reached
+   Returns true - Otherwise
+*/
+
+bool FileAccess::GetNextLine(string &a_buff, LineScan &a_scan)
 {
     // If there is no more data
-    if (m_sfile.eof())
+    if (m_nextLine >= m_lines.size())
         return false;
     
-    getline(m_sfile, a_buff);
+    a_scan = m_lines[m_nextLine++];
+    a_buff.assign(m_data + a_scan.m_begin, a_scan.m_size);
+    
+    // the lines read again after Rewind() were already counted
+    if (m_nextLine > m_linesCounted)
+    {
+        m_linesCounted = m_nextLine;
+        
+        Metrics::Add(Metrics::CT_SourceLines, 1);
+        Metrics::Add(Metrics::CT_SourceBytes, a_buff.size() + 1);
+        Metrics::Observe(Metrics::HG_SourceLineBytes, a_buff.size());
+    }
     
     return true;
 }
-/*bool FileAccess::GetNextLine(string &a_buff); */
+/*bool FileAccess::GetNextLine(string &a_buff, LineScan &a_scan); */
 
 
 /*
@@ -72,15 +170,13 @@ SYNOPSIS
 
 DESCRIPTION
  
-   This function cleans all file flags and
-   goes back to the beginning of the file.
+   This function goes back to the first line of the file.
    
 */
 
 void FileAccess::Rewind()
 {
-    m_sfile.clear();
-    m_sfile.seekg(0, ios::beg);
+    m_nextLine = 0;
 }
 /*void FileAccess::rewind(); */
     
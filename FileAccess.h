@@ -12,18 +12,37 @@ public:
     // Opens the file.
     FileAccess(int argc, char *argv[]);
 
+    // Reads a copy of a source held in memory.
+    FileAccess(const char *a_data, const size_t& a_size);
+
     // Closes the file.
     ~FileAccess();
 
     // Get the next line from the source file.
     bool GetNextLine(string &);
 
+    // Get the next line from the source file and its pre-scan.
+    bool GetNextLine(string &, LineScan &);
+
     // Put the file pointer back to the beginning of the file
     void Rewind();
 
+    // The contents of the source file.
+    const char *GetData() const {return m_data;}
+    size_t GetSize() const {return m_size;}
+
 private:
 
-    ifstream m_sfile;        // Source file object.
+    FileAccess(const FileAccess&) = delete;
+    FileAccess& operator=(const FileAccess&) = delete;
+
+    const char *m_data;         // Contents of the source file.
+    size_t m_size;              // Size of the source file.
+    void *m_mapping;            // The mapping of the file, nullptr if it was read instead.
+    string m_contents;          // Contents of a file that could not be mapped.
+    vector<LineScan> m_lines;   // Pre-scan of every line of the file.
+    size_t m_nextLine;          // Index of the next line to be read.
+    size_t m_linesCounted;      // Number of lines counted in the metrics.
 };
 
 #endif
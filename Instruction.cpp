@@ -19,7 +19,7 @@ DESCRIPTION
    this function calls the appropriate function to identify the type of
    instruction and record all the components of the stataement.
    
-   Returns - ST_MachineLanguage, ST_AssemblerInstr, ST_Comment or ST_End
+   Returns - ST_MachineLanguage, ST_AssemblerInstr, ST_Linkage, ST_Comment or ST_End
 */
 
 Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff)
@@ -27,6 +27,9 @@ Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff)
     //setting default register in case it is not specified
     m_Register = "9";
     
+    //the operand is not indexed unless it has the form SYMBOL(REGISTER)
+    m_NumIndex = -1;
+    
     //resetting label for next line of instruction
     m_Label = "";
     
@@ -46,12 +49,8 @@ Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff)
         instCopy.resize(index);
     }
         
-    //if there is a comma error
-    if (!CommaChecker(instCopy))
-    {
-         //Code 24: Comma Can Only Be Used To Separate Register From Operand
-         Errors::RecordError(24, m_instruction);
-    }
+    //the comma rules are checked once the opcode is known
+    string commaLine = instCopy;
         
     //first word is considered a speical case
     string firstWord;
@@ -81,38 +80,139 @@ Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff)
     
     //because we need to read the first word again
     stringstream line2(instCopy);
-       
-    //instructions at most can have 4 words 
-    const int MAXSIZE = 4;
     
     //will hold the original form of the words in the instruction
-    string originalForm[MAXSIZE];
+    string originalForm[MAXWORDS];
     
-    for (int i = 0; i < MAXSIZE; i++)
+    for (int i = 0; i < MAXWORDS; i++)
         line2>>originalForm[i];
-       
+    
+    //if there is a comma error (the opcode follows the label of a 4-word statement)
+    if (!CommaChecker(commaLine, originalForm[instrWords == 4 ? 1 : 0]))
+    {
+         //Code 24: Comma Can Only Be Used To Separate Register From Operand
+         Errors::RecordError(24, m_instruction);
+    }
+    
+    //without commas the words are the same as those of the original statement
+    return WordsProcessor(instrWords, originalForm, index == string::npos);
+}
+/*Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff); */
+
+
+/*
+NAME
+ 
+    ParseInstruction - Identifies and parses each word in the instruction using its pre-scan
+
+SYNOPSIS
+ 
+    InstructionType ParseInstruction(const string& a_buff, const LineScan& a_scan);
+
+DESCRIPTION
+ 
+   This function does the same as ParseInstruction(a_buff) but takes the
+   position of the comment, the number of commas, the number of words and
+   the offsets of the words from "a_scan", the classification of the line
+   made by the source scanner, instead of scanning "a_buff" again.
+   
+   Returns - ST_MachineLanguage, ST_AssemblerInstr, ST_Linkage, ST_Comment or ST_End
+*/
+
+Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff, const LineScan& a_scan)
+{
+    //setting default register in case it is not specified
+    m_Register = "9";
+    
+    //the operand is not indexed unless it has the form SYMBOL(REGISTER)
+    m_NumIndex = -1;
+    
+    //resetting label for next line of instruction
+    m_Label = "";
+    
+    //recording original instruction before any modification
+    m_instruction = a_buff;
+    
+    //if it's an empty line bc text after ";" are removed or simply an empty line
+    if (a_scan.m_blank)
+    {
+        m_type = ST_Comment;
+        return ST_Comment;
+    }
+    
+    //will hold the original form of the words in the instruction
+    string originalForm[MAXWORDS];
+    
+    for (int i = 0; i < a_scan.m_tokens; i++)
+        originalForm[i].assign(a_buff, a_scan.m_tokBegin[i], a_scan.m_tokSize[i]);
+    
+    //the comma rules only need checking when there is exactly one comma
+    //(the opcode follows the label of a 4-word statement)
+    const string& opcode = originalForm[a_scan.m_words == 4 ? 1 : 0];
+    
+    if (a_scan.m_commas > 1 || (a_scan.m_commas == 1 && !CommaChecker(a_buff.substr(0, a_scan.m_cut), opcode)))
+    {
+        //Code 24: Comma Can Only Be Used To Separate Register From Operand
+        Errors::RecordError(24, m_instruction);
+    }
+    
+    return WordsProcessor(a_scan.m_words, originalForm, a_scan.m_commas == 0);
+}
+/*Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff,
+  const LineScan& a_scan); */
+
+
+/*
+NAME
+ 
+    WordsProcessor - Capitalizes the words and calls the processor for their number
+
+SYNOPSIS
+ 
+    InstructionType WordsProcessor(const int& a_instrWords, const string a_original[],
+                                   const bool& a_noCommas);
+
+DESCRIPTION
+ 
+   This function records the capitalized form of the words in "a_original[]"
+   and calls the processor for "a_instrWords" words. If "a_noCommas" is true,
+   the words are the same as those of the original statement and are kept for
+   LocationNextInstruction() and the assembler.
+   
+   Returns - ST_MachineLanguage, ST_AssemblerInstr, ST_Linkage, ST_Comment or ST_End
+*/
+
+Instruction::InstructionType Instruction::WordsProcessor(const int& a_instrWords, const string a_original[],
+                                                         const bool& a_noCommas)
+{
     //will hold the capitalized form of the words in the instruction
-    string capitalForm[MAXSIZE];
-       
-    for (int i = 0; i < MAXSIZE; i++)
-        for (size_t j = 0; j < originalForm[i].size(); j++)
-            capitalForm[i] += toupper(originalForm[i][j]);
+    for (int i = 0; i < MAXWORDS; i++)
+    {
+        m_CapitalWords[i] = a_original[i];
+        
+        //the program runs in the "C" locale, where only a-z have capital forms
+        for (char& ch : m_CapitalWords[i])
+            if (ch >= 'a' && ch <= 'z')
+                ch -= 'a' - 'A';
+    }
+    
+    m_WordsCached = a_noCommas;
     
     //if there are 4 words in the instruction
-    if (instrWords == 4)
-        return FourInstrProcessor(capitalForm, originalForm);
+    if (a_instrWords == 4)
+        return FourInstrProcessor(m_CapitalWords, a_original);
     
     //if there are 3 words in the instruction
-    if (instrWords == 3)
-        return ThreeInstrProcessor(capitalForm, originalForm);
+    if (a_instrWords == 3)
+        return ThreeInstrProcessor(m_CapitalWords, a_original);
     
     //if there are 2 words in the instruction
-    if (instrWords == 2)
-        return TwoInstrProcessor(capitalForm, originalForm[1]);
+    if (a_instrWords == 2)
+        return TwoInstrProcessor(m_CapitalWords, a_original[1]);
     
     //if there is one word in the instruction
-    if (instrWords == 1)
-        return SingleInstrProcessor(capitalForm[0]);
+    if (a_instrWords == 1)
+        return SingleInstrProcessor(m_CapitalWords[0]);
     
     //if there are more than 4 words in the instruction
     //Code 3: Extra Operands
@@ -120,7 +220,41 @@ Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff)
     
     return ST_Comment;
 }
-/*Instruction::InstructionType Instruction::ParseInstruction(const string& a_buff); */
+/*Instruction::InstructionType Instruction::WordsProcessor(const int& a_instrWords,
+  const string a_original[], const bool& a_noCommas); */
+
+
+/*
+NAME
+ 
+    GetLeadingWords - Gets the capitalized first two words of the statement
+
+SYNOPSIS
+ 
+    bool GetLeadingWords(string& a_first, string& a_second) const;
+
+DESCRIPTION
+ 
+   This function places the capitalized first and second words of the
+   last statement parsed in "a_first" and "a_second", as reading them
+   from the original statement with a stringstream would. This is only
+   possible for an assembler language statement without commas.
+ 
+   Returns true - if the words are known
+   Returns false - Otherwise (the caller must read the statement)
+*/
+
+bool Instruction::GetLeadingWords(string& a_first, string& a_second) const
+{
+    if (!m_WordsCached || m_type != ST_AssemblerInstr)
+        return false;
+    
+    a_first = m_CapitalWords[0];
+    a_second = m_CapitalWords[1];
+    
+    return true;
+}
+/*bool Instruction::GetLeadingWords(string& a_first, string& a_second) const; */
 
 
 /*
@@ -236,7 +370,7 @@ Instruction::InstructionType Instruction::ThreeInstrProcessor(const string a_cap
         SymbolValidation(a_original[0]);
         
         //check and record the operand of the 3-word assembler language statement
-        ThreeWordAssembly(a_capital[1], a_capital[2]);
+        ThreeWordAssembly(a_capital[1], a_original[2]);
         
         m_Label = a_original[0];
         m_type = ST_AssemblerInstr;
@@ -275,16 +409,18 @@ DESCRIPTION
    The supported 2-word instructions are:
  
    Case 1: OPCODE OPERAND  (Machine Language)
-   Case 2: HALT   REGISTER (Machine Language)
+   Case 2: HALT   REGISTER (Machine Language), and JOIN REGISTER
    Case 3: ORG    OPERAND  (Assembler Language)
+   Case 4: EXPORT SYMBOL   (Linkage)
+   Case 5: IMPORT SYMBOL   (Linkage)
    
    Returns ST_Comment or ST_End - If there is an error
-   Returns ST_MachineLanguage or ST_AssemblerInstr - Otherwise
+   Returns ST_MachineLanguage, ST_AssemblerInstr or ST_Linkage - Otherwise
 */
 
 Instruction::InstructionType Instruction::TwoInstrProcessor(const string a_capital[], const string& a_operand)
 {
-    //if first word is the opcode READ, WRITE, B or HALT (Case #1 and #2)
+    //if first word is the opcode READ, WRITE, B, HALT or JOIN (Case #1 and #2)
     if (TwoWordMachineLan(a_capital[0], a_operand))
     {
         //TwoWordMachineLan records opcode and operand/register of the 2-word machine language statement
@@ -312,6 +448,18 @@ Instruction::InstructionType Instruction::TwoInstrProcessor(const string a_capit
         }
     }
     
+    //the symbols shared with other object modules (Case #4 and #5)
+    if (a_capital[0] == "EXPORT" || a_capital[0] == "IMPORT")
+    {
+        //Check if symbol meets Quack3200 specifications
+        SymbolValidation(a_operand);
+        
+        m_OpCode = a_capital[0];
+        m_Operand = a_operand;
+        m_type = ST_Linkage;
+        return ST_Linkage;
+    }
+    
      //Just to give a hint if a label is included with END instruction
     if (a_capital[1] == "END")
     {
@@ -366,7 +514,7 @@ Instruction::InstructionType Instruction::SingleInstrProcessor(const string& a_s
     {
         //record elements of the instruction
         m_OpCode = a_single;
-        m_NumOpCode = stoi(m_OpcodeList[m_OpCode]);
+        m_NumOpCode = Numeric::Value(m_OpcodeList[m_OpCode]);
         m_type = ST_MachineLanguage;
         return ST_MachineLanguage;
     }
@@ -407,21 +555,47 @@ DESCRIPTION
  
    OPCODE REGISTER OPERAND
  
+   MOVE and FILL take two registers written as two digits (Ex: MOVE 12, BUFFER),
+   the register holding the number of words and the register holding the
+   location to copy from (MOVE) or the value to store (FILL). The register
+   of READV and WRITEV holds the number of words they read or write. SEND
+   and RECV name a port (0-4) instead of a register; the translation of
+   SEND holds its port plus Emulator::CHANNEL_PORTS.
 */
 
 void Instruction::ThreeWordMachineLan(const string& a_opcode, const string& a_reg, const string& a_operand)
 {
     m_OpCode = a_opcode;
-    m_NumOpCode = stoi(m_OpcodeList[m_OpCode]);
+    m_NumOpCode = Numeric::Value(m_OpcodeList[m_OpCode]);
+    
+    bool block = (m_NumOpCode == Emulator::MOVE || m_NumOpCode == Emulator::FILL);
+    bool channel = (m_NumOpCode == Emulator::CHANNEL);
+    m_NumSecondRegister = 0;
+    
+    //the register pair of MOVE and FILL is two digits long
+    if (block && IsInteger(a_reg) && (a_reg.size() == 2))
+    {
+        m_Register = a_reg.substr(0, 1);
+        m_NumRegister = Numeric::Value(m_Register);
+        m_NumSecondRegister = a_reg[1] - '0';
+    }
     
     //register must be numeric and one digit long
     //because min register = 0 and max register = 9
-    if (IsInteger(a_reg) && (a_reg.size() == 1))
+    else if (!block && IsInteger(a_reg) && (a_reg.size() == 1)
+             && (!channel || a_reg[0] - '0' < Emulator::CHANNEL_PORTS))
     {
         //the above conditions ensure register value is positive and in the range 0-9
         //because negative numbers take 2 characters since they are in string form
         m_Register = a_reg;
-        m_NumRegister = stoi(m_Register);
+        m_NumRegister = Numeric::Value(m_Register);
+        
+        //the ports of SEND follow those of RECV
+        if (channel && m_OpCode == "SEND")
+        {
+            m_NumRegister += Emulator::CHANNEL_PORTS;
+            m_Register = to_string(m_NumRegister);
+        }
     }
     
     else
@@ -430,9 +604,12 @@ void Instruction::ThreeWordMachineLan(const string& a_opcode, const string& a_re
         Errors::RecordError(21, m_instruction);
     }
     
+    //the operand may be indexed by a register
+    string operand = IndexChecker(a_operand);
+    
     //only symbolic operands are allowed with opcodes
-    if (!IsInteger(a_operand))
-        m_Operand = a_operand;
+    if (!IsInteger(operand))
+        m_Operand = operand;
         
     else
     {
@@ -462,8 +639,9 @@ DESCRIPTION
    (2) WRITE OPERAND
    (3) B     OPERAND
    (4) HALT  REGISTER
+   (5) JOIN  REGISTER
  
-   Returns true - If READ, WRITE, B or HALT is the opcode
+   Returns true - If READ, WRITE, B, HALT or JOIN is the opcode
    Returns false - Otherwise
 */
 
@@ -473,10 +651,13 @@ bool Instruction::TwoWordMachineLan(const string& a_opcode, const string& a_oper
     if (a_opcode == "READ" || a_opcode == "WRITE" || a_opcode == "B" )
     {
         m_OpCode = a_opcode;
-        m_NumOpCode = stoi(m_OpcodeList[m_OpCode]);
+        m_NumOpCode = Numeric::Value(m_OpcodeList[m_OpCode]);
+        
+        //the operand may be indexed by a register
+        string operand = IndexChecker(a_operand);
             
-        if (!IsInteger(a_operand))
-            m_Operand = a_operand;
+        if (!IsInteger(operand))
+            m_Operand = operand;
                 
         else
         {
@@ -487,11 +668,11 @@ bool Instruction::TwoWordMachineLan(const string& a_opcode, const string& a_oper
         return true;
     }
     
-    //operand for HALT is a register value 0-9 (Case 4)
-    if (a_opcode == "HALT")
+    //operand for HALT and JOIN is a register value 0-9 (Case 4-5)
+    if (a_opcode == "HALT" || a_opcode == "JOIN")
     {
         m_OpCode = a_opcode;
-        m_NumOpCode = stoi(m_OpcodeList[m_OpCode]);
+        m_NumOpCode = Numeric::Value(m_OpcodeList[m_OpCode]);
         
         //register must be numeric and one digit long because
         //min register = 0 and max register = 9
@@ -500,7 +681,7 @@ bool Instruction::TwoWordMachineLan(const string& a_opcode, const string& a_oper
             //above conditions will also ensure register value is positive and in the range 0-9
             //because negative numbers take 2 characters since they are in string form
             m_Register = a_operand;
-            m_NumRegister = stoi(m_Register);
+            m_NumRegister = Numeric::Value(m_Register);
         }
         
         else
@@ -518,6 +699,94 @@ bool Instruction::TwoWordMachineLan(const string& a_opcode, const string& a_oper
 /*bool Instruction::TwoWordMachineLan(const string& a_opcode, const string& a_operand); */
 
 
+/*
+NAME
+ 
+    IndexChecker - Records the index register of an operand
+
+SYNOPSIS
+ 
+    string IndexChecker(const string& a_operand);
+
+DESCRIPTION
+ 
+   This function checks if "a_operand" has the indexed form SYMBOL(REGISTER),
+   in which the address of the symbol is offset by the contents of the
+   register when the instruction is executed (Ex: LOAD 1, TABLE(2)).
+   The register is recorded as the index register. Only the opcodes
+   ADD, SUB, MULT, DIV, LOAD and STORE can have an indexed operand.
+ 
+   Returns - the operand without the index register
+*/
+
+string Instruction::IndexChecker(const string& a_operand)
+{
+    size_t open = a_operand.find('(');
+    
+    //the operand is not indexed
+    if (open == string::npos && a_operand.find(')') == string::npos)
+        return a_operand;
+    
+    string index;
+    
+    if (open != string::npos && a_operand.back() == ')')
+        index = a_operand.substr(open + 1, a_operand.size() - open - 2);
+    
+    //register must be numeric and one digit long
+    if (!IsInteger(index) || index.size() != 1)
+    {
+        //Code 32: Invalid Index Register Specified
+        Errors::RecordError(32, m_instruction);
+    }
+    
+    else if (m_NumOpCode < Emulator::ADD || m_NumOpCode > Emulator::STORE)
+    {
+        //Code 33: Only ADD, SUB, MULT, DIV, LOAD And STORE Can Be Indexed
+        Errors::RecordError(33, m_instruction);
+    }
+    
+    else
+        m_NumIndex = Numeric::Value(index);
+    
+    return a_operand.substr(0, open);
+}
+/*string Instruction::IndexChecker(const string& a_operand); */
+
+
+/*
+NAME
+ 
+    GetOpcode - Returns the numeric opcode of the instruction
+
+SYNOPSIS
+ 
+    string GetOpcode();
+
+DESCRIPTION
+ 
+   This function returns the two digits of the opcode of the last
+   machine language statement parsed. An instruction with an indexed
+   operand has the opcode INDEXED + 10 * (opcode - ADD) + index register,
+   and MOVE and FILL have their second register added to their opcode
+   (see Emulator::OpcodeType).
+ 
+   Returns - the opcode
+*/
+
+string Instruction::GetOpcode()
+{
+    //the second register of MOVE and FILL is part of their opcode
+    if (m_NumOpCode == Emulator::MOVE || m_NumOpCode == Emulator::FILL)
+        return to_string(m_NumOpCode + m_NumSecondRegister);
+    
+    if (m_NumIndex >= 0)
+        return to_string(Emulator::INDEXED + 10 * (m_NumOpCode - Emulator::ADD) + m_NumIndex);
+    
+    return m_OpcodeList[m_OpCode];
+}
+/*string Instruction::GetOpcode(); */
+
+
 /*
 NAME
  
@@ -536,6 +805,8 @@ DESCRIPTION
    (1) SYMBOL DC  OPERAND
    (2) SYMBOL DS  OPERAND
    (3) LABEL  ORG OPERAND
+ 
+   The operand of DC may be a symbol, whose location becomes the constant.
 */
 
 void Instruction::ThreeWordAssembly(const string& a_assemLan, const string& a_operand)
@@ -556,15 +827,17 @@ void Instruction::ThreeWordAssembly(const string& a_assemLan, const string& a_op
             m_IsNumericOperand = true;
             
             //since only positive operands are allowed
-            //and max = 99,999 (5 digits)
-            if (a_operand.size() < 6)
+            //and max = 99,999 (ADDRESS_DIGITS digits)
+            if (a_operand.size() <= (size_t)Quack3200::ADDRESS_DIGITS)
             {
-                //operand for DS must be positive
-                if (stoi(a_operand) > 0)
+                //operand for DS must be positive (a missing word counts as zero)
+                int possibleOperand = Numeric::Value(a_operand);
+                
+                if (possibleOperand > 0)
                 {
                     valid_DS_Operand = true;
                     m_Operand = a_operand;
-                    m_OperandValue = stoi(m_Operand);
+                    m_OperandValue = possibleOperand;
                 }
                 
                 else
@@ -589,6 +862,14 @@ void Instruction::ThreeWordAssembly(const string& a_assemLan, const string& a_op
         }
     }
         
+    //the location of the symbol is the constant (Ex: PTR DC TABLE)
+    else if (a_assemLan == "DC" && IsSymbol(a_operand))
+    {
+        m_Operand = a_operand;
+        m_OperandValue = 0;
+        m_IsNumericOperand = false;
+    }
+    
     else
     {
         //Code 2: Operand Must Be Numeric
@@ -631,19 +912,20 @@ void Instruction::OriginInstr(const string& a_operand)
     //setting the default for origin in case it is specified incorrectly
     m_Operand = "100";
     
-    m_OperandValue = stoi(m_Operand);
+    m_OperandValue = 100;
     m_IsNumericOperand = true;
     
-    //bc last location to translate is loc = 99,999 (5 digits)
-    if (a_operand.size() < 6)
+    //bc last location to translate is loc = 99,999 (ADDRESS_DIGITS digits)
+    if (a_operand.size() <= (size_t)Quack3200::ADDRESS_DIGITS)
     {
-        int possibleOperand = stoi(a_operand);
+        //a missing word (Ex: a tab counted as a word) counts as zero
+        int possibleOperand = Numeric::Value(a_operand);
         
         //operand for ORG must be positive
         if (possibleOperand > 0)
         {
             m_Operand = a_operand;
-            m_OperandValue = stoi(m_Operand);
+            m_OperandValue = possibleOperand;
         }
                
         else
@@ -680,30 +962,34 @@ DESCRIPTION
 
 void Instruction::DC_Instr(const string& a_operand)
 {
-    // max value = 99,999,999 (8 characters)
-    size_t maxChar = 8;
+    // max value = 99,999,999 (WORD_DIGITS characters)
+    size_t maxChar = Quack3200::WORD_DIGITS;
     
     //if the operand is negative
     if (a_operand[0] == '-')
     {
-        //min value = -99,999,999 (9 characters)
-        maxChar = 9;
+        //min value = -99,999,999 (WORD_DIGITS + 1 characters)
+        maxChar = Quack3200::WORD_DIGITS + 1;
     }
     
-    if (a_operand.size() <= maxChar)
+    //a missing word (Ex: a tab counted as a word) is the constant zero
+    if (a_operand.empty())
+        m_Operand = "0";
+    
+    else if (a_operand.size() <= maxChar)
         m_Operand = a_operand;
         
     else
     {
         //Record 0s as operand value if it is too big
-        m_Operand = "00000000";
+        m_Operand = string(Quack3200::WORD_DIGITS, '0');
         
         //Code 19: Constant Too Large For Quack3200
         Errors::RecordError(19, m_instruction);
     }
     
     //record elements of instruction
-    m_OperandValue = stoi(m_Operand);
+    m_OperandValue = Numeric::Value(m_Operand);
     m_IsNumericOperand = true;
 }
 /*void Instruction::DC_Instr(const string& a_operand); */
@@ -738,30 +1024,37 @@ int Instruction::LocationNextInstruction(const int& a_loc) const
     {
         //determine if it's DS or ORG
         string assemLanType;
-        stringstream line(m_instruction);
-        
-        //the first word in the instruction
-        line>>assemLanType;
-        
-        //change to capital form of this word
-        for (size_t i = 0; i < assemLanType.size(); i++)
-            assemLanType[i] = toupper(assemLanType[i]);
         
         //saving first instruction in case we have a 2-word ORG instruction (Ex: ORG 100)
-        string possibleOrg = assemLanType;
-        
-        //DS and DC are 3-word instructions and ORG could have a label (Ex: Duck ORG 100)
-        //the second word in the instruction
-        line>>assemLanType;
+        string possibleOrg;
         
-        //change to capital form of this word
-        for (size_t i = 0; i < assemLanType.size(); i++)
-            assemLanType[i] = toupper(assemLanType[i]);
+        //the parser usually knows the words already
+        if (!GetLeadingWords(possibleOrg, assemLanType))
+        {
+            stringstream line(m_instruction);
+            
+            //the first word in the instruction
+            line>>assemLanType;
+            
+            //change to capital form of this word
+            for (size_t i = 0; i < assemLanType.size(); i++)
+                assemLanType[i] = toupper(assemLanType[i]);
+            
+            possibleOrg = assemLanType;
+            
+            //DS and DC are 3-word instructions and ORG could have a label (Ex: Duck ORG 100)
+            //the second word in the instruction
+            line>>assemLanType;
+            
+            //change to capital form of this word
+            for (size_t i = 0; i < assemLanType.size(); i++)
+                assemLanType[i] = toupper(assemLanType[i]);
+        }
     
         if (assemLanType == "DS")
         {
             //because last location of Quack3200 Memory = 99,999
-            if (a_loc + m_OperandValue < 100'000)
+            if (a_loc + m_OperandValue < Quack3200::MEMSZ)
                 return a_loc + m_OperandValue;
             
             else
@@ -786,12 +1079,12 @@ int Instruction::LocationNextInstruction(const int& a_loc) const
         //other necessary checks on the operand of ORG are already performed in OriginInstr function
     }
     
-    //COMMENT and END have no effect on location
-    else if (m_type == ST_Comment || m_type == ST_End)
+    //COMMENT, END, EXPORT and IMPORT have no effect on location
+    else if (m_type == ST_Comment || m_type == ST_End || m_type == ST_Linkage)
         return a_loc;
     
     //if final memeory location of Qucack3200 is exceeded (last location = 99,999)
-    if (a_loc + 1 > 99'999)
+    if (a_loc + 1 > Quack3200::MEMSZ - 1)
     {
         //Code 20: Insufficient Memory for Translation
         Errors::RecordError(20, m_instruction);
@@ -850,15 +1143,15 @@ int Instruction::WordsToReadFinder(const string& a_buff) const
 /*
 NAME
  
-    SymbolValidation - Checks if symbol meets Quack3200 specifications
+    IsSymbol - Determines if a word meets Quack3200 symbol specifications
 
 SYNOPSIS
  
-    bool SymbolValidation(const string& a_symbol) const;
+    bool IsSymbol(const string& a_symbol) const;
 
 DESCRIPTION
  
-   This function checks if:
+   This function checks, without recording an error, if:
    (1) "a_symbol" is 1-10 characters long
    (2) The first character of "a_symbol" is a letter and remaining are letters and digits
  
@@ -866,32 +1159,51 @@ DESCRIPTION
    Returns false - Otherwise
 */
 
-bool Instruction::SymbolValidation(const string& a_symbol) const
+bool Instruction::IsSymbol(const string& a_symbol) const
 {
     //if first character is not alphabetical or there is more than 10 characters
     if ((!isalpha(a_symbol[0])) || (a_symbol.size() > 10))
-    {
-        //Code 8: Symbol Does Not Meet Quack3200 Symbol Specification
-        Errors::RecordError(8, m_instruction);
-        
         return false;
-    }
         
     //start at index 1 because index 0 was already checked
     for (size_t i = 1; i < a_symbol.size(); i++)
     {
         //if any character is not a letter, then it must be a number
-        if ((!isalpha(a_symbol[i])))
-        {
-            //if it is not a number either
-            if ((!isdigit(a_symbol[i])))
-            {
-                //Code 8: Symbol Does Not Meet Quack3200 Symbol Specification
-                Errors::RecordError(8, m_instruction);
-                
-                return false;
-            }
-        }
+        if ((!isalpha(a_symbol[i])) && (!isdigit(a_symbol[i])))
+            return false;
+    }
+    
+    return true;
+}
+/*bool Instruction::IsSymbol(const string& a_symbol) const; */
+
+
+/*
+NAME
+ 
+    SymbolValidation - Checks if symbol meets Quack3200 specifications
+
+SYNOPSIS
+ 
+    bool SymbolValidation(const string& a_symbol) const;
+
+DESCRIPTION
+ 
+   This function checks the conditions of IsSymbol() on "a_symbol"
+   and records an error if they are not met.
+ 
+   Returns true - if conditions are met
+   Returns false - Otherwise
+*/
+
+bool Instruction::SymbolValidation(const string& a_symbol) const
+{
+    if (!IsSymbol(a_symbol))
+    {
+        //Code 8: Symbol Does Not Meet Quack3200 Symbol Specification
+        Errors::RecordError(8, m_instruction);
+        
+        return false;
     }
     
     return true;
@@ -906,18 +1218,20 @@ NAME
 
 SYNOPSIS
  
-    bool CommaChecker(const string& a_line) const;
+    bool CommaChecker(const string& a_line, const string& a_opcode) const;
 
 DESCRIPTION
  
    This function checks to see whether comma in "a_line"
    is only used to separate register value from operand.
+   The register of the opcode "a_opcode" (in any case) is a
+   pair of digits for MOVE and FILL.
  
    Returns true - if condition is met or there is no comma
    Returns false - Otherwise
 */
 
-bool Instruction::CommaChecker(const string& a_line) const
+bool Instruction::CommaChecker(const string& a_line, const string& a_opcode) const
 {
     // total number of commas in the instruction
     int commaCount = 0;
@@ -936,13 +1250,29 @@ bool Instruction::CommaChecker(const string& a_line) const
     // at this point we have only one comma, so perform the special check
     bool firstEmptyChar = false;
     
+    // too short to hold an empty char, a digit and a comma (the loop bounds would wrap around)
+    if (a_line.size() < 3)
+        return false;
+    
+    // the register pair of MOVE and FILL has two digits
+    size_t digits = 1;
+    if (a_opcode.size() == 4)
+    {
+        string opcode = a_opcode;
+        for (char& ch : opcode)
+            ch = toupper(ch);
+        
+        if (opcode == "MOVE" || opcode == "FILL")
+            digits = 2;
+    }
+    
     // to meet comma condition: An empty char must be followed
-    // by a single digit whose next non-empty char is a comma
+    // by a single digit (or the register pair) whose next non-empty char is a comma
     for (size_t i = 0; i < a_line.size() - 3; i++)
     {
         if (a_line[i] == ' ')
             if (isdigit(a_line[i+1]))
-                for (size_t j = i + 2; j < a_line.size() - 1; j++)
+                for (size_t j = (digits == 2 && isdigit(a_line[i+2])) ? i + 3 : i + 2; j < a_line.size() - 1; j++)
                 {
                     if (a_line[j] != ' ')
                     {
@@ -957,7 +1287,7 @@ bool Instruction::CommaChecker(const string& a_line) const
                             
     return false;
 }
-/*bool Instruction::CommaChecker(const string& a_line) const; */
+/*bool Instruction::CommaChecker(const string& a_line, const string& a_opcode) const; */
 
 
 /*
@@ -981,34 +1311,18 @@ DESCRIPTION
 
 bool Instruction::IsInteger(const string& a_str) const
 {
-    //if number is positive, all characters must be numeric starting at index 0
-    int startIndex = 0;
-    
-    //if number is negative, all characters must be numeric starting at index 1
-    if (a_str[0] == '-')
-    {
-        //to protect against this: x dc - (i.e. a negative sign by itself)
-        if (a_str.size() == 1)
-            return false;
-        
-        //to protect against this: x dc -0
-        if (a_str[1] == '0')
-        {
-            //Code 30: Negative Sign Cannot Be Followed By 0
-            Errors::RecordError(30, m_instruction);
-        }
-        
-        startIndex = 1;
-    }
+    //a missing word (Ex: a tab counted as a word) counts as zero
+    if (a_str.empty())
+        return true;
     
-    //check all characters
-    for (int i = startIndex; i < (int)a_str.size(); i++)
+    //to protect against this: x dc -0
+    if (a_str.size() > 1 && a_str[0] == '-' && a_str[1] == '0')
     {
-        //if there is a non-numeric character
-        if (!(isdigit(a_str[i])))
-            return false;
+        //Code 30: Negative Sign Cannot Be Followed By 0
+        Errors::RecordError(30, m_instruction);
     }
     
-    return true;
+    //all characters after the sign must be numeric (x dc - is not an integer)
+    return Numeric::IsInteger(a_str);
 }
 /*bool Instruction::IsInteger(const string& a_str) const; */
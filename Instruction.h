@@ -12,7 +12,8 @@ class Instruction
 public:
     
     Instruction(): m_Label(""), m_Register(""), m_OpCode(""), m_Operand(""),
-    m_instruction(""), m_NumRegister(-1), m_IsNumericOperand(false)
+    m_instruction(""), m_NumRegister(-1), m_NumSecondRegister(0), m_NumIndex(-1), m_IsNumericOperand(false),
+    m_WordsCached(false)
     {
         // inserting all opcodes supported by Quack3200
         m_OpcodeList.insert(pair<string, string>("ADD", "01"));
@@ -28,6 +29,15 @@ public:
         m_OpcodeList.insert(pair<string, string>("BZ", "11"));
         m_OpcodeList.insert(pair<string, string>("BP", "12"));
         m_OpcodeList.insert(pair<string, string>("HALT", "13"));
+        m_OpcodeList.insert(pair<string, string>("READV", "14"));
+        m_OpcodeList.insert(pair<string, string>("WRITEV", "15"));
+        m_OpcodeList.insert(pair<string, string>("FORK", "16"));
+        m_OpcodeList.insert(pair<string, string>("JOIN", "17"));
+        m_OpcodeList.insert(pair<string, string>("FADD", "18"));
+        m_OpcodeList.insert(pair<string, string>("SEND", "19"));
+        m_OpcodeList.insert(pair<string, string>("RECV", "19"));
+        m_OpcodeList.insert(pair<string, string>("MOVE", "20"));
+        m_OpcodeList.insert(pair<string, string>("FILL", "30"));
     }
     
     //the type of instruction being processed
@@ -36,7 +46,8 @@ public:
         ST_MachineLanguage,              // A machine language instruction. 0
         ST_AssemblerInstr,               // Assembler Language instruction. 1
         ST_Comment,                      // Comment or blank line           2
-        ST_End                           // end instruction.                3
+        ST_End,                          // end instruction.                3
+        ST_Linkage                       // EXPORT or IMPORT statement      4
     };
 
     inline string &GetLabel()
@@ -50,10 +61,8 @@ public:
         return ! m_Label.empty();
     };
     
-    inline string &GetOpcode()
-    {
-        return m_OpcodeList[m_OpCode];
-    }
+    // Returns the numeric opcode, in its indexed form if the operand is indexed
+    string GetOpcode();
     
     inline string GetRegister() const
     {
@@ -70,12 +79,34 @@ public:
         return m_OperandValue;
     }
     
+    // To determine if a linkage statement is EXPORT (otherwise it is IMPORT)
+    inline bool IsExport() const
+    {
+        return m_OpCode == "EXPORT";
+    }
+    
+    // To determine if the operand of an assembler language statement is numeric
+    inline bool IsNumericOperand() const
+    {
+        return m_IsNumericOperand;
+    }
+    
+ 
     // Identifies and parses each word in the instruction
     InstructionType ParseInstruction(const string&);
     
+    // Identifies and parses each word in the instruction using its pre-scan
+    InstructionType ParseInstruction(const string&, const LineScan&);
+    
+    // Gets the capitalized first two words of the statement if they are known
+    bool GetLeadingWords(string&, string&) const;
+    
     
     /*                       The Processors                           */
     
+    // Capitalizes the words and calls the processor for their number
+    InstructionType WordsProcessor(const int&, const string [], const bool&);
+    
     // Identifies and records different elements of a instruction with 4 words
     InstructionType FourInstrProcessor(const string [], const string []);
     
@@ -99,6 +130,9 @@ public:
     // Records opcode and operand of a 2-word machine language statement
     bool TwoWordMachineLan(const string&, const string&);
     
+    // Records the index register of an operand and returns the operand without it
+    string IndexChecker(const string&);
+    
     /*                                                                 */
     
     
@@ -121,11 +155,14 @@ public:
     // Finds the number of words in the instruction
     int WordsToReadFinder(const string&) const;
     
+    // Determines if a word meets Quack3200 symbol specifications, recording no error
+    bool IsSymbol(const string&) const;
+    
     // Checks if symbol meets Quack3200 specifications
     bool SymbolValidation(const string&) const;
     
     // Checks Quack3200 comma rules
-    bool CommaChecker(const string&) const;
+    bool CommaChecker(const string&, const string&) const;
     
     // Determines if all characters of a string are numeric
     bool IsInteger(const string&) const;
@@ -133,6 +170,9 @@ public:
     
 private:
     
+    // The most words read from an instruction
+    const static int MAXWORDS = 4;
+    
     map<string, string> m_OpcodeList;   // The list of all Quack3200 opcodes
 
     string m_instruction;               // The original instruction
@@ -146,8 +186,13 @@ private:
     // Derived values.
     int m_NumOpCode;                 // The numerical value of the opcode
     int m_NumRegister;               // the numeric value for the register
+    int m_NumSecondRegister;         // The second register of MOVE and FILL
+    int m_NumIndex;                  // The index register of the operand, -1 if it is not indexed
     InstructionType m_type;          // The type of instruction
     
     bool m_IsNumericOperand;         // == true if the operand is numeric
     int m_OperandValue;              // The value of the operand if it is numeric
+    
+    string m_CapitalWords[MAXWORDS]; // The capitalized words of the instruction
+    bool m_WordsCached;              // == true if they match the words of the original statement
 };
@@ -0,0 +1,640 @@
+//
+//  Implementation of the lane emulator class.
+//
+//  Every step executes the instruction at the lowest location reached by
+//  a running lane, for all the lanes at that location that hold the same
+//  word there. Lanes that took the other side of a branch wait until the
+//  lanes behind them reach their location, so the lanes of a loop whose
+//  iterations differ between lanes run apart only while they differ. A
+//  lane that changed its own code at a location runs that location apart
+//  from the other lanes.
+//
+
+#include "stdafx.h"
+#include "LaneEmulator.h"
+#include <cstdint>
+
+// QUACK_LANES_SCALAR forces the portable lanes
+#if defined(__AVX2__) && !defined(QUACK_LANES_SCALAR)
+#include <immintrin.h>
+#define QUACK_LANES_AVX2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+
+typedef LaneEmulator::LaneWord LaneWord;
+
+// The limits of a register, as checked by Emulator::ResultChecker
+const int MAXVAL = Quack3200::MAXVAL;
+const int MINVAL = Quack3200::MINVAL;
+
+// Index of the lowest set bit of a non-zero mask
+inline unsigned LowestBit(const unsigned& a_bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, a_bits);
+    return index;
+#else
+    return __builtin_ctz(a_bits);
+#endif
+}
+
+// Calls "a_do" with each lane of a mask
+template <typename Function>
+inline void ForEachLane(unsigned a_mask, const Function& a_do)
+{
+    while (a_mask != 0)
+    {
+        a_do((int)LowestBit(a_mask));
+        a_mask &= a_mask - 1;
+    }
+}
+
+#ifdef QUACK_LANES_AVX2
+
+inline __m256i Get(const LaneWord& a_word)
+{
+    return _mm256_load_si256((const __m256i *)a_word.m_lane);
+}
+
+inline void Put(LaneWord& a_word, const __m256i& a_value)
+{
+    _mm256_store_si256((__m256i *)a_word.m_lane, a_value);
+}
+
+// The lanes of a bit mask as a vector mask
+inline __m256i Expand(const unsigned& a_mask)
+{
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(a_mask), bits), bits);
+}
+
+// The lanes of a vector mask as a bit mask
+inline unsigned Compress(const __m256i& a_mask)
+{
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(a_mask));
+}
+
+#endif
+
+// The lanes of "a_word" equal to "a_value"
+inline unsigned EqualLanes(const LaneWord& a_word, const int& a_value)
+{
+#ifdef QUACK_LANES_AVX2
+    return Compress(_mm256_cmpeq_epi32(Get(a_word), _mm256_set1_epi32(a_value)));
+#else
+    unsigned mask = 0;
+    for (int lane = 0; lane < LaneEmulator::LANES; lane++)
+        mask |= (unsigned)(a_word.m_lane[lane] == a_value) << lane;
+    return mask;
+#endif
+}
+
+// The lanes of a register that take a BM, BZ or BP branch
+inline unsigned BranchLanes(const LaneWord& a_reg, const int& a_opcode)
+{
+#ifdef QUACK_LANES_AVX2
+    __m256i reg = Get(a_reg);
+    __m256i zero = _mm256_setzero_si256();
+
+    if (a_opcode == Emulator::BM)
+        return Compress(_mm256_cmpgt_epi32(zero, reg));
+
+    if (a_opcode == Emulator::BZ)
+        return Compress(_mm256_cmpeq_epi32(reg, zero));
+
+    return Compress(_mm256_cmpgt_epi32(reg, zero));
+#else
+    unsigned mask = 0;
+    for (int lane = 0; lane < LaneEmulator::LANES; lane++)
+    {
+        int value = a_reg.m_lane[lane];
+        bool taken = a_opcode == Emulator::BM ? value < 0 : a_opcode == Emulator::BZ ? value == 0 : value > 0;
+        mask |= (unsigned)taken << lane;
+    }
+    return mask;
+#endif
+}
+
+// Copies the lanes of "a_mask" of "a_from" to "a_to"
+inline void Copy(LaneWord& a_to, const LaneWord& a_from, const unsigned& a_mask)
+{
+#ifdef QUACK_LANES_AVX2
+    Put(a_to, _mm256_blendv_epi8(Get(a_to), Get(a_from), Expand(a_mask)));
+#else
+    ForEachLane(a_mask, [&](int a_lane) {a_to.m_lane[a_lane] = a_from.m_lane[a_lane];});
+#endif
+}
+
+// Sets the lanes of "a_mask" of "a_to" to "a_value"
+inline void Set(LaneWord& a_to, const int& a_value, const unsigned& a_mask)
+{
+#ifdef QUACK_LANES_AVX2
+    Put(a_to, _mm256_blendv_epi8(Get(a_to), _mm256_set1_epi32(a_value), Expand(a_mask)));
+#else
+    ForEachLane(a_mask, [&](int a_lane) {a_to.m_lane[a_lane] = a_value;});
+#endif
+}
+
+// Adds one to the lanes of "a_mask" of "a_to"
+inline void Increment(LaneWord& a_to, const unsigned& a_mask)
+{
+#ifdef QUACK_LANES_AVX2
+    // a vector mask lane is -1, so subtracting it adds one
+    Put(a_to, _mm256_sub_epi32(Get(a_to), Expand(a_mask)));
+#else
+    ForEachLane(a_mask, [&](int a_lane) {a_to.m_lane[a_lane]++;});
+#endif
+}
+
+// The lowest of the lanes of "a_mask" of "a_word"
+inline int LowestLane(const LaneWord& a_word, const unsigned& a_mask)
+{
+#ifdef QUACK_LANES_AVX2
+    __m256i value = _mm256_blendv_epi8(_mm256_set1_epi32(INT32_MAX), Get(a_word), Expand(a_mask));
+    value = _mm256_min_epi32(value, _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));
+    value = _mm256_min_epi32(value, _mm256_shuffle_epi32(value, _MM_SHUFFLE(2, 3, 0, 1)));
+    value = _mm256_min_epi32(value, _mm256_permute2x128_si256(value, value, 1));
+    return _mm256_cvtsi256_si32(value);
+#else
+    int lowest = INT32_MAX;
+    ForEachLane(a_mask, [&](int a_lane) {lowest = min(lowest, a_word.m_lane[a_lane]);});
+    return lowest;
+#endif
+}
+
+/*
+NAME
+
+    Arithmetic - Performs ADD, SUB or MULT for several lanes
+
+SYNOPSIS
+
+    unsigned Arithmetic(LaneWord& a_reg, const LaneWord& a_mem, const int& a_opcode,
+                        const unsigned& a_mask);
+
+DESCRIPTION
+
+    This function performs "a_opcode" on the register "a_reg" and the memory
+    word "a_mem" for the lanes of "a_mask", with the results and the checks
+    of Emulator::ResultChecker: the result wraps around at 32 bits and a
+    result beyond the range of a register leaves the register unchanged.
+
+    Returns the lanes whose result is beyond the range of a register
+*/
+
+inline unsigned Arithmetic(LaneWord& a_reg, const LaneWord& a_mem, const int& a_opcode,
+                           const unsigned& a_mask)
+{
+#ifdef QUACK_LANES_AVX2
+    __m256i reg = Get(a_reg);
+    __m256i mem = Get(a_mem);
+    __m256i result = a_opcode == Emulator::ADD ? _mm256_add_epi32(reg, mem)
+        : a_opcode == Emulator::SUB ? _mm256_sub_epi32(reg, mem) : _mm256_mullo_epi32(reg, mem);
+
+    __m256i mask = Expand(a_mask);
+    __m256i overflow = _mm256_and_si256(mask,
+        _mm256_or_si256(_mm256_cmpgt_epi32(result, _mm256_set1_epi32(MAXVAL)),
+                        _mm256_cmpgt_epi32(_mm256_set1_epi32(MINVAL), result)));
+
+    Put(a_reg, _mm256_blendv_epi8(reg, result, _mm256_andnot_si256(overflow, mask)));
+
+    return Compress(overflow);
+#else
+    unsigned overflow = 0;
+
+    ForEachLane(a_mask, [&](int a_lane)
+    {
+        unsigned reg = (unsigned)a_reg.m_lane[a_lane];
+        unsigned mem = (unsigned)a_mem.m_lane[a_lane];
+        int result = (int)(a_opcode == Emulator::ADD ? reg + mem : a_opcode == Emulator::SUB ? reg - mem : reg * mem);
+
+        if (result > MAXVAL || result < MINVAL)
+            overflow |= 1u << a_lane;
+        else
+            a_reg.m_lane[a_lane] = result;
+    });
+
+    return overflow;
+#endif
+}
+/*unsigned Arithmetic(LaneWord& a_reg, const LaneWord& a_mem, const int& a_opcode,
+  const unsigned& a_mask); */
+
+}
+
+
+/*
+NAME
+
+    LaneEmulator - Allocates the memory of every lane
+
+SYNOPSIS
+
+    LaneEmulator();
+
+DESCRIPTION
+
+    This constructor allocates and clears the memory and the registers
+    of LANES instances of the Quack3200.
+*/
+
+LaneEmulator::LaneEmulator(): m_memory(Emulator::MEMSZ), m_active(0), m_fullSteps(0)
+{
+    memset(m_reg, 0, sizeof(m_reg));
+    memset(&m_pc, 0, sizeof(m_pc));
+
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        m_instrCount[lane] = 0;
+        m_halted[lane] = false;
+        m_errorCode[lane] = -1;
+    }
+}
+
+
+/*
+NAME
+
+    LoadImage - Loads an image into the memory of every lane
+
+SYNOPSIS
+
+    void LoadImage(const int a_image[]);
+
+DESCRIPTION
+
+    This function copies the MEMSZ words of "a_image" into the memory of
+    every lane and clears the registers.
+*/
+
+void LaneEmulator::LoadImage(const int a_image[])
+{
+    for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+        for (int lane = 0; lane < LANES; lane++)
+            m_memory[loc].m_lane[lane] = a_image[loc];
+
+    memset(m_reg, 0, sizeof(m_reg));
+}
+/*void LaneEmulator::LoadImage(const int a_image[]); */
+
+
+/*
+NAME
+
+    RunProgram - Runs the program in several lanes
+
+SYNOPSIS
+
+    void RunProgram(EmulatorIO *const a_io[], const int& a_lanes);
+
+DESCRIPTION
+
+    This function runs the program in memory from location 100 in the
+    first "a_lanes" lanes (at most LANES), until every lane has executed
+    HALT or stopped at a run-time error. Lane i reads its input from and
+    writes its output to "a_io[i]" as Emulator::RunProgram would, except
+    that a lane is never suspended at a READ (a READ without input is a
+    run-time error). The run-time errors are kept by lane rather than
+    recorded in Errors.
+*/
+
+void LaneEmulator::RunProgram(EmulatorIO *const a_io[], const int& a_lanes)
+{
+    int lanes = min(max(a_lanes, 0), (int)LANES);
+    unsigned all = (1u << lanes) - 1;
+
+    m_active = all;
+    m_fullSteps = 0;
+
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        m_pc.m_lane[lane] = 100;
+        m_instrCount[lane] = 0;
+        m_halted[lane] = false;
+        m_errorCode[lane] = -1;
+        m_errorStatement[lane].clear();
+    }
+
+    for (int lane = 0; lane < lanes; lane++)
+        a_io[lane]->Begin();
+
+    while (m_active != 0)
+    {
+        // the lanes furthest behind go first, so that the others wait for them where the paths meet
+        int loc = LowestLane(m_pc, m_active);
+
+        // every lane still running ran past the end of memory
+        if (loc >= Emulator::MEMSZ)
+            break;
+
+        unsigned atLoc = EqualLanes(m_pc, loc) & m_active;
+
+        // a lane that changed its own code at this location runs it apart
+        int translation = m_memory[loc].m_lane[LowestBit(atLoc)];
+        unsigned mask = atLoc & EqualLanes(m_memory[loc], translation);
+
+        if (mask == all)
+            m_fullSteps++;
+        else
+            ForEachLane(mask, [&](int a_lane) {m_instrCount[a_lane]++;});
+
+        Step(translation, mask, a_io);
+    }
+}
+/*void LaneEmulator::RunProgram(EmulatorIO *const a_io[], const int& a_lanes); */
+
+
+/*
+NAME
+
+    Step - Executes one instruction for several lanes
+
+SYNOPSIS
+
+    void Step(const int& a_translation, const unsigned& a_mask, EmulatorIO *const a_io[]);
+
+DESCRIPTION
+
+    This function executes the instruction "a_translation" for the lanes of
+    "a_mask", all of which are at the same location, with the effect of one
+    iteration of Emulator::Execute in each of them.
+*/
+
+void LaneEmulator::Step(const int& a_translation, const unsigned& a_mask, EmulatorIO *const a_io[])
+{
+    int opcode = Quack3200::Opcode(a_translation);
+    int regNumber = Quack3200::Register(a_translation);
+    int address = Quack3200::Address(a_translation);
+
+    // each lane moves or fills its own block
+    if (opcode >= Emulator::MOVE && opcode < Emulator::INDEXED)
+    {
+        int second = opcode % 10;
+
+        ForEachLane(a_mask, [&](int a_lane)
+        {
+            int length = m_reg[regNumber].m_lane[a_lane];
+            int source = opcode < Emulator::FILL ? m_reg[second].m_lane[a_lane] : 0;
+
+            //Code 35: Block Exceeds Quack3200 Memory
+            if (length < 0 || length > Emulator::MEMSZ - address || source < 0 || source > Emulator::MEMSZ - length)
+            {
+                Fail(a_lane, 35, "REG# " + to_string(regNumber));
+                return;
+            }
+
+            // copy backwards when the block moves up over itself
+            bool backwards = opcode < Emulator::FILL && source < address;
+
+            for (int i = 0; i < length; i++)
+            {
+                int word = backwards ? length - 1 - i : i;
+
+                m_memory[address + word].m_lane[a_lane] = opcode < Emulator::FILL
+                    ? m_memory[source + word].m_lane[a_lane] : m_reg[second].m_lane[a_lane];
+            }
+        });
+
+        Increment(m_pc, a_mask);
+        return;
+    }
+
+    // each lane reads or writes its own block at once
+    if (opcode == Emulator::READV || opcode == Emulator::WRITEV)
+    {
+        ForEachLane(a_mask, [&](int a_lane)
+        {
+            int length = m_reg[regNumber].m_lane[a_lane];
+
+            //Code 35: Block Exceeds Quack3200 Memory
+            if (length < 0 || length > Emulator::MEMSZ - address)
+            {
+                Fail(a_lane, 35, "REG# " + to_string(regNumber));
+                return;
+            }
+
+            if (length == 0)
+                return;
+
+            vector<int> values(length);
+
+            if (opcode == Emulator::WRITEV)
+            {
+                for (int i = 0; i < length; i++)
+                    values[i] = m_memory[address + i].m_lane[a_lane];
+
+                a_io[a_lane]->WriteWords(values.data(), length);
+                return;
+            }
+
+            string input, word;
+            int parsed;
+
+            if (!a_io[a_lane]->ReadWords(input, length))
+                input.clear();
+
+            int errorCode = Emulator::InputWords(input, values.data(), length, parsed, word);
+
+            for (int i = 0; i < parsed; i++)
+                m_memory[address + i].m_lane[a_lane] = values[i];
+
+            //Code 31: No Input Available For READ Instruction
+            if (errorCode == 31)
+                Fail(a_lane, 31, "LOCATION# " + to_string(address + parsed));
+
+            else if (errorCode >= 0)
+                Fail(a_lane, errorCode, word);
+        });
+
+        Increment(m_pc, a_mask);
+        return;
+    }
+
+    // the lanes with the same index run the instruction at the same location
+    if (opcode >= Emulator::INDEXED)
+    {
+        int indexReg = opcode % 10;
+        int plain = Emulator::ADD + (opcode - Emulator::INDEXED) / 10;
+
+        // a LOAD into the index register must not regroup the lanes
+        LaneWord index = m_reg[indexReg];
+        unsigned pending = a_mask;
+
+        while (pending != 0)
+        {
+            int indexed = address + index.m_lane[LowestBit(pending)];
+            unsigned same = pending & EqualLanes(index, index.m_lane[LowestBit(pending)]);
+            pending &= ~same;
+
+            //Code 34: Indexed Address Outside Quack3200 Memory
+            if (indexed < 0 || indexed >= Emulator::MEMSZ)
+            {
+                ForEachLane(same, [&](int a_lane) {Fail(a_lane, 34, "REG# " + to_string(indexReg));});
+                Increment(m_pc, same);
+            }
+
+            else
+                Step(Quack3200::Translation(plain, regNumber, indexed), same, a_io);
+        }
+        return;
+    }
+
+    switch (opcode)
+    {
+        case Emulator::HALT:
+            ForEachLane(a_mask, [&](int a_lane)
+            {
+                a_io[a_lane]->Halt();
+                m_halted[a_lane] = true;
+            });
+
+            m_active &= ~a_mask;
+            return;
+
+        case Emulator::ADD:
+        case Emulator::SUB:
+        case Emulator::MULT:
+        {
+            unsigned overflow = Arithmetic(m_reg[regNumber], m_memory[address], opcode, a_mask);
+
+            //Code 25: ADD Instruction Causes Overflow In a Register
+            //Code 26: SUB Instruction Causes Overflow In a Register
+            //Code 27: MULT Instruction Causes Overflow In a Register
+            if (overflow != 0)
+            {
+                int errorCode = opcode == Emulator::ADD ? 25 : opcode == Emulator::SUB ? 26 : 27;
+                ForEachLane(overflow, [&](int a_lane) {Fail(a_lane, errorCode, "REG# " + to_string(regNumber));});
+            }
+            break;
+        }
+
+        case Emulator::DIV:
+            ForEachLane(a_mask, [&](int a_lane)
+            {
+                int divisor = m_memory[address].m_lane[a_lane];
+
+                if (divisor != 0)
+                    m_reg[regNumber].m_lane[a_lane] /= divisor;
+
+                //Code 29: Division By Zero Is Undefined
+                else
+                    Fail(a_lane, 29, "REG# " + to_string(regNumber));
+            });
+            break;
+
+        case Emulator::LOAD:
+            Copy(m_reg[regNumber], m_memory[address], a_mask);
+            break;
+
+        case Emulator::STORE:
+            Copy(m_memory[address], m_reg[regNumber], a_mask);
+            break;
+
+        case Emulator::READ:
+            ForEachLane(a_mask, [&](int a_lane)
+            {
+                string input;
+
+                //Code 31: No Input Available For READ Instruction
+                if (!a_io[a_lane]->Read(input))
+                {
+                    Fail(a_lane, 31, "LOCATION# " + to_string(address));
+                    return;
+                }
+
+                int value;
+                int errorCode = Emulator::InputError(input, value);
+
+                if (errorCode >= 0)
+                    Fail(a_lane, errorCode, input);
+                else
+                    m_memory[address].m_lane[a_lane] = value;
+            });
+            break;
+
+        case Emulator::WRITE:
+            ForEachLane(a_mask, [&](int a_lane) {a_io[a_lane]->Write(m_memory[address].m_lane[a_lane]);});
+            break;
+
+        case Emulator::B:
+            Set(m_pc, address, a_mask);
+            return;
+
+        case Emulator::BM:
+        case Emulator::BZ:
+        case Emulator::BP:
+        {
+            unsigned taken = a_mask & BranchLanes(m_reg[regNumber], opcode);
+
+            Set(m_pc, address, taken);
+            Increment(m_pc, a_mask & ~taken);
+            return;
+        }
+
+        // other words do nothing when executed
+        default:
+            break;
+    }
+
+    // the lanes stopped by an error are no longer running
+    Increment(m_pc, a_mask);
+}
+/*void LaneEmulator::Step(const int& a_translation, const unsigned& a_mask, EmulatorIO *const a_io[]); */
+
+
+/*
+NAME
+
+    Fail - Stops a lane at a run-time error
+
+SYNOPSIS
+
+    void Fail(const int& a_lane, const int& a_errorCode, const string& a_statement);
+
+DESCRIPTION
+
+    This function records the error "a_errorCode" of "a_statement" for
+    "a_lane" and stops the lane, as the emulator stops at the first
+    run-time error.
+*/
+
+void LaneEmulator::Fail(const int& a_lane, const int& a_errorCode, const string& a_statement)
+{
+    m_errorCode[a_lane] = a_errorCode;
+    m_errorStatement[a_lane] = a_statement;
+    m_active &= ~(1u << a_lane);
+}
+/*void LaneEmulator::Fail(const int& a_lane, const int& a_errorCode, const string& a_statement); */
+
+
+/*
+NAME
+
+    Implementation - Returns the instruction set used for the lanes
+
+SYNOPSIS
+
+    static const char *Implementation();
+
+DESCRIPTION
+
+    This function returns "avx2" if the lanes are run with AVX2 and
+    "scalar" if they are run with portable code.
+*/
+
+const char *LaneEmulator::Implementation()
+{
+#ifdef QUACK_LANES_AVX2
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+/*const char *LaneEmulator::Implementation(); */
@@ -0,0 +1,89 @@
+//
+//        Lane emulator - runs one Quack3200 image over several independent
+//        inputs at once. The instances (lanes) execute in lockstep with
+//        their registers and memory laid out lane by lane (structure of
+//        arrays), so that one AVX2 instruction performs a LOAD, STORE, ADD,
+//        SUB or MULT for every lane. Lanes that branch differently are
+//        masked off and rejoin the others where their paths meet. Each lane
+//        produces the output, the instruction count and the run-time error
+//        of a separate run of the emulator.
+//
+
+#ifndef _LANEEMULATOR_H
+#define _LANEEMULATOR_H
+
+#include "stdafx.h"
+
+class LaneEmulator
+{
+
+public:
+
+    // The number of lanes run together
+    const static int LANES = 8;
+
+    // One word of memory or one register, for every lane
+    struct alignas(32) LaneWord
+    {
+        int m_lane[LANES];
+    };
+
+    LaneEmulator();
+
+    // Loads an image into the memory of every lane and clears the registers
+    void LoadImage(const int[]);
+
+    // Runs the program in the first "a_lanes" lanes, each with its own input and output
+    void RunProgram(EmulatorIO *const[], const int&);
+
+    // Determines if a lane executed HALT
+    bool Halted(const int& a_lane) const
+    {
+        return m_halted[a_lane];
+    }
+
+    // Returns the number of instructions dispatched by a lane
+    long long GetInstructionCount(const int& a_lane) const
+    {
+        return m_fullSteps + m_instrCount[a_lane];
+    }
+
+    // Returns the code of the run-time error of a lane, -1 if there was none
+    int GetErrorCode(const int& a_lane) const
+    {
+        return m_errorCode[a_lane];
+    }
+
+    // Returns the register, location or input of the run-time error of a lane
+    const string& GetErrorStatement(const int& a_lane) const
+    {
+        return m_errorStatement[a_lane];
+    }
+
+    // The instruction set used for the lanes ("avx2" or "scalar")
+    static const char *Implementation();
+
+
+private:
+
+    LaneEmulator(const LaneEmulator&) = delete;
+    LaneEmulator& operator=(const LaneEmulator&) = delete;
+
+    // Executes one instruction for the lanes of "a_mask"
+    void Step(const int&, const unsigned&, EmulatorIO *const[]);
+
+    // Stops a lane at a run-time error
+    void Fail(const int&, const int&, const string&);
+
+    vector<LaneWord> m_memory;              // The memory of the Quack3200, for every lane
+    LaneWord m_reg[10];                     // The registers, for every lane
+    LaneWord m_pc;                          // The location of the next instruction of each lane
+    unsigned m_active;                      // The lanes still running, one bit each
+    long long m_fullSteps;                  // Instructions executed by every lane of the run
+    long long m_instrCount[LANES];          // Other instructions executed by each lane
+    bool m_halted[LANES];                   // == true if the lane executed HALT
+    int m_errorCode[LANES];                 // The run-time error of each lane, -1 if none
+    string m_errorStatement[LANES];         // Its register, location or input
+};
+
+#endif
@@ -0,0 +1,266 @@
+//
+//  Implementation of the linker class.
+//
+//  An object module is kept as text: a header line, the extent of the
+//  module, then counted lists of the words, the relocations, the imports
+//  and the exports, and a trailer.
+//
+
+#include "stdafx.h"
+
+namespace
+{
+
+// Marks the first line of every object module
+const char *const MAGIC = "QUACKOBJ";
+
+// The version of the form of object modules
+const int FORMAT = 1;
+
+}
+
+
+/*
+NAME
+
+    WriteModule - Writes an object module
+
+SYNOPSIS
+
+    static void WriteModule(const ObjectModule& a_module, ostream& a_out);
+
+DESCRIPTION
+
+    This function writes "a_module" to "a_out" in the form read by
+    ReadModule().
+*/
+
+void Linker::WriteModule(const ObjectModule& a_module, ostream& a_out)
+{
+    a_out<<MAGIC<<' '<<FORMAT<<'\n'
+         <<a_module.m_first<<' '<<a_module.m_end<<' '<<(a_module.m_halt ? 1 : 0)<<'\n';
+
+    a_out<<a_module.m_words.size()<<'\n';
+    for (auto& word : a_module.m_words)
+        a_out<<word.first<<' '<<word.second<<'\n';
+
+    a_out<<a_module.m_relocations.size()<<'\n';
+    for (const int& loc : a_module.m_relocations)
+        a_out<<loc<<'\n';
+
+    a_out<<a_module.m_imports.size()<<'\n';
+    for (auto& import : a_module.m_imports)
+        a_out<<import.first<<' '<<import.second<<'\n';
+
+    a_out<<a_module.m_exports.size()<<'\n';
+    for (auto& symbol : a_module.m_exports)
+        a_out<<symbol.first<<' '<<symbol.second<<'\n';
+
+    a_out<<"END\n";
+}
+/*void Linker::WriteModule(const ObjectModule& a_module, ostream& a_out); */
+
+
+/*
+NAME
+
+    ReadModule - Reads an object module
+
+SYNOPSIS
+
+    static bool ReadModule(istream& a_in, ObjectModule& a_module);
+
+DESCRIPTION
+
+    This function reads into "a_module" an object module written by
+    WriteModule(). Every location it holds must be in memory.
+
+    Returns true - if "a_in" holds a complete object module
+    Returns false - Otherwise ("a_module" is unchanged)
+*/
+
+bool Linker::ReadModule(istream& a_in, ObjectModule& a_module)
+{
+    string magic;
+    int format, halt;
+    ObjectModule module;
+
+    if (!(a_in>>magic>>format) || magic != MAGIC || format != FORMAT)
+        return false;
+
+    if (!(a_in>>module.m_first>>module.m_end>>halt) || module.m_first < 0
+        || module.m_end < module.m_first || module.m_end > Emulator::MEMSZ)
+        return false;
+
+    module.m_halt = halt != 0;
+
+    // every location of the module is between its first and its end
+    auto inModule = [&](const int& a_loc) {return a_loc >= module.m_first && a_loc < module.m_end;};
+
+    // each word, relocation and import is at a different location of the module
+    size_t count, locations = module.m_end - module.m_first;
+
+    if (!(a_in>>count) || count > locations)
+        return false;
+
+    module.m_words.resize(count);
+
+    for (auto& word : module.m_words)
+        if (!(a_in>>word.first>>word.second) || !inModule(word.first))
+            return false;
+
+    if (!(a_in>>count) || count > locations)
+        return false;
+
+    module.m_relocations.resize(count);
+
+    for (int& loc : module.m_relocations)
+        if (!(a_in>>loc) || !inModule(loc))
+            return false;
+
+    if (!(a_in>>count) || count > locations)
+        return false;
+
+    module.m_imports.resize(count);
+
+    for (auto& import : module.m_imports)
+        if (!(a_in>>import.first>>import.second) || !inModule(import.first))
+            return false;
+
+    if (!(a_in>>count))
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        string symbol;
+        int loc;
+
+        if (!(a_in>>symbol>>loc) || loc < 0 || loc > Emulator::MEMSZ)
+            return false;
+
+        module.m_exports[symbol] = loc;
+    }
+
+    string trailer;
+
+    if (!(a_in>>trailer) || trailer != "END")
+        return false;
+
+    a_module = move(module);
+
+    return true;
+}
+/*bool Linker::ReadModule(istream& a_in, ObjectModule& a_module); */
+
+
+/*
+NAME
+
+    Link - Places the modules and resolves their symbols into one image
+
+SYNOPSIS
+
+    static bool Link(const vector<ObjectModule>& a_modules, vector<int>& a_image,
+                     map<string, int>& a_exports);
+
+DESCRIPTION
+
+    This function places the first module of "a_modules" at its own
+    locations, so that a program starting at location 100 is run from
+    there, and each of the others after the one before it. The words of
+    each module are moved to its place, the locations of its own symbols
+    are moved with them and the locations of the symbols it imports are
+    those exported by the module defining them. The image that the
+    emulator can run is placed in "a_image" and the exported symbols
+    with their final locations in "a_exports". The errors are recorded.
+
+    Returns true - if the modules were linked
+    Returns false - Otherwise
+*/
+
+bool Linker::Link(const vector<ObjectModule>& a_modules, vector<int>& a_image,
+                  map<string, int>& a_exports)
+{
+    a_image.assign(Emulator::MEMSZ, 0);
+    a_exports.clear();
+
+    bool linked = true;
+    bool fits = true;
+    bool halt = false;
+
+    // how far each module is moved, and where the next one goes
+    vector<int> offsets;
+    int next = 0;
+
+    for (size_t i = 0; i < a_modules.size(); i++)
+    {
+        const ObjectModule& module = a_modules[i];
+        int place = (i == 0) ? module.m_first : next;
+
+        if (place + module.m_end - module.m_first > Emulator::MEMSZ)
+        {
+            //Code 39: Modules Exceed Quack3200 Memory
+            Errors::RecordError(39, "MODULE# " + to_string(i + 1));
+
+            fits = false;
+            break;
+        }
+
+        offsets.push_back(place - module.m_first);
+        next = place + module.m_end - module.m_first;
+        halt = halt || module.m_halt;
+
+        for (auto& symbol : module.m_exports)
+        {
+            if (!a_exports.insert(make_pair(symbol.first, symbol.second + offsets[i])).second)
+            {
+                //Code 38: Symbol Exported By More Than One Module
+                Errors::RecordError(38, symbol.first);
+                linked = false;
+            }
+        }
+    }
+
+    // the words of the modules that do not fit have no place
+    if (!fits)
+        return false;
+
+    if (!halt)
+    {
+        //Code 14: No HALT Instruction Detected for Execution Termination
+        Errors::RecordError(14, "*****");
+        linked = false;
+    }
+
+    for (size_t i = 0; i < a_modules.size(); i++)
+    {
+        const ObjectModule& module = a_modules[i];
+        int offset = offsets[i];
+
+        for (auto& word : module.m_words)
+            a_image[word.first + offset] = word.second;
+
+        // the address part of the word or the constant is the location of a symbol
+        for (const int& loc : module.m_relocations)
+            a_image[loc + offset] += offset;
+
+        for (auto& import : module.m_imports)
+        {
+            auto symbol = a_exports.find(import.second);
+
+            if (symbol == a_exports.end())
+            {
+                //Code 37: Imported Symbol Is Not Exported By Any Module
+                Errors::RecordError(37, import.second);
+                linked = false;
+            }
+
+            else
+                a_image[import.first + offset] += symbol->second;
+        }
+    }
+
+    return linked;
+}
+/*bool Linker::Link(const vector<ObjectModule>& a_modules, vector<int>& a_image,
+  map<string, int>& a_exports); */
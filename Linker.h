@@ -0,0 +1,41 @@
+//
+//        Linker - places relocatable object modules one after the other
+//        in Quack3200 memory and resolves the symbols they import from
+//        each other, making one image that the emulator can run. Object
+//        modules are made by Pass II of an assembler in object mode (see
+//        Assembler::SetObjectMode) and kept in files as text.
+//
+
+#ifndef _LINKER_H
+#define _LINKER_H
+
+#include "stdafx.h"
+
+// A program or a library assembled on its own
+struct ObjectModule
+{
+    int m_first;                            // The first location of the module
+    int m_end;                              // The location following its last one
+    bool m_halt;                            // == true if the module has the HALT instruction
+    vector<pair<int, int>> m_words;         // Location and contents of each non-zero word
+    vector<int> m_relocations;              // Words holding the location of a symbol of the module
+    vector<pair<int, string>> m_imports;    // Words holding the location of an imported symbol, and the symbol
+    map<string, int> m_exports;             // The symbols other modules may import, and their locations
+};
+
+class Linker
+{
+
+public:
+
+    // Writes an object module in the form read by ReadModule()
+    static void WriteModule(const ObjectModule&, ostream&);
+
+    // Reads an object module, false if there is none
+    static bool ReadModule(istream&, ObjectModule&);
+
+    // Places the modules and resolves their symbols into one image
+    static bool Link(const vector<ObjectModule>&, vector<int>&, map<string, int>&);
+};
+
+#endif
@@ -0,0 +1,229 @@
+//
+//  Implementation of the listing writer class.
+//
+
+#include "stdafx.h"
+#include <cerrno>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define write _write
+#define close _close
+#define open _open
+#else
+#include <unistd.h>
+#endif
+
+ListingWriter::~ListingWriter()
+{
+    Flush();
+
+    if (m_ownsFd)
+        close(m_fd);
+}
+
+
+/*
+NAME
+
+    Open - Directs the listing to a file
+
+SYNOPSIS
+
+    bool Open(const string& a_path);
+
+DESCRIPTION
+
+    This function flushes any buffered output and creates (or truncates)
+    the file "a_path", which receives all further output.
+
+    Returns true - if the file could be opened
+    Returns false - Otherwise (the destination is left unchanged)
+*/
+
+bool ListingWriter::Open(const string& a_path)
+{
+    int fd = open(a_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+        return false;
+
+    Attach(fd);
+    m_ownsFd = true;
+
+    return true;
+}
+/*bool ListingWriter::Open(const string& a_path); */
+
+
+/*
+NAME
+
+    Attach - Directs the listing to an open file descriptor
+
+SYNOPSIS
+
+    void Attach(const int& a_fd);
+
+DESCRIPTION
+
+    This function flushes any buffered output, closes the previous
+    destination if it was opened by Open(), and writes all further
+    output to "a_fd". The caller keeps ownership of "a_fd".
+*/
+
+void ListingWriter::Attach(const int& a_fd)
+{
+    Flush();
+
+    if (m_ownsFd)
+        close(m_fd);
+
+    m_fd = a_fd;
+    m_ownsFd = false;
+}
+/*void ListingWriter::Attach(const int& a_fd); */
+
+
+/*
+NAME
+
+    Pad - Appends spaces
+
+SYNOPSIS
+
+    void Pad(const size_t& a_count);
+
+DESCRIPTION
+
+    This function appends "a_count" spaces to the buffered output.
+*/
+
+void ListingWriter::Pad(const size_t& a_count)
+{
+    static const char spaces[] = "                                ";
+    size_t remaining = a_count;
+
+    while (remaining > 0)
+    {
+        size_t chunk = remaining < sizeof(spaces) - 1 ? remaining : sizeof(spaces) - 1;
+        Append(spaces, chunk);
+        remaining -= chunk;
+    }
+}
+/*void ListingWriter::Pad(const size_t& a_count); */
+
+
+/*
+NAME
+
+    AppendLeft - Appends an integer left-justified in a column
+
+SYNOPSIS
+
+    void AppendLeft(const int& a_value, const size_t& a_width);
+
+DESCRIPTION
+
+    This function converts "a_value" to decimal without going through
+    iostreams and appends it followed by enough spaces to fill a column
+    of "a_width" characters, as "setw(a_width) << left" would.
+*/
+
+void ListingWriter::AppendLeft(const int& a_value, const size_t& a_width)
+{
+    // enough for the sign and the ten digits of any int
+    char digits[12];
+    int pos = sizeof(digits);
+
+    // work with the magnitude as unsigned to handle the most negative int
+    unsigned magnitude = a_value < 0 ? 0u - (unsigned)a_value : (unsigned)a_value;
+
+    do
+    {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (a_value < 0)
+        digits[--pos] = '-';
+
+    size_t size = sizeof(digits) - pos;
+    Append(digits + pos, size);
+
+    if (size < a_width)
+        Pad(a_width - size);
+}
+/*void ListingWriter::AppendLeft(const int& a_value, const size_t& a_width); */
+
+
+/*
+NAME
+
+    Flush - Writes the buffered output
+
+SYNOPSIS
+
+    void Flush();
+
+DESCRIPTION
+
+    This function writes everything that is buffered to the destination.
+    The standard output stream is flushed first so that the listing stays
+    in order with anything already written through cout.
+*/
+
+void ListingWriter::Flush()
+{
+    if (m_used == 0)
+        return;
+
+    cout.flush();
+
+    WriteAll(m_buffer, m_used);
+    m_used = 0;
+}
+/*void ListingWriter::Flush(); */
+
+
+/*
+NAME
+
+    WriteAll - Writes characters to the file descriptor
+
+SYNOPSIS
+
+    void WriteAll(const char *a_chars, size_t a_size);
+
+DESCRIPTION
+
+    This function writes all "a_size" characters of "a_chars",
+    retrying after partial writes and interrupted system calls.
+    Output is dropped if the destination reports an error. The
+    characters are also added to the copy requested by Capture().
+*/
+
+void ListingWriter::WriteAll(const char *a_chars, size_t a_size)
+{
+    if (m_capture != nullptr)
+        m_capture->append(a_chars, a_size);
+
+    while (a_size > 0)
+    {
+        int chunk = a_size > (1u << 30) ? (1 << 30) : (int)a_size;
+        auto written = write(m_fd, a_chars, chunk);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return;
+        }
+
+        a_chars += written;
+        a_size -= written;
+    }
+}
+/*void ListingWriter::WriteAll(const char *a_chars, size_t a_size); */
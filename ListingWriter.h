@@ -0,0 +1,100 @@
+//
+//        Listing writer - formats the rows of the translation listing
+//        into a large buffer and writes it to a file descriptor in
+//        big chunks instead of formatting each field through iostreams.
+//
+
+#ifndef _LISTINGWRITER_H
+#define _LISTINGWRITER_H
+
+#include "stdafx.h"
+
+class ListingWriter
+{
+
+public:
+
+    // Writes to the standard output by default
+    ListingWriter(): m_fd(1), m_ownsFd(false), m_used(0), m_capture(nullptr) {}
+
+    // Flushes the remaining output and closes the file if one was opened
+    ~ListingWriter();
+
+    // Writes to the file "a_path" instead of the standard output
+    bool Open(const string&);
+
+    // Writes to an already open file descriptor
+    void Attach(const int&);
+
+    // Appends a sequence of characters
+    void Append(const char *a_chars, const size_t& a_size)
+    {
+        if (m_used + a_size > BUFSZ)
+            Flush();
+
+        // output larger than the buffer is written directly
+        if (a_size > BUFSZ)
+        {
+            WriteAll(a_chars, a_size);
+            return;
+        }
+
+        memcpy(m_buffer + m_used, a_chars, a_size);
+        m_used += a_size;
+    }
+
+    void Append(const string& a_str)
+    {
+        Append(a_str.data(), a_str.size());
+    }
+
+    void Append(const char& a_ch)
+    {
+        if (m_used == BUFSZ)
+            Flush();
+
+        m_buffer[m_used++] = a_ch;
+    }
+
+    // Appends "a_count" spaces
+    void Pad(const size_t&);
+
+    // Appends "a_str" left-justified in a column of "a_width" characters
+    void AppendLeft(const string& a_str, const size_t& a_width)
+    {
+        Append(a_str);
+
+        if (a_str.size() < a_width)
+            Pad(a_width - a_str.size());
+    }
+
+    // Appends "a_value" left-justified in a column of "a_width" characters
+    void AppendLeft(const int&, const size_t&);
+
+    // Writes the buffered output
+    void Flush();
+
+    // Keeps a copy of all further output in "a_copy" (nullptr to stop)
+    void Capture(string *a_copy)
+    {
+        Flush();
+        m_capture = a_copy;
+    }
+
+
+private:
+
+    // Writes "a_size" characters to the file descriptor
+    void WriteAll(const char *, size_t);
+
+    // The size of the output buffer
+    const static size_t BUFSZ = 1 << 16;
+
+    int m_fd;                   // Destination of the listing
+    bool m_ownsFd;              // == true if the destination was opened by Open()
+    size_t m_used;              // Number of characters in the buffer
+    string *m_capture;          // Copy of the output, nullptr if none is kept
+    char m_buffer[BUFSZ];       // The buffered output
+};
+
+#endif
@@ -0,0 +1,70 @@
+//
+//        Machine traits - the geometry of a Quack3200 machine.
+//        A translation is the opcode, followed by one digit for the
+//        register and ADDRESS_DIGITS digits for the address. A word of
+//        data holds up to WORD_DIGITS digits and a sign. The divisors
+//        are constants, so the decimal arithmetic is done by the
+//        multiplications the compiler chooses for them.
+//
+
+#ifndef _MACHINE_H
+#define _MACHINE_H
+
+template <int ADDRESS_DIGITS_, int WORD_DIGITS_>
+struct MachineTraits
+{
+    // the largest translation (of opcode 99, the last indexed instruction) must fit an int
+    static_assert(ADDRESS_DIGITS_ >= 3 && ADDRESS_DIGITS_ <= 6, "addresses must have 3 to 6 digits");
+    static_assert(WORD_DIGITS_ >= 8 && WORD_DIGITS_ <= 9, "words must have 8 or 9 digits");
+
+    // 10 to the power "a_digits"
+    static constexpr int Power(const int a_digits)
+    {
+        return a_digits == 0 ? 1 : 10 * Power(a_digits - 1);
+    }
+
+    // The number of digits of an address and of a word
+    static constexpr int ADDRESS_DIGITS = ADDRESS_DIGITS_;
+    static constexpr int WORD_DIGITS = WORD_DIGITS_;
+
+    // The size of the memory
+    static constexpr int MEMSZ = Power(ADDRESS_DIGITS);
+
+    // The largest and the smallest value of a word
+    static constexpr int MAXVAL = Power(WORD_DIGITS) - 1;
+    static constexpr int MINVAL = -MAXVAL;
+
+    // Used to extract the opcode and the register of a translation
+    static constexpr int OPCODE_DIVISOR = 10 * MEMSZ;
+    static constexpr int REG_DIVISOR = MEMSZ;
+
+    // The parts of a translation
+    static int Opcode(const int& a_translation)
+    {
+        return a_translation / OPCODE_DIVISOR;
+    }
+
+    static int Register(const int& a_translation)
+    {
+        return (a_translation % OPCODE_DIVISOR) / REG_DIVISOR;
+    }
+
+    static int Address(const int& a_translation)
+    {
+        return a_translation % REG_DIVISOR;
+    }
+
+    // Makes a translation from its parts
+    static constexpr int Translation(const int a_opcode, const int a_regNumber, const int a_address)
+    {
+        return a_opcode * OPCODE_DIVISOR + a_regNumber * REG_DIVISOR + a_address;
+    }
+};
+
+// The Quack3200: 100,000 words of 8 digits
+typedef MachineTraits<5, 8> Quack3200;
+
+// A wider variant for larger data sets: 1,000,000 words of 9 digits
+typedef MachineTraits<6, 9> Quack3200Wide;
+
+#endif
@@ -0,0 +1,596 @@
+//
+//  Implementation of the metrics class.
+//
+
+#include "stdafx.h"
+#include <cstdlib>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//"giving life" to static data members
+bool Metrics::m_enabled = false;
+bool Metrics::m_hardware = false;
+Metrics::Format Metrics::m_format = Metrics::FM_Json;
+string Metrics::m_path;
+atomic<long long> Metrics::m_counters[NUM_COUNTERS];
+atomic<long long> Metrics::m_timerNanos[NUM_TIMERS];
+atomic<long long> Metrics::m_timerRuns[NUM_TIMERS];
+atomic<long long> Metrics::m_buckets[NUM_HISTOGRAMS][NUM_BUCKETS];
+atomic<long long> Metrics::m_histSum[NUM_HISTOGRAMS];
+atomic<long long> Metrics::m_hwCounts[NUM_TIMERS][NUM_HW_EVENTS];
+atomic<bool> Metrics::m_hwSupported[NUM_HW_EVENTS];
+
+namespace
+{
+
+// Names used in the report, in the order of the enumerations
+const char *const TIMER_NAMES[] =
+{
+    "source_open", "parse", "symbol_resolution", "translation", "image_load", "emulation"
+};
+
+const char *const COUNTER_NAMES[] =
+{
+    "source_lines", "source_bytes", "image_words", "instructions", "assembly_errors", "runtime_errors",
+    "cache_hits", "cache_misses", "optimized_words"
+};
+
+const char *const HISTOGRAM_NAMES[] =
+{
+    "source_line_bytes", "symbol_lookup_nanoseconds"
+};
+
+const char *const HW_EVENT_NAMES[] =
+{
+    "cycles", "instructions", "branch_misses", "l1d_read_misses", "llc_misses"
+};
+
+// The phases whose hardware events are counted
+const Metrics::Timer HW_TIMERS[] = {Metrics::TM_Parse, Metrics::TM_Translation, Metrics::TM_Emulation};
+
+// The hardware counters of one thread, opened the first time they are read on it
+class HardwareCounters
+{
+
+public:
+
+    HardwareCounters(): m_any(false)
+    {
+        fill(m_fds, m_fds + Metrics::NUM_HW_EVENTS, -1);
+
+#ifdef __linux__
+        const unsigned int types[] =
+        {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+        };
+
+        const unsigned long long configs[] =
+        {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_MISSES
+        };
+
+        // each event on its own, so that one the processor lacks does not lose the others
+        for (int e = 0; e < Metrics::NUM_HW_EVENTS; e++)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            // only the program itself, which needs no privilege where perf_event_paranoid is 2 or less
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            m_fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            m_any = m_any || m_fds[e] >= 0;
+        }
+#endif
+    }
+
+    ~HardwareCounters()
+    {
+#ifdef __linux__
+        for (int fd : m_fds)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+    // Determines if the event is counted on this thread
+    bool IsOpen(const int& a_event) const
+    {
+        return m_fds[a_event] >= 0;
+    }
+
+    // Reads every event counted so far, false if none is
+    bool Read(long long a_values[]) const
+    {
+        if (!m_any)
+            return false;
+
+        for (int e = 0; e < Metrics::NUM_HW_EVENTS; e++)
+        {
+            a_values[e] = 0;
+
+#ifdef __linux__
+            // the count, and the times the event was enabled and running on the processor
+            unsigned long long data[3];
+
+            if (m_fds[e] < 0 || read(m_fds[e], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+                continue;
+
+            // the events share the counters of the processor, scale the count to the whole time
+            a_values[e] = static_cast<long long>(data[0] * (static_cast<double>(data[1]) / data[2]));
+#endif
+        }
+
+        return true;
+    }
+
+private:
+
+    int m_fds[Metrics::NUM_HW_EVENTS];      // The file of each event, -1 if it is not counted
+    bool m_any;                             // == true if some event is counted
+};
+
+// The counters of the calling thread
+HardwareCounters& ThreadCounters()
+{
+    thread_local HardwareCounters counters;
+
+    return counters;
+}
+
+}
+
+/*
+NAME
+
+    Enable - Enables the collection of metrics
+
+SYNOPSIS
+
+    void Enable(const Format& a_format, const string& a_path);
+
+DESCRIPTION
+
+    This function turns on all timers, counters and histograms and
+    arranges for the report to be written in "a_format" to "a_path"
+    (or to the standard error if "a_path" is empty) when the program exits.
+*/
+
+void Metrics::Enable(const Format& a_format, const string& a_path)
+{
+    if (!m_enabled)
+        atexit(ReportAtExit);
+
+    m_format = a_format;
+    m_path = a_path;
+    m_enabled = true;
+}
+/*void Metrics::Enable(const Format& a_format, const string& a_path); */
+
+
+/*
+NAME
+
+    EnableFromEnvironment - Enables metrics if the environment requests them
+
+SYNOPSIS
+
+    void EnableFromEnvironment();
+
+DESCRIPTION
+
+    This function enables metrics when QUACK_METRICS is "json" or
+    "prometheus". The report is written to the file named by
+    QUACK_METRICS_FILE, or to the standard error if it is not set. When
+    QUACK_PERF is 1 the hardware events are counted as well, or a warning
+    is given if they cannot be.
+*/
+
+void Metrics::EnableFromEnvironment()
+{
+    const char *format = getenv("QUACK_METRICS");
+    const char *path = getenv("QUACK_METRICS_FILE");
+
+    if (format == nullptr)
+        return;
+
+    if (strcmp(format, "json") == 0)
+        Enable(FM_Json, path ? path : "");
+
+    else if (strcmp(format, "prometheus") == 0)
+        Enable(FM_Prometheus, path ? path : "");
+
+    else
+    {
+        cerr << "QUACK_METRICS must be json or prometheus, metrics disabled." << endl;
+        return;
+    }
+
+    const char *perf = getenv("QUACK_PERF");
+
+    if (perf != nullptr && strcmp(perf, "1") == 0 && !EnableHardwareCounters())
+        cerr << "Hardware performance counters are not available, only time is measured." << endl;
+}
+/*void Metrics::EnableFromEnvironment(); */
+
+
+/*
+NAME
+
+    EnableHardwareCounters - Counts hardware events during the passes and the emulation
+
+SYNOPSIS
+
+    bool EnableHardwareCounters();
+
+DESCRIPTION
+
+    This function turns on the counting of the hardware events of the
+    processor (see HardwareEvent) during Pass I, Pass II and the
+    emulation, with perf_event_open(2) on Linux. Only the events of the
+    program are counted, which the kernel allows unprivileged programs
+    unless /proc/sys/kernel/perf_event_paranoid is above 2. The events the
+    processor or the virtual machine lacks are not reported. Metrics must
+    be enabled first.
+
+    Returns true - if some event can be counted
+    Returns false - Otherwise, only the time of the phases is measured
+*/
+
+bool Metrics::EnableHardwareCounters()
+{
+    if (!m_enabled)
+        return false;
+
+    const HardwareCounters& counters = ThreadCounters();
+    long long values[NUM_HW_EVENTS];
+
+    m_hardware = counters.Read(values);
+
+    for (int e = 0; e < NUM_HW_EVENTS; e++)
+        m_hwSupported[e] = m_hardware && counters.IsOpen(e);
+
+    return m_hardware;
+}
+/*bool Metrics::EnableHardwareCounters(); */
+
+
+/*
+NAME
+
+    Observe - Records one observation in a histogram
+
+SYNOPSIS
+
+    void Observe(const Histogram& a_hist, const long long& a_value);
+
+DESCRIPTION
+
+    This function places "a_value" in the smallest power-of-two bucket
+    that holds it. Values beyond the last bucket are counted in it.
+*/
+
+void Metrics::Observe(const Histogram& a_hist, const long long& a_value)
+{
+    if (!m_enabled)
+        return;
+
+    int bucket = 0;
+    while (bucket < NUM_BUCKETS - 1 && (1LL << bucket) < a_value)
+        bucket++;
+
+    m_buckets[a_hist][bucket].fetch_add(1, memory_order_relaxed);
+    m_histSum[a_hist].fetch_add(a_value, memory_order_relaxed);
+}
+/*void Metrics::Observe(const Histogram& a_hist, const long long& a_value); */
+
+
+/*
+NAME
+
+    RecordTime - Records one completed run of a timed phase
+
+SYNOPSIS
+
+    void RecordTime(const Timer& a_timer, const long long& a_nanos);
+
+DESCRIPTION
+
+    This function adds "a_nanos" nanoseconds to the total time of
+    "a_timer" and counts one more run of the phase.
+*/
+
+void Metrics::RecordTime(const Timer& a_timer, const long long& a_nanos)
+{
+    if (!m_enabled)
+        return;
+
+    m_timerNanos[a_timer].fetch_add(a_nanos, memory_order_relaxed);
+    m_timerRuns[a_timer].fetch_add(1, memory_order_relaxed);
+}
+/*void Metrics::RecordTime(const Timer& a_timer, const long long& a_nanos); */
+
+
+/*
+NAME
+
+    ReadHardwareCounters - Reads the hardware events counted on this thread
+
+SYNOPSIS
+
+    bool ReadHardwareCounters(long long a_values[]);
+
+DESCRIPTION
+
+    This function places in "a_values" the number of each hardware event
+    counted on the calling thread since its counters were opened, the
+    first time they are read on it. An event that is not counted is 0.
+
+    Returns true - if the events are counted on this thread
+    Returns false - Otherwise
+*/
+
+bool Metrics::ReadHardwareCounters(long long a_values[])
+{
+    return ThreadCounters().Read(a_values);
+}
+/*bool Metrics::ReadHardwareCounters(long long a_values[]); */
+
+
+/*
+NAME
+
+    RecordHardware - Records the hardware events of one completed run of a phase
+
+SYNOPSIS
+
+    void RecordHardware(const Timer& a_timer, const long long a_start[], const long long a_end[]);
+
+DESCRIPTION
+
+    This function adds to the hardware events of "a_timer" the events
+    counted between "a_start" and "a_end", as read by ReadHardwareCounters().
+*/
+
+void Metrics::RecordHardware(const Timer& a_timer, const long long a_start[], const long long a_end[])
+{
+    if (!m_enabled)
+        return;
+
+    for (int e = 0; e < NUM_HW_EVENTS; e++)
+        m_hwCounts[a_timer][e].fetch_add(max(0LL, a_end[e] - a_start[e]), memory_order_relaxed);
+}
+/*void Metrics::RecordHardware(const Timer& a_timer, const long long a_start[], const long long a_end[]); */
+
+
+/*
+NAME
+
+    Report - Writes the report in the requested format
+
+SYNOPSIS
+
+    void Report(ostream& a_out, const Format& a_format);
+
+DESCRIPTION
+
+    This function writes every timer, counter and histogram to "a_out",
+    either as one JSON object or in the Prometheus text exposition format.
+    Timers are reported in seconds together with the number of runs.
+*/
+
+void Metrics::Report(ostream& a_out, const Format& a_format)
+{
+    ostringstream report;
+    report<<setprecision(9);
+
+    if (a_format == FM_Json)
+    {
+        report<<"{\"timers\":{";
+        for (int i = 0; i < NUM_TIMERS; i++)
+        {
+            report<<(i ? "," : "")<<"\""<<TIMER_NAMES[i]<<"\":{\"runs\":"<<m_timerRuns[i]
+                  <<",\"seconds\":"<<m_timerNanos[i] / 1e9<<"}";
+        }
+
+        report<<"},\"counters\":{";
+        for (int i = 0; i < NUM_COUNTERS; i++)
+            report<<(i ? "," : "")<<"\""<<COUNTER_NAMES[i]<<"\":"<<m_counters[i];
+
+        report<<"},\"histograms\":{";
+        for (int i = 0; i < NUM_HISTOGRAMS; i++)
+        {
+            long long count = 0;
+            report<<(i ? "," : "")<<"\""<<HISTOGRAM_NAMES[i]<<"\":{\"buckets\":[";
+
+            for (int b = 0; b < NUM_BUCKETS; b++)
+            {
+                count += m_buckets[i][b];
+                report<<(b ? "," : "")<<m_buckets[i][b];
+            }
+
+            report<<"],\"count\":"<<count<<",\"sum\":"<<m_histSum[i]<<"}";
+        }
+
+        report<<"},\"hardware\":{\"available\":"<<(m_hardware ? "true" : "false")<<",\"phases\":{";
+        for (size_t i = 0; m_hardware && i < size(HW_TIMERS); i++)
+        {
+            Timer timer = HW_TIMERS[i];
+            report<<(i ? "," : "")<<"\""<<TIMER_NAMES[timer]<<"\":{\"events\":{";
+            WriteHardwareEvents(report, timer, 0, "\"", "\":", ",");
+
+            report<<"},\"per_host_instruction\":{";
+            if (m_hwCounts[timer][HW_Instructions] != 0)
+                WriteHardwareEvents(report, timer, m_hwCounts[timer][HW_Instructions], "\"", "\":", ",");
+
+            // the cost of the dispatch of each Quack3200 instruction
+            if (timer == TM_Emulation)
+            {
+                report<<"},\"per_emulated_instruction\":{";
+                if (m_counters[CT_Instructions] != 0)
+                    WriteHardwareEvents(report, timer, m_counters[CT_Instructions], "\"", "\":", ",");
+            }
+
+            report<<"}}";
+        }
+
+        report<<"}}}"<<endl;
+    }
+
+    else
+    {
+        report<<"# TYPE quack_phase_seconds_total counter"<<endl;
+        for (int i = 0; i < NUM_TIMERS; i++)
+            report<<"quack_phase_seconds_total{phase=\""<<TIMER_NAMES[i]<<"\"} "<<m_timerNanos[i] / 1e9<<endl;
+
+        report<<"# TYPE quack_phase_runs_total counter"<<endl;
+        for (int i = 0; i < NUM_TIMERS; i++)
+            report<<"quack_phase_runs_total{phase=\""<<TIMER_NAMES[i]<<"\"} "<<m_timerRuns[i]<<endl;
+
+        for (int i = 0; i < NUM_COUNTERS; i++)
+        {
+            report<<"# TYPE quack_"<<COUNTER_NAMES[i]<<"_total counter"<<endl;
+            report<<"quack_"<<COUNTER_NAMES[i]<<"_total "<<m_counters[i]<<endl;
+        }
+
+        for (int i = 0; i < NUM_HISTOGRAMS; i++)
+        {
+            string name = string("quack_") + HISTOGRAM_NAMES[i];
+            long long count = 0;
+
+            report<<"# TYPE "<<name<<" histogram"<<endl;
+            for (int b = 0; b < NUM_BUCKETS - 1; b++)
+            {
+                count += m_buckets[i][b];
+                report<<name<<"_bucket{le=\""<<(1LL << b)<<"\"} "<<count<<endl;
+            }
+
+            count += m_buckets[i][NUM_BUCKETS - 1];
+            report<<name<<"_bucket{le=\"+Inf\"} "<<count<<endl;
+            report<<name<<"_sum "<<m_histSum[i]<<endl;
+            report<<name<<"_count "<<count<<endl;
+        }
+
+        if (m_hardware)
+        {
+            const char *const kinds[] = {"total", "per_host_instruction"};
+
+            for (int k = 0; k < 2; k++)
+            {
+                report<<"# TYPE quack_phase_hardware_events_"<<kinds[k]<<(k ? " gauge" : " counter")<<endl;
+                for (Timer timer : HW_TIMERS)
+                {
+                    long long divisor = k ? m_hwCounts[timer][HW_Instructions].load() : 0;
+                    string prefix = string("quack_phase_hardware_events_") + kinds[k] + "{phase=\""
+                        + TIMER_NAMES[timer] + "\",event=\"";
+
+                    if (k == 0 || divisor != 0)
+                    {
+                        WriteHardwareEvents(report, timer, divisor, prefix.c_str(), "\"} ", "\n");
+                        report<<endl;
+                    }
+                }
+            }
+
+            report<<"# TYPE quack_emulation_hardware_events_per_emulated_instruction gauge"<<endl;
+            if (m_counters[CT_Instructions] != 0)
+            {
+                WriteHardwareEvents(report, TM_Emulation, m_counters[CT_Instructions],
+                                    "quack_emulation_hardware_events_per_emulated_instruction{event=\"", "\"} ",
+                                    "\n");
+                report<<endl;
+            }
+        }
+    }
+
+    a_out<<report.str();
+    a_out.flush();
+}
+/*void Metrics::Report(ostream& a_out, const Format& a_format); */
+
+
+/*
+NAME
+
+    WriteHardwareEvents - Writes the hardware events of a phase
+
+SYNOPSIS
+
+    void WriteHardwareEvents(ostream& a_out, const Timer& a_timer, const long long& a_divisor,
+        const char *a_before, const char *a_between, const char *a_separator);
+
+DESCRIPTION
+
+    This function writes to "a_out" the name and the count divided by
+    "a_divisor" of each hardware event of "a_timer" that could be counted,
+    as "a_before" name "a_between" value, separated by "a_separator". The
+    counts themselves are written if "a_divisor" is 0.
+*/
+
+void Metrics::WriteHardwareEvents(ostream& a_out, const Timer& a_timer, const long long& a_divisor,
+                                  const char *a_before, const char *a_between, const char *a_separator)
+{
+    bool first = true;
+
+    for (int e = 0; e < NUM_HW_EVENTS; e++)
+    {
+        if (!m_hwSupported[e])
+            continue;
+
+        a_out<<(first ? "" : a_separator)<<a_before<<HW_EVENT_NAMES[e]<<a_between;
+
+        if (a_divisor == 0)
+            a_out<<m_hwCounts[a_timer][e];
+        else
+            a_out<<static_cast<double>(m_hwCounts[a_timer][e]) / a_divisor;
+
+        first = false;
+    }
+}
+/*void Metrics::WriteHardwareEvents(ostream& a_out, const Timer& a_timer, const long long& a_divisor,
+  const char *a_before, const char *a_between, const char *a_separator); */
+
+
+/*
+NAME
+
+    ReportAtExit - Writes the report to the requested destination
+
+SYNOPSIS
+
+    void ReportAtExit();
+
+DESCRIPTION
+
+    This function is registered with atexit() when metrics are enabled.
+    It writes the report to the file given to Enable(), or to the standard
+    error if no file was given or it could not be opened.
+*/
+
+void Metrics::ReportAtExit()
+{
+    if (!m_path.empty())
+    {
+        ofstream file(m_path, ios::out | ios::trunc);
+
+        if (file)
+        {
+            Report(file, m_format);
+            return;
+        }
+    }
+
+    Report(cerr, m_format);
+}
+/*void Metrics::ReportAtExit(); */
@@ -0,0 +1,193 @@
+//
+//        Metrics class - phase timers, counters and histograms collected
+//        across the assembler, file access and emulator. Nothing is
+//        measured unless metrics are enabled, and the report is
+//        emitted as JSON or Prometheus text at exit. The passes of the
+//        assembler and the emulation may also be measured with the
+//        hardware performance counters of the processor, where the
+//        system lets an unprivileged program read them.
+//
+
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include "stdafx.h"
+
+class Metrics
+{
+
+public:
+
+    //the timed phases of a job
+    enum Timer
+    {
+        TM_SourceOpen,              // Opening the source file
+        TM_Parse,                   // Pass I
+        TM_SymbolResolution,        // Symbol table lookups in Pass II
+        TM_Translation,             // Pass II
+        TM_ImageLoad,               // Inserting the translation into memory
+        TM_Emulation,               // Running the emulator
+        NUM_TIMERS
+    };
+
+    //the counted events of a job
+    enum Counter
+    {
+        CT_SourceLines,             // Lines read from the source file
+        CT_SourceBytes,             // Bytes read from the source file
+        CT_ImageWords,              // Words inserted into the emulator memory
+        CT_Instructions,            // Instructions dispatched by the emulator
+        CT_AssemblyErrors,          // Errors reported by the assembler
+        CT_RuntimeErrors,           // Errors reported by the emulator
+        CT_CacheHits,               // Programs found in the assembly cache
+        CT_CacheMisses,             // Programs not found in the assembly cache
+        CT_OptimizedWords,          // Words of the image changed by the optimizer
+        NUM_COUNTERS
+    };
+
+    //the distributions recorded for a job
+    enum Histogram
+    {
+        HG_SourceLineBytes,         // Length of each source line
+        HG_SymbolLookupNanos,       // Latency of each symbol table lookup
+        NUM_HISTOGRAMS
+    };
+
+    //the hardware events counted during the passes and the emulation
+    enum HardwareEvent
+    {
+        HW_Cycles,                  // Processor cycles
+        HW_Instructions,            // Host instructions retired
+        HW_BranchMisses,            // Mispredicted branches
+        HW_L1DataMisses,            // Level 1 data cache read misses
+        HW_LastLevelMisses,         // Last level cache misses
+        NUM_HW_EVENTS
+    };
+
+    //the supported report formats
+    enum Format
+    {
+        FM_Json,
+        FM_Prometheus
+    };
+
+    // Number of power-of-two buckets in each histogram
+    const static int NUM_BUCKETS = 32;
+
+    // Enables collection and reports to "a_path" (stderr if empty) at exit
+    static void Enable(const Format&, const string&);
+
+    // Enables collection if requested by QUACK_METRICS, QUACK_METRICS_FILE and QUACK_PERF
+    static void EnableFromEnvironment();
+
+    // Counts hardware events during the passes and the emulation, false if they cannot be counted
+    static bool EnableHardwareCounters();
+
+    // Determines if metrics are being collected
+    static bool IsEnabled()
+    {
+        return m_enabled;
+    }
+
+    // Adds "a_amount" to a counter
+    static void Add(const Counter& a_counter, const long long& a_amount)
+    {
+        if (m_enabled)
+            m_counters[a_counter].fetch_add(a_amount, memory_order_relaxed);
+    }
+
+    // Records one observation in a histogram
+    static void Observe(const Histogram&, const long long&);
+
+    // Records one completed run of a timed phase
+    static void RecordTime(const Timer&, const long long&);
+
+    // Reads the hardware events counted so far on this thread, false if there are none
+    static bool ReadHardwareCounters(long long []);
+
+    // Records the hardware events of one completed run of a timed phase
+    static void RecordHardware(const Timer&, const long long [], const long long []);
+
+    // Writes the report in the requested format
+    static void Report(ostream&, const Format&);
+
+    // Times the enclosing scope as one run of a phase
+    class ScopedTimer
+    {
+
+    public:
+
+        ScopedTimer(const Timer& a_timer, const Histogram& a_hist = NUM_HISTOGRAMS):
+        m_timer(a_timer), m_hist(a_hist), m_running(m_enabled), m_counting(false)
+        {
+            if (!m_running)
+                return;
+
+            // the short nested phases would be lost in the cost of reading the counters
+            if (m_hardware && (a_timer == TM_Parse || a_timer == TM_Translation || a_timer == TM_Emulation))
+                m_counting = ReadHardwareCounters(m_hwStart);
+
+            m_start = chrono::steady_clock::now();
+        }
+
+        ~ScopedTimer()
+        {
+            Stop();
+        }
+
+        // Ends the phase before the end of the scope
+        void Stop()
+        {
+            if (!m_running)
+                return;
+
+            long long nanos = chrono::duration_cast<chrono::nanoseconds>
+                (chrono::steady_clock::now() - m_start).count();
+
+            RecordTime(m_timer, nanos);
+
+            if (m_hist != NUM_HISTOGRAMS)
+                Observe(m_hist, nanos);
+
+            long long hwEnd[NUM_HW_EVENTS];
+
+            if (m_counting && ReadHardwareCounters(hwEnd))
+                RecordHardware(m_timer, m_hwStart, hwEnd);
+
+            m_running = false;
+        }
+
+    private:
+
+        Timer m_timer;                              // The phase being timed
+        Histogram m_hist;                           // Latency histogram, NUM_HISTOGRAMS if none
+        bool m_running;                             // == true if metrics were enabled at the start
+        bool m_counting;                            // == true if the hardware events are counted
+        chrono::steady_clock::time_point m_start;   // Start of the phase
+        long long m_hwStart[NUM_HW_EVENTS];         // The hardware events at the start of the phase
+    };
+
+
+private:
+
+    // Writes the report to the requested destination at exit
+    static void ReportAtExit();
+
+    // Writes the hardware events of a phase, divided by a number of instructions
+    static void WriteHardwareEvents(ostream&, const Timer&, const long long&, const char *, const char *,
+                                    const char *);
+
+    static bool m_enabled;                                          // == true if metrics are collected
+    static bool m_hardware;                                         // == true if hardware events are counted
+    static Format m_format;                                         // Format of the report at exit
+    static string m_path;                                           // Destination of the report at exit
+    static atomic<long long> m_counters[NUM_COUNTERS];              // Value of each counter
+    static atomic<long long> m_timerNanos[NUM_TIMERS];              // Total time spent in each phase
+    static atomic<long long> m_timerRuns[NUM_TIMERS];               // Number of runs of each phase
+    static atomic<long long> m_buckets[NUM_HISTOGRAMS][NUM_BUCKETS];// Observations per bucket
+    static atomic<long long> m_histSum[NUM_HISTOGRAMS];             // Sum of the observations
+    static atomic<long long> m_hwCounts[NUM_TIMERS][NUM_HW_EVENTS]; // Hardware events of each phase
+    static atomic<bool> m_hwSupported[NUM_HW_EVENTS];               // == true if the event could be counted
+};
+
+#endif
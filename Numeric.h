@@ -0,0 +1,110 @@
+//
+//        Numeric - the parsing and formatting of the numbers of Quack3200
+//        programs, built on from_chars and to_chars. A word is checked,
+//        measured against the digits it may have and converted in one
+//        pass, without exceptions or the locale, and the translations are
+//        padded with zeros to their fixed width without building
+//        temporary strings.
+//
+
+#ifndef _NUMERIC_H
+#define _NUMERIC_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string>
+
+class Numeric
+{
+
+public:
+
+    // The outcome of parsing a word
+    enum ParseStatus
+    {
+        NS_Valid,                           // An integer with no more digits than allowed
+        NS_NotInteger,                      // Not an optional '-' followed by digits
+        NS_TooLong                          // An integer with too many digits
+    };
+
+    // The most characters of a formatted int, with its sign
+    static constexpr int MAXCHARS = 11;
+
+    // Parses an optional '-' followed by at most "a_digits" (up to 17) digits
+    static ParseStatus Parse(const char *a_first, const char *a_last, const int& a_digits, int& a_value)
+    {
+        const char *digits = (a_first != a_last && *a_first == '-') ? a_first + 1 : a_first;
+
+        // the digits that do not fit a long long are too many for a word anyway
+        long long value = 0;
+        const char *end = std::from_chars(a_first, a_last, value).ptr;
+
+        if (digits == a_last || end != a_last)
+            return NS_NotInteger;
+
+        if (a_last - digits > a_digits)
+            return NS_TooLong;
+
+        a_value = (int)value;
+
+        return NS_Valid;
+    }
+
+    static ParseStatus Parse(const std::string& a_word, const int& a_digits, int& a_value)
+    {
+        return Parse(a_word.data(), a_word.data() + a_word.size(), a_digits, a_value);
+    }
+
+    // Determines if a word is an optional '-' followed by any number of digits
+    static bool IsInteger(const std::string& a_word)
+    {
+        const char *first = a_word.data();
+        const char *last = first + a_word.size();
+        long long value;
+
+        return last != first + (a_word[0] == '-' ? 1 : 0) && std::from_chars(first, last, value).ptr == last;
+    }
+
+    // The value of a word known to be an integer that fits an int, 0 if it is empty
+    static int Value(const std::string& a_word)
+    {
+        int value = 0;
+        std::from_chars(a_word.data(), a_word.data() + a_word.size(), value);
+
+        return value;
+    }
+
+    // Writes "a_value" in decimal from "a_out", returning the end
+    static char *Format(char *a_out, const int& a_value)
+    {
+        return std::to_chars(a_out, a_out + MAXCHARS, a_value).ptr;
+    }
+
+    // Writes non-negative "a_value" with leading zeros up to "a_width" digits, returning the end
+    static char *FormatPadded(char *a_out, const int& a_value, const int& a_width)
+    {
+        char *last = Format(a_out, a_value);
+        int zeros = a_width - (int)(last - a_out);
+
+        if (zeros <= 0)
+            return last;
+
+        // the digits move right, behind the zeros
+        std::memmove(a_out + zeros, a_out, last - a_out);
+        std::fill_n(a_out, zeros, '0');
+
+        return last + zeros;
+    }
+
+    // Appends non-negative "a_value" to "a_out" with leading zeros up to "a_width" digits
+    static void AppendPadded(std::string& a_out, const int& a_value, const int& a_width)
+    {
+        char padded[MAXCHARS + 16];
+        int width = a_width < 16 ? a_width : 16;
+
+        a_out.append(padded, FormatPadded(padded, a_value, width));
+    }
+};
+
+#endif
@@ -0,0 +1,318 @@
+//
+//  Implementation of the optimizer class.
+//
+
+#include "stdafx.h"
+
+namespace
+{
+
+// Splits a translation into its opcode, register and address the way the emulator does
+void Decode(const int& a_translation, int& a_opcode, int& a_regNumber, int& a_address)
+{
+    a_opcode = Quack3200::Opcode(a_translation);
+    a_regNumber = Quack3200::Register(a_translation);
+    a_address = Quack3200::Address(a_translation);
+}
+
+}
+
+
+/*
+NAME
+
+    Optimize - Rewrites the program in a memory image
+
+SYNOPSIS
+
+    int Optimize(int a_memory[]);
+
+DESCRIPTION
+
+    This function rewrites the program starting at location 100 of
+    "a_memory" so that it has the same results with fewer instructions
+    dispatched: the branches to B are threaded to where the B goes, the
+    LOAD of a value the register already holds is removed and the
+    locations that are no longer executed are cleared.
+
+    A program with an indexed operand, MOVE, FILL, READV or WRITEV reaches
+    locations that are only known when it runs, and one with FORK, JOIN,
+    FADD, SEND or RECV shares its memory with threads or waits for other
+    programs, so it is left as it is. A
+    program storing or reading into its own code may branch anywhere once
+    it has changed, so its branches are only threaded, and never through
+    the locations it writes.
+
+    Returns - the number of words changed
+*/
+
+int Optimizer::Optimize(int a_memory[])
+{
+    vector<int> original(a_memory, a_memory + Emulator::MEMSZ);
+
+    FlowGraph graph;
+    BuildGraph(a_memory, graph);
+
+    if (graph.m_dynamic)
+        return 0;
+
+    ThreadJumps(a_memory, graph);
+
+    if (!graph.m_selfModifying)
+    {
+        // each rewrite changes the blocks seen by the next one
+        BuildGraph(a_memory, graph);
+        RemoveRedundantLoads(a_memory, graph);
+
+        BuildGraph(a_memory, graph);
+        RemoveDeadCode(a_memory, graph);
+    }
+
+    int changed = 0;
+
+    for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+    {
+        if (a_memory[loc] != original[loc])
+            changed++;
+    }
+
+    return changed;
+}
+/*int Optimizer::Optimize(int a_memory[]); */
+
+
+/*
+NAME
+
+    BuildGraph - Builds the control-flow graph of the program
+
+SYNOPSIS
+
+    void BuildGraph(const int a_memory[], FlowGraph& a_graph);
+
+DESCRIPTION
+
+    This function follows every path of execution starting at location 100
+    of "a_memory" as AotTranslator does, and records in "a_graph" the
+    locations that can be executed, the basic blocks they form (a block
+    starts at location 100, at the destination of a branch and after a
+    branch or a HALT) and the locations that the instructions use as data.
+*/
+
+void Optimizer::BuildGraph(const int a_memory[], FlowGraph& a_graph)
+{
+    a_graph.m_blocks.clear();
+    a_graph.m_code.assign(Emulator::MEMSZ, false);
+    a_graph.m_leader.assign(Emulator::MEMSZ, false);
+    a_graph.m_data.assign(Emulator::MEMSZ, false);
+    a_graph.m_lastCode = -1;
+    a_graph.m_dynamic = false;
+    a_graph.m_selfModifying = false;
+
+    vector<int> pending;
+    pending.push_back(100);
+    a_graph.m_leader[100] = true;
+
+    int opcode, regNumber, address;
+
+    while (!pending.empty())
+    {
+        int loc = pending.back();
+        pending.pop_back();
+
+        // continue each path until it reaches a location already followed, the end of memory or a HALT
+        while (loc < Emulator::MEMSZ && !a_graph.m_code[loc])
+        {
+            a_graph.m_code[loc] = true;
+            a_graph.m_lastCode = max(a_graph.m_lastCode, loc);
+
+            Decode(a_memory[loc], opcode, regNumber, address);
+
+            // the block of READV, WRITEV, MOVE and FILL and the indexed address depend on registers,
+            // and the threads of FORK run paths of their own
+            if (opcode >= Emulator::READV)
+                a_graph.m_dynamic = true;
+
+            else if (opcode >= Emulator::ADD && opcode <= Emulator::WRITE)
+                a_graph.m_data[address] = true;
+
+            bool ends = (opcode >= Emulator::B && opcode <= Emulator::HALT);
+
+            if (ends && loc + 1 < Emulator::MEMSZ)
+                a_graph.m_leader[loc + 1] = true;
+
+            if (opcode >= Emulator::B && opcode <= Emulator::BP)
+            {
+                a_graph.m_leader[address] = true;
+                pending.push_back(address);
+            }
+
+            if (opcode == Emulator::B || opcode == Emulator::HALT)
+                break;
+
+            loc++;
+        }
+    }
+
+    for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+    {
+        if (!a_graph.m_code[loc])
+            continue;
+
+        Decode(a_memory[loc], opcode, regNumber, address);
+
+        // a STORE or a READ into code
+        if ((opcode == Emulator::STORE || opcode == Emulator::READ) && a_graph.m_code[address])
+            a_graph.m_selfModifying = true;
+
+        if (a_graph.m_blocks.empty() || a_graph.m_leader[loc] || a_graph.m_blocks.back().m_last != loc - 1)
+            a_graph.m_blocks.push_back({loc, loc});
+        else
+            a_graph.m_blocks.back().m_last = loc;
+    }
+}
+/*void Optimizer::BuildGraph(const int a_memory[], FlowGraph& a_graph); */
+
+
+/*
+NAME
+
+    ThreadJumps - Makes the branches to B go directly where the B goes
+
+SYNOPSIS
+
+    void ThreadJumps(int a_memory[], const FlowGraph& a_graph);
+
+DESCRIPTION
+
+    This function changes the destination of every branch of "a_memory"
+    that goes to a B into the destination of that B, following chains of
+    B, and replaces a B going to a HALT by that HALT. Neither the branch
+    nor the B it goes through may be used as data.
+*/
+
+void Optimizer::ThreadJumps(int a_memory[], const FlowGraph& a_graph)
+{
+    int opcode, regNumber, address;
+    int nextOpcode, nextRegNumber, nextAddress;
+
+    for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+    {
+        if (!a_graph.m_code[loc] || a_graph.m_data[loc])
+            continue;
+
+        Decode(a_memory[loc], opcode, regNumber, address);
+
+        if (opcode < Emulator::B || opcode > Emulator::BP)
+            continue;
+
+        // a chain of B that loops is followed once around
+        int target = address;
+
+        for (size_t hops = 0; hops < a_graph.m_blocks.size() && !a_graph.m_data[target]; hops++)
+        {
+            Decode(a_memory[target], nextOpcode, nextRegNumber, nextAddress);
+
+            if (nextOpcode != Emulator::B)
+                break;
+
+            target = nextAddress;
+        }
+
+        Decode(a_memory[target], nextOpcode, nextRegNumber, nextAddress);
+
+        if (opcode == Emulator::B && nextOpcode == Emulator::HALT && !a_graph.m_data[target])
+            a_memory[loc] = a_memory[target];
+
+        else if (target != address)
+            a_memory[loc] = Quack3200::Translation(opcode, regNumber, target);
+    }
+}
+/*void Optimizer::ThreadJumps(int a_memory[], const FlowGraph& a_graph); */
+
+
+/*
+NAME
+
+    RemoveRedundantLoads - Removes the LOAD of a value the register already holds
+
+SYNOPSIS
+
+    void RemoveRedundantLoads(int a_memory[], const FlowGraph& a_graph);
+
+DESCRIPTION
+
+    This function removes from each basic block of "a_memory" the
+    LOAD r,X that follows a STORE r,X or a LOAD r,X, by moving the rest
+    of the block up one word. Nothing may branch to the moved words, so
+    only blocks that end with B or HALT and that are not used as data
+    are changed; the word left at the end of the block is no longer
+    executed.
+*/
+
+void Optimizer::RemoveRedundantLoads(int a_memory[], const FlowGraph& a_graph)
+{
+    int opcode, regNumber, address;
+    int nextOpcode, nextRegNumber, nextAddress;
+
+    for (const BasicBlock& block : a_graph.m_blocks)
+    {
+        Decode(a_memory[block.m_last], opcode, regNumber, address);
+
+        if (opcode != Emulator::B && opcode != Emulator::HALT)
+            continue;
+
+        if (find(a_graph.m_data.begin() + block.m_first, a_graph.m_data.begin() + block.m_last + 1, true)
+            != a_graph.m_data.begin() + block.m_last + 1)
+            continue;
+
+        int last = block.m_last;
+        int loc = block.m_first;
+
+        // the LOAD is never the B or the HALT ending the block
+        while (loc + 1 < last)
+        {
+            Decode(a_memory[loc], opcode, regNumber, address);
+            Decode(a_memory[loc + 1], nextOpcode, nextRegNumber, nextAddress);
+
+            if ((opcode == Emulator::STORE || opcode == Emulator::LOAD) && nextOpcode == Emulator::LOAD
+                && regNumber == nextRegNumber && address == nextAddress)
+            {
+                copy(a_memory + loc + 2, a_memory + last + 1, a_memory + loc + 1);
+                last--;
+            }
+
+            else
+                loc++;
+        }
+    }
+}
+/*void Optimizer::RemoveRedundantLoads(int a_memory[], const FlowGraph& a_graph); */
+
+
+/*
+NAME
+
+    RemoveDeadCode - Clears the locations the program neither executes nor uses as data
+
+SYNOPSIS
+
+    void RemoveDeadCode(int a_memory[], const FlowGraph& a_graph);
+
+DESCRIPTION
+
+    This function clears the words of "a_memory" from location 100 to the
+    last location that can be executed which cannot be executed and are
+    not used as data, such as the code following a B that nothing
+    branches to.
+*/
+
+void Optimizer::RemoveDeadCode(int a_memory[], const FlowGraph& a_graph)
+{
+    for (int loc = 100; loc <= a_graph.m_lastCode; loc++)
+    {
+        if (!a_graph.m_code[loc] && !a_graph.m_data[loc])
+            a_memory[loc] = 0;
+    }
+}
+/*void Optimizer::RemoveDeadCode(int a_memory[], const FlowGraph& a_graph); */
@@ -0,0 +1,56 @@
+//
+//        Optimizer - rewrites the memory image of an assembled Quack3200
+//        program so that it runs with fewer instructions. The rewrites
+//        keep every location the program reads or writes as data, and
+//        every instruction, at its location.
+//
+
+#ifndef _OPTIMIZER_H
+#define _OPTIMIZER_H
+
+#include "stdafx.h"
+
+class Optimizer
+{
+
+public:
+
+    // Rewrites the program in a memory image, returns the number of words changed
+    static int Optimize(int []);
+
+
+private:
+
+    // A sequence of instructions entered at its first and left at its last
+    struct BasicBlock
+    {
+        int m_first;                        // The location of its first instruction
+        int m_last;                         // The location of its last instruction
+    };
+
+    // The control-flow graph of the program
+    struct FlowGraph
+    {
+        vector<BasicBlock> m_blocks;        // The blocks, by location
+        vector<bool> m_code;                // == true for the locations that can be executed
+        vector<bool> m_leader;              // == true for the locations starting a block
+        vector<bool> m_data;                // == true for the locations read or written as data
+        int m_lastCode;                     // The last location that can be executed
+        bool m_dynamic;                     // == true if some locations are only known when the program runs
+        bool m_selfModifying;               // == true if the program writes its own code
+    };
+
+    // Builds the control-flow graph of the program starting at location 100
+    static void BuildGraph(const int [], FlowGraph&);
+
+    // Makes the branches to B go directly where the B goes
+    static void ThreadJumps(int [], const FlowGraph&);
+
+    // Removes the LOAD of a value the register already holds
+    static void RemoveRedundantLoads(int [], const FlowGraph&);
+
+    // Clears the locations the program neither executes nor uses as data
+    static void RemoveDeadCode(int [], const FlowGraph&);
+};
+
+#endif
@@ -0,0 +1,400 @@
+//
+//  Implementation of the source scanner class.
+//
+//  The scan runs in two steps. The first step classifies the buffer 64
+//  bytes at a time with vector compares, producing one bitmap per class
+//  of character (newline, semicolon, comma, space, white space). The
+//  second step walks the bitmaps line by line with bit operations to
+//  find the comment, count commas and words and record token offsets.
+//
+
+#include "stdafx.h"
+#include <bitset>
+#include <cstdint>
+
+// QUACK_SCAN_SCALAR forces the portable scan, QUACK_SCAN_SSE2 the SSE2 scan
+#if defined(QUACK_SCAN_SCALAR)
+#define QUACK_SCAN_NONE
+#elif defined(__AVX2__) && !defined(QUACK_SCAN_SSE2)
+#include <immintrin.h>
+#define QUACK_SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#ifndef QUACK_SCAN_SSE2
+#define QUACK_SCAN_SSE2
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+
+// The classes of characters, one bitmap each
+enum CharClass
+{
+    CC_Newline,                 // '\n'
+    CC_Semicolon,               // ';'
+    CC_Comma,                   // ','
+    CC_Space,                   // ' '
+    CC_White,                   // ' ', '\t', '\n', '\v', '\f', '\r' (isspace in the C locale)
+    NUM_CLASSES
+};
+
+// Index of the lowest set bit of a non-zero word
+inline unsigned LowestBit(const uint64_t& a_bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, a_bits);
+    return index;
+#else
+    return __builtin_ctzll(a_bits);
+#endif
+}
+
+// Number of set bits in a word
+inline unsigned CountBits(const uint64_t& a_bits)
+{
+    return (unsigned)bitset<64>(a_bits).count();
+}
+
+// Bits a_from to 63 of a word
+inline uint64_t FromBit(const size_t& a_from)
+{
+    return ~0ULL << (a_from & 63);
+}
+
+/*
+NAME
+
+    ClassifyBlock - Classifies 64 bytes of source
+
+SYNOPSIS
+
+    void ClassifyBlock(const char *a_block, uint64_t a_masks[]);
+
+DESCRIPTION
+
+    This function sets bit i of "a_masks[c]" when byte i of "a_block"
+    belongs to the character class c. The block must hold 64 bytes.
+*/
+
+#if defined(QUACK_SCAN_AVX2)
+
+void ClassifyBlock(const char *a_block, uint64_t a_masks[])
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i semicolon = _mm256_set1_epi8(';');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i controlRange = _mm256_set1_epi8('\r' - '\t');
+
+    for (int half = 0; half < 2; half++)
+    {
+        __m256i chars = _mm256_loadu_si256((const __m256i *)(a_block + 32 * half));
+
+        // '\t' to '\r' are the other white space characters
+        __m256i offset = _mm256_sub_epi8(chars, tab);
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, controlRange), offset);
+        __m256i isSpace = _mm256_cmpeq_epi8(chars, space);
+
+        int shift = 32 * half;
+        a_masks[CC_Newline] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newline)) << shift;
+        a_masks[CC_Semicolon] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, semicolon)) << shift;
+        a_masks[CC_Comma] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, comma)) << shift;
+        a_masks[CC_Space] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(isSpace) << shift;
+        a_masks[CC_White] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(isSpace, control)) << shift;
+    }
+}
+
+#elif defined(QUACK_SCAN_SSE2) && !defined(QUACK_SCAN_NONE)
+
+void ClassifyBlock(const char *a_block, uint64_t a_masks[])
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i controlRange = _mm_set1_epi8('\r' - '\t');
+
+    for (int quarter = 0; quarter < 4; quarter++)
+    {
+        __m128i chars = _mm_loadu_si128((const __m128i *)(a_block + 16 * quarter));
+
+        // '\t' to '\r' are the other white space characters
+        __m128i offset = _mm_sub_epi8(chars, tab);
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(offset, controlRange), offset);
+        __m128i isSpace = _mm_cmpeq_epi8(chars, space);
+
+        int shift = 16 * quarter;
+        a_masks[CC_Newline] |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newline)) << shift;
+        a_masks[CC_Semicolon] |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, semicolon)) << shift;
+        a_masks[CC_Comma] |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, comma)) << shift;
+        a_masks[CC_Space] |= (uint64_t)_mm_movemask_epi8(isSpace) << shift;
+        a_masks[CC_White] |= (uint64_t)_mm_movemask_epi8(_mm_or_si128(isSpace, control)) << shift;
+    }
+}
+
+#else
+
+void ClassifyBlock(const char *a_block, uint64_t a_masks[])
+{
+    for (int i = 0; i < 64; i++)
+    {
+        char ch = a_block[i];
+        uint64_t bit = 1ULL << i;
+
+        if (ch == '\n')
+            a_masks[CC_Newline] |= bit;
+
+        if (ch == ';')
+            a_masks[CC_Semicolon] |= bit;
+
+        if (ch == ',')
+            a_masks[CC_Comma] |= bit;
+
+        if (ch == ' ')
+            a_masks[CC_Space] |= bit;
+
+        if (ch == ' ' || (ch >= '\t' && ch <= '\r'))
+            a_masks[CC_White] |= bit;
+    }
+}
+
+#endif
+/*void ClassifyBlock(const char *a_block, uint64_t a_masks[]); */
+
+
+// The bitmaps of a whole buffer, NUM_CLASSES words per 64 bytes
+class Bitmaps
+{
+
+public:
+
+    Bitmaps(const char *a_data, const size_t& a_size):
+    m_words((a_size + 63) / 64), m_bits(m_words * NUM_CLASSES, 0)
+    {
+        size_t full = a_size / 64;
+
+        for (size_t w = 0; w < full; w++)
+            ClassifyBlock(a_data + 64 * w, &m_bits[w * NUM_CLASSES]);
+
+        // the last partial block is padded with bytes that belong to no class
+        if (full < m_words)
+        {
+            char tail[64] = {0};
+            memcpy(tail, a_data + 64 * full, a_size - 64 * full);
+            ClassifyBlock(tail, &m_bits[full * NUM_CLASSES]);
+        }
+    }
+
+    // Word "a_word" of the bitmap of class "a_class"
+    uint64_t Get(const CharClass& a_class, const size_t& a_word) const
+    {
+        return m_bits[a_word * NUM_CLASSES + a_class];
+    }
+
+    // Separators of the tokens read by stringstream once commas become spaces
+    uint64_t TokenSeparators(const size_t& a_word) const
+    {
+        return Get(CC_White, a_word) | Get(CC_Comma, a_word);
+    }
+
+    // Separators of the words counted by WordsToReadFinder once commas become spaces
+    uint64_t WordSeparators(const size_t& a_word) const
+    {
+        return Get(CC_Space, a_word) | Get(CC_Comma, a_word);
+    }
+
+    // Position of the first bit set by "a_word" in [a_from, a_to), a_to if none
+    template <class WordOf>
+    size_t FirstSet(WordOf a_wordOf, size_t a_from, const size_t& a_to) const
+    {
+        while (a_from < a_to)
+        {
+            size_t w = a_from / 64;
+            uint64_t bits = a_wordOf(w) & FromBit(a_from);
+
+            if (bits != 0)
+            {
+                size_t pos = w * 64 + LowestBit(bits);
+                return pos < a_to ? pos : a_to;
+            }
+
+            a_from = (w + 1) * 64;
+        }
+
+        return a_to;
+    }
+
+    // Number of bits set by "a_word" in [a_from, a_to)
+    template <class WordOf>
+    int CountSet(WordOf a_wordOf, const size_t& a_from, const size_t& a_to) const
+    {
+        int count = 0;
+
+        for (size_t pos = a_from; pos < a_to; pos = (pos / 64 + 1) * 64)
+        {
+            size_t w = pos / 64;
+            uint64_t bits = a_wordOf(w) & FromBit(pos);
+
+            // drop the bits at and after a_to
+            if (a_to < (w + 1) * 64)
+                bits &= ~FromBit(a_to);
+
+            count += CountBits(bits);
+        }
+
+        return count;
+    }
+
+private:
+
+    size_t m_words;             // Number of 64-byte blocks
+    vector<uint64_t> m_bits;    // The interleaved bitmaps
+};
+
+/*
+NAME
+
+    ClassifyLine - Classifies one line using the bitmaps
+
+SYNOPSIS
+
+    void ClassifyLine(const Bitmaps& a_maps, const size_t& a_begin,
+                      const size_t& a_end, LineScan& a_scan);
+
+DESCRIPTION
+
+    This function fills "a_scan" for the line that occupies
+    [a_begin, a_end) of the buffer. Everything after the first ';'
+    is ignored, as Instruction::ParseInstruction does. The word count
+    follows Instruction::WordsToReadFinder, which only treats ' ' (and
+    commas, once replaced) as a separator. The tokens follow stringstream
+    extraction, which treats all white space and commas as separators.
+*/
+
+void ClassifyLine(const Bitmaps& a_maps, const size_t& a_begin, const size_t& a_end, LineScan& a_scan)
+{
+    auto semicolons = [&](size_t w) { return a_maps.Get(CC_Semicolon, w); };
+    auto commas = [&](size_t w) { return a_maps.Get(CC_Comma, w); };
+    auto nonWhite = [&](size_t w) { return ~a_maps.Get(CC_White, w); };
+    auto tokenSeps = [&](size_t w) { return a_maps.TokenSeparators(w); };
+    auto tokenChars = [&](size_t w) { return ~a_maps.TokenSeparators(w); };
+
+    // a separator run starts where a separator follows a non-separator
+    auto wordRunStarts = [&](size_t w)
+    {
+        uint64_t seps = a_maps.WordSeparators(w);
+        uint64_t previous = w > 0 ? a_maps.WordSeparators(w - 1) >> 63 : 1;
+        return seps & ~((seps << 1) | previous);
+    };
+
+    size_t cut = a_maps.FirstSet(semicolons, a_begin, a_end);
+
+    a_scan.m_begin = a_begin;
+    a_scan.m_size = a_end - a_begin;
+    a_scan.m_cut = cut - a_begin;
+    a_scan.m_commas = a_maps.CountSet(commas, a_begin, cut);
+    a_scan.m_blank = a_maps.FirstSet(nonWhite, a_begin, cut) == cut;
+    a_scan.m_words = 0;
+    a_scan.m_tokens = 0;
+
+    if (a_scan.m_blank)
+        return;
+
+    // words end where a separator run starts, and the last one may end the line
+    a_scan.m_words = a_maps.CountSet(wordRunStarts, a_begin + 1, cut);
+    if (!(a_maps.WordSeparators((cut - 1) / 64) >> ((cut - 1) % 64) & 1))
+        a_scan.m_words++;
+
+    size_t pos = a_begin;
+    while (a_scan.m_tokens < LineScan::MAXTOKENS)
+    {
+        size_t start = a_maps.FirstSet(tokenChars, pos, cut);
+        if (start == cut)
+            break;
+
+        pos = a_maps.FirstSet(tokenSeps, start, cut);
+        a_scan.m_tokBegin[a_scan.m_tokens] = (unsigned)(start - a_begin);
+        a_scan.m_tokSize[a_scan.m_tokens] = (unsigned)(pos - start);
+        a_scan.m_tokens++;
+    }
+}
+/*void ClassifyLine(const Bitmaps& a_maps, const size_t& a_begin,
+                    const size_t& a_end, LineScan& a_scan); */
+
+}
+
+/*
+NAME
+
+    Scan - Classifies every line of a buffer
+
+SYNOPSIS
+
+    void Scan(const char *a_data, const size_t& a_size, vector<LineScan>& a_lines);
+
+DESCRIPTION
+
+    This function replaces "a_lines" with one entry per line of the
+    "a_size" bytes at "a_data". Lines are separated by '\n' and, as with
+    getline(), a buffer that ends with a newline (or is empty) has a
+    final empty line.
+*/
+
+void SourceScanner::Scan(const char *a_data, const size_t& a_size, vector<LineScan>& a_lines)
+{
+    Bitmaps maps(a_data, a_size);
+    auto newlines = [&](size_t w) { return maps.Get(CC_Newline, w); };
+
+    a_lines.clear();
+    a_lines.reserve(maps.CountSet(newlines, 0, a_size) + 1);
+
+    size_t begin = 0;
+    for ( ; ; )
+    {
+        size_t end = maps.FirstSet(newlines, begin, a_size);
+
+        a_lines.emplace_back();
+        ClassifyLine(maps, begin, end, a_lines.back());
+
+        if (end == a_size)
+            return;
+
+        begin = end + 1;
+    }
+}
+/*void SourceScanner::Scan(const char *a_data, const size_t& a_size, vector<LineScan>& a_lines); */
+
+
+/*
+NAME
+
+    Implementation - The instruction set used for the scan
+
+SYNOPSIS
+
+    const char *Implementation();
+
+DESCRIPTION
+
+    Returns - "avx2", "sse2" or "scalar", as selected at compile time
+*/
+
+const char *SourceScanner::Implementation()
+{
+#if defined(QUACK_SCAN_AVX2)
+    return "avx2";
+#elif defined(QUACK_SCAN_SSE2) && !defined(QUACK_SCAN_NONE)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+/*const char *SourceScanner::Implementation(); */
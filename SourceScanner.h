@@ -0,0 +1,42 @@
+//
+//        Source scanner - classifies every line of a source buffer in one
+//        vectorised pass (AVX2 or SSE2 where available, scalar otherwise),
+//        finding newlines, semicolons, commas and white space boundaries
+//        so that the parser does not have to scan each line again.
+//
+
+#ifndef _SOURCESCANNER_H
+#define _SOURCESCANNER_H
+
+#include "stdafx.h"
+
+// The classification of one source line
+struct LineScan
+{
+    // The most tokens recorded for a line, as many as ParseInstruction reads
+    const static int MAXTOKENS = 4;
+
+    size_t m_begin;                     // Offset of the line in the buffer
+    size_t m_size;                      // Length of the line without the newline
+    size_t m_cut;                       // Offset in the line of the first ';' (m_size if none)
+    int m_commas;                       // Number of commas before the comment
+    bool m_blank;                       // == true if there is only white space before the comment
+    int m_words;                        // Number of words as counted by Instruction::WordsToReadFinder
+    int m_tokens;                       // Number of tokens recorded (at most MAXTOKENS)
+    unsigned m_tokBegin[MAXTOKENS];     // Offset in the line of each token
+    unsigned m_tokSize[MAXTOKENS];      // Length of each token
+};
+
+class SourceScanner
+{
+
+public:
+
+    // Classifies every line of a buffer
+    static void Scan(const char *, const size_t&, vector<LineScan>&);
+
+    // The instruction set used for the scan ("avx2", "sse2" or "scalar")
+    static const char *Implementation();
+};
+
+#endif
@@ -83,6 +83,35 @@ void SymbolTable::DisplaySymbolTable() const
 /*void SymbolTable::DisplaySymbolTable() const; */
 
 
+/*
+NAME
+ 
+    RecordSymbolErrors - Records the errors of the symbol table
+
+SYNOPSIS
+ 
+    void RecordSymbolErrors() const;
+
+DESCRIPTION
+ 
+    This function records the same errors as DisplaySymbolTable()
+    (multiply defined labels) without any output.
+*/
+
+void SymbolTable::RecordSymbolErrors() const
+{
+    for(auto element : m_symbolTable)
+    {
+        if (element.second == multiplyDefinedSymbol)
+        {
+            //Code 9: Multiply Defined Label
+            Errors::RecordError(9, element.first);
+        }
+    }
+}
+/*void SymbolTable::RecordSymbolErrors() const; */
+
+
 /*
 NAME
  
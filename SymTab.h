@@ -17,9 +17,16 @@ public:
     // Display the symbol table
     void DisplaySymbolTable() const;
 
+    // Record the errors of the symbol table without displaying it
+    void RecordSymbolErrors() const;
+
     // Lookup a symbol in the symbol table
     bool LookupSymbol(const string&, int&) const;
 
+    // Get or replace every symbol and its location
+    const map<string, int>& GetSymbols() const {return m_symbolTable;}
+    void SetSymbols(const map<string, int>& a_symbols) {m_symbolTable = a_symbols;}
+
 private:
     
     // This is the actual symbol table.
@@ -0,0 +1,704 @@
+//
+//  Implementation of the toolchain class.
+//
+
+#include "stdafx.h"
+#include "Assembler.h"
+#include "Toolchain.h"
+#include "LaneEmulator.h"
+
+namespace
+{
+
+// The input and output of a program given by two callbacks
+class CallbackIO : public EmulatorIO
+{
+
+public:
+
+    CallbackIO(const function<bool(string&)>& a_read, const function<void(int)>& a_write):
+    m_read(a_read), m_write(a_write) {}
+
+    bool Read(string& a_input)
+    {
+        return m_read ? m_read(a_input) : false;
+    }
+
+    void Write(const int& a_value)
+    {
+        if (m_write)
+            m_write(a_value);
+    }
+
+private:
+
+    const function<bool(string&)>& m_read;
+    const function<void(int)>& m_write;
+};
+
+// Records whether the program halted for another input and output
+class HaltObserver : public EmulatorIO
+{
+
+public:
+
+    HaltObserver(EmulatorIO& a_io): m_io(a_io), m_halted(false) {}
+
+    void Begin() {m_io.Begin();}
+    bool Ready() {return m_io.Ready();}
+    bool Read(string& a_input) {return m_io.Read(a_input);}
+    void Write(const int& a_value) {m_io.Write(a_value);}
+    bool ReadWords(string& a_input, const int& a_count) {return m_io.ReadWords(a_input, a_count);}
+    void WriteWords(const int a_values[], const int& a_count) {m_io.WriteWords(a_values, a_count);}
+    void Halt() {m_halted = true; m_io.Halt();}
+
+    bool Halted() const {return m_halted;}
+
+private:
+
+    EmulatorIO& m_io;
+    bool m_halted;
+};
+
+}
+
+
+ParsedSource::ParsedSource() {}
+ParsedSource::~ParsedSource() {}
+
+
+/*
+NAME
+
+    Assemble - Assembles a source held in memory
+
+SYNOPSIS
+
+    static AssemblyResult Assemble(const char *a_data, const size_t& a_size);
+
+DESCRIPTION
+
+    This function runs Pass I and Pass II on the "a_size" bytes of source
+    at "a_data", exactly as the Assem program does but without a listing,
+    and returns the memory image, the symbol table and every error found
+    (including the multiply defined labels that Assem reports when it
+    displays the symbol table). The image can only be run if the result
+    has no errors.
+*/
+
+AssemblyResult Toolchain::Assemble(const char *a_data, const size_t& a_size)
+{
+    unique_ptr<ParsedSource> source = Parse(a_data, a_size);
+
+    return Translate(*source);
+}
+/*AssemblyResult Toolchain::Assemble(const char *a_data, const size_t& a_size); */
+
+
+/*
+NAME
+
+    Parse - Runs Pass I on a source held in memory
+
+SYNOPSIS
+
+    static unique_ptr<ParsedSource> Parse(const char *a_data, const size_t& a_size);
+
+DESCRIPTION
+
+    This function runs the first half of Assemble(): Pass I and the check
+    of the symbol table. The errors found so far are kept in the returned
+    source rather than in the thread, so that Translate() may be called
+    on another thread, as the stages of a pipeline do.
+*/
+
+unique_ptr<ParsedSource> Toolchain::Parse(const char *a_data, const size_t& a_size)
+{
+    unique_ptr<ParsedSource> source(new ParsedSource);
+
+    // the errors of this source only
+    Errors::Scope scope;
+
+    // the assembler holds the whole emulator memory
+    source->m_assem.reset(new Assembler(a_data, a_size));
+
+    source->m_assem->PassI();
+    source->m_assem->CheckSymbolTable();
+
+    source->m_errorMsgs = Errors::GetErrorMessages();
+    source->m_errorCodes = Errors::GetErrorCodes();
+
+    return source;
+}
+/*unique_ptr<ParsedSource> Toolchain::Parse(const char *a_data, const size_t& a_size); */
+
+
+/*
+NAME
+
+    Translate - Runs Pass II on a source parsed by Parse()
+
+SYNOPSIS
+
+    static AssemblyResult Translate(ParsedSource& a_source);
+
+DESCRIPTION
+
+    This function finishes assembling "a_source" and returns the same
+    results as Assemble(). The errors of Pass I come first in the list of
+    diagnostics. The assembler of "a_source" is released, so it may only
+    be translated once.
+*/
+
+AssemblyResult Toolchain::Translate(ParsedSource& a_source)
+{
+    AssemblyResult result;
+
+    // the errors of this source only, starting with those of Pass I
+    Errors::Scope scope;
+    Errors::SetErrorMessages(a_source.m_errorMsgs, a_source.m_errorCodes);
+
+    unique_ptr<Assembler> assem = move(a_source.m_assem);
+
+    assem->PassII();
+
+    result.m_image.assign(assem->GetImage(), assem->GetImage() + Emulator::MEMSZ);
+    result.m_symbols = assem->GetSymbols();
+
+    CollectDiagnostics(result.m_diagnostics);
+    result.m_success = result.m_diagnostics.empty();
+
+    return result;
+}
+/*AssemblyResult Toolchain::Translate(ParsedSource& a_source); */
+
+
+/*
+NAME
+
+    AssembleModule - Assembles a source held in memory as an object module
+
+SYNOPSIS
+
+    static ModuleResult AssembleModule(const char *a_data, const size_t& a_size);
+
+DESCRIPTION
+
+    This function assembles the "a_size" bytes of source at "a_data" as
+    Assemble() does, but in object mode (see Assembler::SetObjectMode()):
+    the source may import symbols with IMPORT, export them with EXPORT and
+    be a library without the HALT instruction. The result can only be
+    linked if it has no errors.
+*/
+
+ModuleResult Toolchain::AssembleModule(const char *a_data, const size_t& a_size)
+{
+    ModuleResult result;
+
+    // the errors of this source only
+    Errors::Scope scope;
+
+    // the assembler holds the whole emulator memory
+    unique_ptr<Assembler> assem(new Assembler(a_data, a_size));
+
+    assem->SetObjectMode(true);
+    assem->PassI();
+    assem->CheckSymbolTable();
+    assem->PassII();
+
+    result.m_module = assem->GetObjectModule();
+
+    CollectDiagnostics(result.m_diagnostics);
+    result.m_success = result.m_diagnostics.empty();
+
+    return result;
+}
+/*ModuleResult Toolchain::AssembleModule(const char *a_data, const size_t& a_size); */
+
+
+/*
+NAME
+
+    Link - Links object modules into one image
+
+SYNOPSIS
+
+    static AssemblyResult Link(const vector<ObjectModule>& a_modules);
+
+DESCRIPTION
+
+    This function places "a_modules" in memory and resolves the symbols
+    they import from each other (see Linker::Link()). The symbol table of
+    the result holds the exported symbols at their final locations. The
+    image can only be run if the result has no errors.
+*/
+
+AssemblyResult Toolchain::Link(const vector<ObjectModule>& a_modules)
+{
+    AssemblyResult result;
+
+    // the errors of these modules only
+    Errors::Scope scope;
+
+    Linker::Link(a_modules, result.m_image, result.m_symbols);
+
+    CollectDiagnostics(result.m_diagnostics);
+    result.m_success = result.m_diagnostics.empty();
+
+    return result;
+}
+/*AssemblyResult Toolchain::Link(const vector<ObjectModule>& a_modules); */
+
+
+/*
+NAME
+
+    Run - Runs an image with the caller's input and output
+
+SYNOPSIS
+
+    static RunResult Run(const vector<int>& a_image, EmulatorIO& a_io);
+
+DESCRIPTION
+
+    This function loads "a_image" (as returned by Assemble()) into a new
+    emulator and runs it from location 100 until HALT or the first
+    run-time error. READ instructions get their input from "a_io" (a READ
+    without input is run-time error 31) and WRITE instructions give it
+    their values.
+*/
+
+RunResult Toolchain::Run(const vector<int>& a_image, EmulatorIO& a_io)
+{
+    unique_ptr<Emulator> emul(new Emulator);
+
+    return Run(*emul, a_image, a_io);
+}
+/*RunResult Toolchain::Run(const vector<int>& a_image, EmulatorIO& a_io); */
+
+
+/*
+NAME
+
+    Run - Runs an image in an emulator kept by the caller
+
+SYNOPSIS
+
+    static RunResult Run(Emulator& a_emul, const vector<int>& a_image, EmulatorIO& a_io);
+
+DESCRIPTION
+
+    This function runs "a_image" like Run(a_image, a_io) but in "a_emul",
+    whose memory and registers are replaced by the image. A program that
+    runs many images keeps one emulator per thread, so that its memory is
+    allocated and paged in once rather than for every run. "a_emul" may
+    not be used by another thread at the same time. The channels connected
+    to its ports are waited for, backing off while they are not ready,
+    until the program halts or stops; a READ whose input "a_io" does not
+    have ready leaves the program suspended, as it does not wait for it.
+*/
+
+RunResult Toolchain::Run(Emulator& a_emul, const vector<int>& a_image, EmulatorIO& a_io)
+{
+    RunResult result;
+
+    // the errors of this run only
+    Errors::Scope scope;
+
+    if (a_image.size() == (size_t)Emulator::MEMSZ)
+        a_emul.LoadImage(a_image.data());
+
+    else
+    {
+        // a shorter image leaves the rest of memory cleared
+        vector<int> image(a_image);
+        image.resize(Emulator::MEMSZ, 0);
+        a_emul.LoadImage(image.data());
+    }
+
+    HaltObserver io(a_io);
+    a_emul.SetIO(&io);
+    a_emul.RunProgram();
+
+    // a SEND or RECV waits for the program at the other end of its channel
+    a_emul.AwaitChannels();
+
+    a_emul.SetIO(nullptr);
+
+    result.m_halted = io.Halted();
+    result.m_instructions = a_emul.GetInstructionCount();
+    CollectDiagnostics(result.m_diagnostics);
+
+    return result;
+}
+/*RunResult Toolchain::Run(Emulator& a_emul, const vector<int>& a_image, EmulatorIO& a_io); */
+
+
+/*
+NAME
+
+    RunLanes - Runs an image once for each of several inputs and outputs
+
+SYNOPSIS
+
+    static vector<RunResult> RunLanes(const vector<int>& a_image, const vector<EmulatorIO *>& a_ios);
+
+DESCRIPTION
+
+    This function runs "a_image" once for each element of "a_ios", with
+    the same results as calling Run(a_image, *a_ios[i]) for each of them,
+    but LaneEmulator::LANES runs at a time in the lanes of a lane emulator.
+    It pays off when the runs mostly follow the same path through the
+    program. A READ without input is run-time error 31; the runs are not
+    suspended (see EmulatorIO::Ready). An image holding FORK, JOIN, FADD,
+    SEND or RECV runs once at a time in an emulator, which runs the threads
+    and has the ports.
+
+    Returns the results of each run, in the order of "a_ios"
+*/
+
+vector<RunResult> Toolchain::RunLanes(const vector<int>& a_image, const vector<EmulatorIO *>& a_ios)
+{
+    vector<RunResult> results(a_ios.size());
+
+    vector<int> image(a_image);
+    image.resize(Emulator::MEMSZ, 0);
+
+    // a constant that looks like one of them costs only the speed of the lanes
+    bool emulated = any_of(image.begin(), image.end(), [](const int& a_word)
+    {
+        return Quack3200::Opcode(a_word) >= Emulator::FORK && Quack3200::Opcode(a_word) <= Emulator::CHANNEL;
+    });
+
+    if (emulated)
+    {
+        unique_ptr<Emulator> emul(new Emulator);
+
+        for (size_t i = 0; i < a_ios.size(); i++)
+            results[i] = Run(*emul, image, *a_ios[i]);
+
+        return results;
+    }
+
+    // holds the memory of every lane
+    unique_ptr<LaneEmulator> lanes(new LaneEmulator);
+
+    for (size_t first = 0; first < a_ios.size(); first += LaneEmulator::LANES)
+    {
+        int count = (int)min(a_ios.size() - first, (size_t)LaneEmulator::LANES);
+
+        lanes->LoadImage(image.data());
+        lanes->RunProgram(&a_ios[first], count);
+
+        for (int lane = 0; lane < count; lane++)
+        {
+            RunResult& result = results[first + lane];
+
+            result.m_halted = lanes->Halted(lane);
+            result.m_instructions = lanes->GetInstructionCount(lane);
+
+            int errorCode = lanes->GetErrorCode(lane);
+            if (errorCode >= 0)
+                result.m_diagnostics.push_back({errorCode, lanes->GetErrorStatement(lane), Errors::GetErrorMessage(errorCode)});
+        }
+    }
+
+    return results;
+}
+/*vector<RunResult> Toolchain::RunLanes(const vector<int>& a_image, const vector<EmulatorIO *>& a_ios); */
+
+
+/*
+NAME
+
+    RunPipeline - Runs images as the stages of a pipeline
+
+SYNOPSIS
+
+    static vector<RunResult> RunPipeline(const vector<vector<int>>& a_images,
+                                         const vector<EmulatorIO *>& a_ios);
+
+DESCRIPTION
+
+    This function runs each of "a_images" like Run(a_images[i], *a_ios[i]),
+    all at the same time, each on a thread of its own. Port 0 of SEND of
+    each stage is connected by a channel to port 0 of RECV of the next, so
+    that the words a stage sends are received by the next while it is
+    still running. A stage that halts or stops closes its channels, ending
+    the stages that wait for it.
+
+    Returns the results of each stage, in the order of "a_images"
+*/
+
+vector<RunResult> Toolchain::RunPipeline(const vector<vector<int>>& a_images, const vector<EmulatorIO *>& a_ios)
+{
+    size_t stages = min(a_images.size(), a_ios.size());
+    vector<RunResult> results(stages);
+    vector<unique_ptr<Emulator>> emuls;
+    vector<unique_ptr<Channel>> channels;
+
+    for (size_t stage = 0; stage < stages; stage++)
+    {
+        emuls.emplace_back(new Emulator);
+
+        if (stage == 0)
+            continue;
+
+        channels.emplace_back(new Channel);
+        emuls[stage - 1]->ConnectSend(0, channels.back().get());
+        emuls[stage]->ConnectReceive(0, channels.back().get());
+    }
+
+    vector<thread> threads;
+
+    for (size_t stage = 0; stage < stages; stage++)
+    {
+        threads.emplace_back([&, stage]()
+        {
+            results[stage] = Run(*emuls[stage], a_images[stage], *a_ios[stage]);
+        });
+    }
+
+    for (thread& stageThread : threads)
+        stageThread.join();
+
+    return results;
+}
+/*vector<RunResult> Toolchain::RunPipeline(const vector<vector<int>>& a_images,
+  const vector<EmulatorIO *>& a_ios); */
+
+
+/*
+NAME
+
+    Run - Runs an image with callbacks for the READ and WRITE instructions
+
+SYNOPSIS
+
+    static RunResult Run(const vector<int>& a_image, const function<bool(string&)>& a_read,
+                         const function<void(int)>& a_write);
+
+DESCRIPTION
+
+    This function runs "a_image" like Run(a_image, a_io). "a_read" places
+    the input of each READ instruction in its argument and returns false
+    when there is no more input. "a_write" receives the value of each
+    WRITE instruction.
+*/
+
+RunResult Toolchain::Run(const vector<int>& a_image, const function<bool(string&)>& a_read,
+                         const function<void(int)>& a_write)
+{
+    CallbackIO io(a_read, a_write);
+
+    return Run(a_image, io);
+}
+/*RunResult Toolchain::Run(const vector<int>& a_image, const function<bool(string&)>& a_read,
+  const function<void(int)>& a_write); */
+
+
+/*
+NAME
+
+    CollectDiagnostics - Moves the recorded errors to a list of diagnostics
+
+SYNOPSIS
+
+    static void CollectDiagnostics(vector<Diagnostic>& a_diagnostics);
+
+DESCRIPTION
+
+    This function appends the errors recorded in the current error scope
+    to "a_diagnostics" and clears them.
+*/
+
+void Toolchain::CollectDiagnostics(vector<Diagnostic>& a_diagnostics)
+{
+    const vector<string>& messages = Errors::GetErrorMessages();
+    const vector<int>& codes = Errors::GetErrorCodes();
+
+    for (size_t i = 0; i < codes.size(); i++)
+        a_diagnostics.push_back({codes[i], messages[2 * i], messages[2 * i + 1]});
+
+    Errors::InitErrorReporting();
+}
+/*void Toolchain::CollectDiagnostics(vector<Diagnostic>& a_diagnostics); */
+
+
+// The input given to Session::Resume() and the values written since the last TakeOutput()
+class Session::SessionIO : public EmulatorIO
+{
+
+public:
+
+    SessionIO(): m_hasInput(false), m_halted(false) {}
+
+    bool Ready() {return m_hasInput;}
+
+    bool Read(string& a_input)
+    {
+        if (!m_hasInput)
+            return false;
+
+        a_input = move(m_input);
+        m_hasInput = false;
+
+        return true;
+    }
+
+    void Write(const int& a_value) {m_output.push_back(a_value);}
+    void Halt() {m_halted = true;}
+
+    void Give(const string& a_input)
+    {
+        m_input = a_input;
+        m_hasInput = true;
+    }
+
+    bool m_hasInput;                        // == true until the input is read
+    string m_input;                         // The input of the next READ
+    vector<int> m_output;                   // The values written since the last TakeOutput()
+    bool m_halted;                          // == true once HALT was executed
+};
+
+
+/*
+NAME
+
+    Session - Prepares a program to run one input at a time
+
+SYNOPSIS
+
+    Session(const vector<int>& a_image);
+
+DESCRIPTION
+
+    This constructor loads "a_image" into an emulator of its own, which
+    keeps the program while it waits for its input.
+*/
+
+Session::Session(const vector<int>& a_image): m_emul(new Emulator), m_io(new SessionIO), m_started(false)
+{
+    if (a_image.size() == (size_t)Emulator::MEMSZ)
+        m_emul->LoadImage(a_image.data());
+
+    else
+    {
+        // a shorter image leaves the rest of memory cleared
+        vector<int> image(a_image);
+        image.resize(Emulator::MEMSZ, 0);
+        m_emul->LoadImage(image.data());
+    }
+
+    m_emul->SetIO(m_io.get());
+
+    m_result.m_halted = false;
+    m_result.m_instructions = 0;
+}
+
+
+Session::~Session() {}
+
+
+/*
+NAME
+
+    Start - Runs the program until it halts, stops or waits for input
+
+SYNOPSIS
+
+    void Start();
+
+DESCRIPTION
+
+    This function runs the program from location 100. It returns when the
+    program executes HALT, records a run-time error or reaches a READ
+    instruction, in which case NeedsInput() is true until Resume() gives
+    it the input. A session is started once.
+*/
+
+void Session::Start()
+{
+    if (m_started)
+        return;
+
+    m_started = true;
+
+    // the errors of this program only
+    Errors::Scope scope;
+
+    m_emul->RunProgram();
+    Suspend();
+}
+/*void Session::Start(); */
+
+
+/*
+NAME
+
+    Resume - Gives the program its input and continues it
+
+SYNOPSIS
+
+    void Resume(const string& a_input);
+
+DESCRIPTION
+
+    This function continues the program waiting at a READ instruction
+    with "a_input" as the input of that READ (checked as a run-time input
+    is, see Emulator::InputChecker), until the program halts, stops or
+    waits for input again. It does nothing if the program is not waiting.
+*/
+
+void Session::Resume(const string& a_input)
+{
+    if (!NeedsInput())
+        return;
+
+    Errors::Scope scope;
+
+    m_io->Give(a_input);
+    m_emul->Resume();
+    Suspend();
+}
+/*void Session::Resume(const string& a_input); */
+
+
+bool Session::NeedsInput() const
+{
+    return m_emul->IsSuspended();
+}
+
+
+vector<int> Session::TakeOutput()
+{
+    vector<int> output;
+    output.swap(m_io->m_output);
+
+    return output;
+}
+
+
+/*
+NAME
+
+    Suspend - Records the state of the program after it ran
+
+SYNOPSIS
+
+    void Suspend();
+
+DESCRIPTION
+
+    This function records the results of the program so far, including the
+    run-time errors recorded in the current error scope.
+*/
+
+void Session::Suspend()
+{
+    m_result.m_halted = m_io->m_halted;
+    m_result.m_instructions = m_emul->GetInstructionCount();
+
+    Toolchain::CollectDiagnostics(m_result.m_diagnostics);
+}
+/*void Session::Suspend(); */
@@ -0,0 +1,181 @@
+//
+//        Toolchain - the assembler and the emulator as a library.
+//        Assembles sources held in memory and runs the resulting images
+//        with the caller's input and output. Nothing is written to the
+//        standard streams, the program is never terminated, and the
+//        errors of each call are kept apart so that calls may be made
+//        from several threads at once.
+//
+//        Build the library from the repository root, for example (the g++ command is one line):
+//
+//            g++ -O2 -std=c++17 -c Assembler.cpp Emulator.cpp Errors.cpp FileAccess.cpp
+//                Instruction.cpp SymTab.cpp Metrics.cpp ListingWriter.cpp SourceScanner.cpp
+//                AotTranslator.cpp AssemblyCache.cpp Optimizer.cpp Linker.cpp Channel.cpp LaneEmulator.cpp Toolchain.cpp
+//            ar rcs libquack.a *.o
+//
+//        and link programs with -lquack -ldl -lpthread.
+//
+
+#ifndef _TOOLCHAIN_H
+#define _TOOLCHAIN_H
+
+#include "stdafx.h"
+#include <functional>
+
+// One error found by the assembler or the emulator
+struct Diagnostic
+{
+    int m_code;                             // The error code (see Errors)
+    string m_statement;                     // The offending statement, register or input
+    string m_message;                       // The error message
+};
+
+// The results of assembling a source
+struct AssemblyResult
+{
+    bool m_success;                         // == true if there are no errors
+    vector<int> m_image;                    // The translation, one word per memory location
+    map<string, int> m_symbols;             // The symbol table (multiply defined symbols are -999)
+    vector<Diagnostic> m_diagnostics;       // The errors in the order they were found
+};
+
+// The results of assembling a source as an object module
+struct ModuleResult
+{
+    bool m_success;                         // == true if there are no errors
+    ObjectModule m_module;                  // The relocatable translation
+    vector<Diagnostic> m_diagnostics;       // The errors in the order they were found
+};
+
+// The results of running an image
+struct RunResult
+{
+    bool m_halted;                          // == true if the program executed HALT
+    long long m_instructions;               // Instructions dispatched
+    vector<Diagnostic> m_diagnostics;       // The run-time errors
+};
+
+class Assembler;
+
+// A source between Pass I and Pass II, made by Toolchain::Parse()
+class ParsedSource
+{
+
+public:
+
+    ~ParsedSource();
+
+private:
+
+    friend class Toolchain;
+
+    ParsedSource();
+    ParsedSource(const ParsedSource&) = delete;
+    ParsedSource& operator=(const ParsedSource&) = delete;
+
+    unique_ptr<Assembler> m_assem;          // The assembler, holding the symbol table
+    vector<string> m_errorMsgs;             // The errors of Pass I (see Errors)
+    vector<int> m_errorCodes;
+};
+
+class Toolchain
+{
+
+public:
+
+    // Assembles a source held in memory
+    static AssemblyResult Assemble(const char *, const size_t&);
+
+    static AssemblyResult Assemble(const string& a_source)
+    {
+        return Assemble(a_source.data(), a_source.size());
+    }
+
+    // Pass I of Assemble(), for callers that run the passes separately
+    static unique_ptr<ParsedSource> Parse(const char *, const size_t&);
+
+    // Pass II of Assemble(), on the thread of the caller's choice
+    static AssemblyResult Translate(ParsedSource&);
+
+    // Assembles a source held in memory as a relocatable object module
+    static ModuleResult AssembleModule(const char *, const size_t&);
+
+    // Links object modules into one image, with the exported symbols as its symbol table
+    static AssemblyResult Link(const vector<ObjectModule>&);
+
+    // Runs an image with the caller's input and output
+    static RunResult Run(const vector<int>&, EmulatorIO&);
+
+    // Runs an image in an emulator kept by the caller
+    static RunResult Run(Emulator&, const vector<int>&, EmulatorIO&);
+
+    // Runs an image once for each input and output, several runs at a time in lockstep
+    static vector<RunResult> RunLanes(const vector<int>&, const vector<EmulatorIO *>&);
+
+    // Runs images as the stages of a pipeline, each sending to the next over a channel
+    static vector<RunResult> RunPipeline(const vector<vector<int>>&, const vector<EmulatorIO *>&);
+
+    // Runs an image with callbacks for the READ and WRITE instructions
+    static RunResult Run(const vector<int>&, const function<bool(string&)>&, const function<void(int)>&);
+
+
+private:
+
+    friend class Session;
+
+    // Moves the errors recorded in the current scope to a list of diagnostics
+    static void CollectDiagnostics(vector<Diagnostic>&);
+};
+
+// A program that waits for its input without holding a thread: it is
+// suspended at each READ instruction whose input has not arrived, and
+// continued by any thread once it has (by one thread at a time)
+class Session
+{
+
+public:
+
+    // The program "a_image" (as returned by Toolchain::Assemble()), not yet started
+    Session(const vector<int>&);
+
+    ~Session();
+
+    // Runs the program until it halts, stops at a run-time error or waits for input
+    void Start();
+
+    // Stops the program with a run-time error once it has executed a number of instructions in all, 0 for no limit
+    void SetInstructionBudget(const long long& a_budget) {m_emul->SetInstructionBudget(a_budget);}
+
+    // Gives the program the input of the READ instruction it waits for and continues it
+    void Resume(const string&);
+
+    // Determines if the program waits for the input of a READ instruction
+    bool NeedsInput() const;
+
+    // Determines if the program halted or stopped at a run-time error
+    bool IsFinished() const {return m_started && !NeedsInput();}
+
+    // Returns the values written since the last call
+    vector<int> TakeOutput();
+
+    // The results of the program so far
+    const RunResult& GetResult() const {return m_result;}
+
+
+private:
+
+    class SessionIO;
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    // Records the state of the program after it ran
+    void Suspend();
+
+    unique_ptr<Emulator> m_emul;            // The emulator, holding the program
+    unique_ptr<SessionIO> m_io;             // The input and output of the program
+    RunResult m_result;                     // The results so far
+    bool m_started;                         // == true once Start() was called
+};
+
+#endif
@@ -0,0 +1,229 @@
+/*
+ * Assembler throughput benchmark.
+ *
+ * Generates large valid and invalid Quack3200 sources and times
+ * Instruction::ParseInstruction, the symbol table, Pass I and Pass II
+ * separately, with the listing output disabled. Results are reported
+ * in lines per second and bytes per second.
+ *
+ * Build from the repository root, for example:
+ *
+ *     g++ -O2 -std=c++17 -I. Assembler.cpp Emulator.cpp Errors.cpp FileAccess.cpp \
+ *         Instruction.cpp SymTab.cpp Metrics.cpp ListingWriter.cpp SourceScanner.cpp \
+ *         AotTranslator.cpp AssemblyCache.cpp Optimizer.cpp Linker.cpp Channel.cpp bench/SourceGenerator.cpp bench/AssemblerBench.cpp \
+ *         -o AssemblerBench -ldl -lpthread
+ *
+ * Usage: AssemblerBench [-emit FileName] [-invalid] [Instructions] [Repetitions]
+ *
+ * With -emit the generated source is written to FileName and nothing is timed.
+ */
+
+#include "../stdafx.h"
+#include "../Assembler.h"
+#include "SourceGenerator.h"
+#include <chrono>
+#include <filesystem>
+#include <memory>
+
+namespace
+{
+
+// The accumulated timings of one phase
+struct Phase
+{
+    Phase(const char *a_name): m_name(a_name), m_seconds(0) {}
+
+    const char *m_name;
+    double m_seconds;
+};
+
+// Seconds elapsed since "a_start"
+double Since(const chrono::steady_clock::time_point& a_start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - a_start).count();
+}
+
+// Splits the source into lines the same way FileAccess reads them
+vector<string> SplitLines(const string& a_src)
+{
+    vector<string> lines;
+    stringstream stream(a_src);
+    string line;
+
+    while (getline(stream, line))
+        lines.push_back(line);
+
+    return lines;
+}
+
+/*
+NAME
+
+    BenchSource - Times every phase of the assembler on one source
+
+SYNOPSIS
+
+    void BenchSource(const string& a_title, const string& a_src, const int& a_reps);
+
+DESCRIPTION
+
+    This function writes "a_src" to a temporary file and, "a_reps" times,
+    parses every line with a standalone Instruction object, replays the
+    labels and operands through a standalone SymbolTable and runs Pass I
+    and Pass II of a fresh Assembler with the listing disabled. The mean
+    throughput of each phase is printed under "a_title".
+*/
+
+void BenchSource(const string& a_title, const string& a_src, const int& a_reps)
+{
+    string path = (filesystem::temp_directory_path() / "quack_assembler_bench.qk").string();
+    ofstream(path, ios::out | ios::binary) << a_src;
+
+    vector<string> lines = SplitLines(a_src);
+
+    Phase parse("ParseInstruction");
+    Phase symbols("SymbolTable");
+    Phase passI("PassI");
+    Phase passII("PassII");
+
+    int errors = 0;
+
+    for (int rep = 0; rep < a_reps; rep++)
+    {
+        // labels (with their locations) and operands seen by the parser
+        vector<pair<string, int>> labels;
+        vector<string> operands;
+        labels.reserve(lines.size());
+        operands.reserve(lines.size());
+
+        Errors::InitErrorReporting();
+        Instruction inst;
+        auto start = chrono::steady_clock::now();
+
+        for (const string& line : lines)
+            inst.ParseInstruction(line);
+
+        parse.m_seconds += Since(start);
+
+        // collect the symbols outside of the timed loop
+        int loc = 0;
+        for (const string& line : lines)
+        {
+            Instruction::InstructionType st = inst.ParseInstruction(line);
+
+            if (st != Instruction::ST_MachineLanguage && st != Instruction::ST_AssemblerInstr)
+                continue;
+
+            if (inst.isLabel())
+                labels.push_back(make_pair(inst.GetLabel(), loc));
+
+            if (st == Instruction::ST_MachineLanguage && inst.GetOpcode() != "13")
+                operands.push_back(inst.GetOperand());
+
+            loc++;
+        }
+
+        SymbolTable symtab;
+        start = chrono::steady_clock::now();
+
+        for (auto& label : labels)
+            symtab.AddSymbol(label.first, label.second);
+
+        int found = 0;
+        for (const string& operand : operands)
+            found += symtab.LookupSymbol(operand, loc);
+
+        symbols.m_seconds += Since(start);
+
+        // the assembler holds the whole emulator memory
+        char program[] = "AssemblerBench";
+        char *argv[] = {program, &path[0], nullptr};
+        unique_ptr<Assembler> assem(new Assembler(2, argv));
+        assem->SetListing(false);
+
+        start = chrono::steady_clock::now();
+        assem->PassI();
+        passI.m_seconds += Since(start);
+
+        start = chrono::steady_clock::now();
+        assem->PassII();
+        passII.m_seconds += Since(start);
+
+        errors = Errors::NumErrors() / 2;
+        (void)found;
+    }
+
+    filesystem::remove(path);
+
+    cout<<a_title<<": "<<lines.size()<<" lines, "<<a_src.size()<<" bytes, "
+        <<errors<<" errors"<<endl;
+
+    for (const Phase& phase : {parse, symbols, passI, passII})
+    {
+        double seconds = phase.m_seconds / a_reps;
+
+        cout<<"    "<<left<<setw(18)<<phase.m_name<<right
+            <<setw(12)<<fixed<<setprecision(3)<<seconds * 1e3<<" ms"
+            <<setw(14)<<setprecision(0)<<lines.size() / seconds<<" lines/s"
+            <<setw(10)<<setprecision(1)<<a_src.size() / seconds / 1e6<<" MB/s"
+            <<endl;
+    }
+
+    cout<<endl;
+}
+/*void BenchSource(const string& a_title, const string& a_src, const int& a_reps); */
+
+}
+
+int main(int argc, char *argv[])
+{
+    GeneratorOptions opts;
+    int reps = 5;
+    bool invalidOnly = false;
+    string emitPath;
+    int positional = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "-emit" && i + 1 < argc)
+            emitPath = argv[++i];
+
+        else if (arg == "-invalid")
+            invalidOnly = true;
+
+        else if (positional == 0)
+        {
+            opts.m_instructions = atoi(argv[i]);
+            positional++;
+        }
+
+        else
+            reps = atoi(argv[i]);
+    }
+
+    if (opts.m_instructions < 1 || opts.m_instructions > 80'000 || reps < 1)
+    {
+        cerr << "Usage: AssemblerBench [-emit FileName] [-invalid] [Instructions] [Repetitions]" << endl;
+        return 1;
+    }
+
+    opts.m_constants = opts.m_instructions / 5 + 1;
+
+    GeneratorOptions invalidOpts = opts;
+    invalidOpts.m_errorEvery = 25;
+
+    if (!emitPath.empty())
+    {
+        ofstream(emitPath, ios::out | ios::binary) << GenerateSource(invalidOnly ? invalidOpts : opts);
+        return 0;
+    }
+
+    if (!invalidOnly)
+        BenchSource("VALID SOURCE", GenerateSource(opts), reps);
+
+    BenchSource("INVALID SOURCE", GenerateSource(invalidOpts), reps);
+
+    return 0;
+}
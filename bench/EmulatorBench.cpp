@@ -0,0 +1,404 @@
+/*
+ * Emulator microbenchmark.
+ *
+ * Generates synthetic Quack3200 programs directly in emulator memory and
+ * runs each of them through Emulator::RunProgram several times, reporting
+ * the instructions per second, the nanoseconds per dispatched instruction
+ * and the variance between repetitions.
+ *
+ * Build from the repository root, for example:
+ *
+ *     g++ -O2 -std=c++17 -I. Emulator.cpp Errors.cpp Metrics.cpp AotTranslator.cpp Channel.cpp \
+ *         bench/EmulatorBench.cpp -o EmulatorBench -ldl -lpthread
+ *
+ * Usage: EmulatorBench [Scale] [Repetitions]
+ */
+
+#include "../stdafx.h"
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+namespace
+{
+
+// Builds a Quack3200 memory image word by word, starting at location 100
+class ProgramBuilder
+{
+
+public:
+
+    ProgramBuilder(): m_loc(100) {}
+
+    // Emits a machine language instruction and returns its location
+    int Emit(const Emulator::OpcodeType& a_opcode, const int& a_reg, const int& a_address)
+    {
+        m_words.push_back(make_pair(m_loc, Quack3200::Translation(a_opcode, a_reg, a_address)));
+        return m_loc++;
+    }
+
+    // Replaces the address portion of the instruction at "a_loc"
+    void Patch(const int& a_loc, const int& a_address)
+    {
+        for (auto& word : m_words)
+            if (word.first == a_loc)
+                word.second = word.second - Quack3200::Address(word.second) + a_address;
+    }
+
+    // Records a constant at "a_loc"
+    void Data(const int& a_loc, const int& a_value)
+    {
+        m_words.push_back(make_pair(a_loc, a_value));
+    }
+
+    // The location of the next instruction to be emitted
+    int Here() const
+    {
+        return m_loc;
+    }
+
+    // Copies the program into the emulator memory
+    void Load(Emulator& a_emul) const
+    {
+        for (const auto& word : m_words)
+            a_emul.InsertMemory(word.first, word.second);
+    }
+
+private:
+
+    int m_loc;                              // Location of the next instruction
+    vector<pair<int, int>> m_words;         // Location and contents of each word
+};
+
+// Data locations shared by the workloads
+const int ONE = 90'000;
+const int ZERO = 90'001;
+const int COUNT = 90'002;
+const int THREE = 90'003;
+const int SEVEN = 90'004;
+const int BIG = 90'005;
+const int MODULUS = 90'006;
+const int FIVE = 90'007;
+const int TWO = 90'008;
+const int SCRATCH = 90'100;
+
+/*
+NAME
+
+    Prologue - Records the shared constants and the loop counter
+
+SYNOPSIS
+
+    void Prologue(ProgramBuilder& a_prog, const int& a_iterations);
+
+DESCRIPTION
+
+    This function records the constants used by all workloads and
+    emits the instruction that loads "a_iterations" into register 1,
+    the loop counter of every workload.
+*/
+
+void Prologue(ProgramBuilder& a_prog, const int& a_iterations)
+{
+    a_prog.Data(ONE, 1);
+    a_prog.Data(ZERO, 0);
+    a_prog.Data(COUNT, a_iterations);
+    a_prog.Data(THREE, 3);
+    a_prog.Data(SEVEN, 7);
+    a_prog.Data(BIG, 99'999'999);
+    a_prog.Data(MODULUS, 1024);
+    a_prog.Data(FIVE, 5);
+    a_prog.Data(TWO, 2);
+
+    a_prog.Emit(Emulator::LOAD, 1, COUNT);
+}
+/*void Prologue(ProgramBuilder& a_prog, const int& a_iterations); */
+
+
+/*
+NAME
+
+    Epilogue - Closes the loop that started at "a_top"
+
+SYNOPSIS
+
+    void Epilogue(ProgramBuilder& a_prog, const int& a_top);
+
+DESCRIPTION
+
+    This function decrements the loop counter in register 1,
+    branches back to "a_top" while it is positive and halts.
+*/
+
+void Epilogue(ProgramBuilder& a_prog, const int& a_top)
+{
+    a_prog.Emit(Emulator::SUB, 1, ONE);
+    a_prog.Emit(Emulator::BP, 1, a_top);
+    a_prog.Emit(Emulator::HALT, 9, 0);
+}
+/*void Epilogue(ProgramBuilder& a_prog, const int& a_top); */
+
+
+// Tight loop of ADD, SUB and MULT on registers
+void ArithmeticLoop(ProgramBuilder& a_prog, const int& a_scale)
+{
+    Prologue(a_prog, 100'000 * a_scale);
+    int top = a_prog.Here();
+
+    for (int i = 0; i < 4; i++)
+    {
+        a_prog.Emit(Emulator::ADD, 2, ONE);
+        a_prog.Emit(Emulator::SUB, 2, ONE);
+        a_prog.Emit(Emulator::MULT, 3, ONE);
+    }
+
+    Epilogue(a_prog, top);
+}
+
+// Branches on a pseudo-random sequence (x = 5x + 1 mod 1024) held in register 2
+void BranchHeavy(ProgramBuilder& a_prog, const int& a_scale)
+{
+    Prologue(a_prog, 50'000 * a_scale);
+    int top = a_prog.Here();
+
+    // x = 5x + 1
+    a_prog.Emit(Emulator::MULT, 2, FIVE);
+    a_prog.Emit(Emulator::ADD, 2, ONE);
+
+    // x = x - (x / 1024) * 1024
+    a_prog.Emit(Emulator::STORE, 2, SCRATCH);
+    a_prog.Emit(Emulator::LOAD, 3, SCRATCH);
+    a_prog.Emit(Emulator::DIV, 3, MODULUS);
+    a_prog.Emit(Emulator::MULT, 3, MODULUS);
+    a_prog.Emit(Emulator::STORE, 3, SCRATCH + 1);
+    a_prog.Emit(Emulator::SUB, 2, SCRATCH + 1);
+
+    // register 3 = (x / 2) * 2 - x, which is either 0 or -1
+    a_prog.Emit(Emulator::STORE, 2, SCRATCH + 2);
+    a_prog.Emit(Emulator::LOAD, 3, SCRATCH + 2);
+    a_prog.Emit(Emulator::DIV, 3, TWO);
+    a_prog.Emit(Emulator::MULT, 3, TWO);
+    a_prog.Emit(Emulator::SUB, 3, SCRATCH + 2);
+
+    // the data dependent branches
+    int bm = a_prog.Emit(Emulator::BM, 3, 0);
+    int bz = a_prog.Emit(Emulator::BZ, 3, 0);
+    int odd = a_prog.Emit(Emulator::ADD, 4, ONE);
+    int skip = a_prog.Emit(Emulator::B, 9, 0);
+    int even = a_prog.Emit(Emulator::SUB, 4, ONE);
+    int join = a_prog.Here();
+
+    a_prog.Patch(bm, odd);
+    a_prog.Patch(bz, even);
+    a_prog.Patch(skip, join);
+
+    Epilogue(a_prog, top);
+}
+
+// Straight-line LOAD/STORE pairs streaming over a 40,000 word region
+void MemoryStreaming(ProgramBuilder& a_prog, const int& a_scale)
+{
+    Prologue(a_prog, 100 * a_scale);
+    int top = a_prog.Here();
+
+    for (int i = 0; i < 2'000; i++)
+    {
+        a_prog.Emit(Emulator::LOAD, 2, 20'000 + i * 10);
+        a_prog.Emit(Emulator::STORE, 2, 40'000 + i * 10);
+    }
+
+    Epilogue(a_prog, top);
+}
+
+// Repeated division of a large constant
+void DivisionHeavy(ProgramBuilder& a_prog, const int& a_scale)
+{
+    Prologue(a_prog, 50'000 * a_scale);
+    int top = a_prog.Here();
+
+    a_prog.Emit(Emulator::LOAD, 2, BIG);
+
+    for (int i = 0; i < 4; i++)
+    {
+        a_prog.Emit(Emulator::DIV, 2, SEVEN);
+        a_prog.Emit(Emulator::DIV, 2, THREE);
+    }
+
+    Epilogue(a_prog, top);
+}
+
+// Walks an array by rewriting the address of its own ADD instruction
+void SelfModifying(ProgramBuilder& a_prog, const int& a_scale)
+{
+    const int ARRAY = 50'000;
+    const int LENGTH = 500;
+    const int ORIGINAL = 90'010;
+    const int LEN = 90'011;
+
+    Prologue(a_prog, 200 * a_scale);
+    int top = a_prog.Here();
+
+    // restore the instruction being rewritten, the sum and the inner counter
+    a_prog.Emit(Emulator::LOAD, 5, ORIGINAL);
+    int restore = a_prog.Emit(Emulator::STORE, 5, 0);
+    a_prog.Emit(Emulator::LOAD, 2, ZERO);
+    a_prog.Emit(Emulator::LOAD, 6, LEN);
+
+    // the body of the inner loop
+    int inner = a_prog.Emit(Emulator::ADD, 2, ARRAY);
+    a_prog.Emit(Emulator::LOAD, 5, inner);
+    a_prog.Emit(Emulator::ADD, 5, ONE);
+    a_prog.Emit(Emulator::STORE, 5, inner);
+    a_prog.Emit(Emulator::SUB, 6, ONE);
+    a_prog.Emit(Emulator::BP, 6, inner);
+
+    a_prog.Patch(restore, inner);
+    a_prog.Data(ORIGINAL, Quack3200::Translation(Emulator::ADD, 2, ARRAY));
+    a_prog.Data(LEN, LENGTH);
+
+    for (int i = 0; i < LENGTH; i++)
+        a_prog.Data(ARRAY + i, i);
+
+    Epilogue(a_prog, top);
+}
+
+// Discards everything written to it
+class NullBuffer : public streambuf
+{
+protected:
+
+    int overflow(int a_ch) override
+    {
+        return a_ch;
+    }
+};
+
+// A generator and its name
+struct Workload
+{
+    const char *m_name;
+    void (*m_generate)(ProgramBuilder&, const int&);
+};
+
+/*
+NAME
+
+    RunWorkload - Times the repeated emulation of one workload
+
+SYNOPSIS
+
+    bool RunWorkload(const Workload& a_work, const int& a_scale, const int& a_reps);
+
+DESCRIPTION
+
+    This function generates the program of "a_work", performs one untimed
+    warm-up run and "a_reps" timed runs through Emulator::RunProgram, each
+    on a freshly loaded emulator, and prints one row of results.
+
+    Returns false - if the workload produced a run-time error
+    Returns true - Otherwise
+*/
+
+bool RunWorkload(const Workload& a_work, const int& a_scale, const int& a_reps)
+{
+    ProgramBuilder prog;
+    a_work.m_generate(prog, a_scale);
+
+    NullBuffer null;
+    vector<double> nsPerInstr;
+    long long instructions = 0;
+    double totalSeconds = 0;
+
+    for (int rep = -1; rep < a_reps; rep++)
+    {
+        // the emulator is too large for the stack
+        unique_ptr<Emulator> emul(new Emulator);
+        prog.Load(*emul);
+        Errors::InitErrorReporting();
+
+        streambuf *console = cout.rdbuf(&null);
+        auto start = chrono::steady_clock::now();
+        emul->RunProgram();
+        auto stop = chrono::steady_clock::now();
+        cout.rdbuf(console);
+
+        if (Errors::NumErrors() != 0)
+        {
+            cout<<a_work.m_name<<": run-time error during emulation"<<endl;
+            Errors::DisplayErrors();
+            return false;
+        }
+
+        // rep -1 is the warm-up run
+        if (rep < 0)
+            continue;
+
+        double seconds = chrono::duration<double>(stop - start).count();
+        instructions = emul->GetInstructionCount();
+        totalSeconds += seconds;
+        nsPerInstr.push_back(seconds * 1e9 / instructions);
+    }
+
+    double mean = 0;
+    for (double ns : nsPerInstr)
+        mean += ns;
+    mean /= nsPerInstr.size();
+
+    double variance = 0;
+    for (double ns : nsPerInstr)
+        variance += (ns - mean) * (ns - mean);
+    variance /= nsPerInstr.size();
+
+    double instrPerSec = instructions * (double)a_reps / totalSeconds;
+
+    cout<<left<<setw(18)<<a_work.m_name<<right
+        <<setw(14)<<instructions
+        <<setw(12)<<fixed<<setprecision(1)<<instrPerSec / 1e6
+        <<setw(12)<<setprecision(3)<<mean
+        <<setw(14)<<setprecision(5)<<variance
+        <<setw(10)<<setprecision(2)<<(mean > 0 ? 100 * sqrt(variance) / mean : 0)
+        <<endl;
+
+    return true;
+}
+/*bool RunWorkload(const Workload& a_work, const int& a_scale, const int& a_reps); */
+
+}
+
+int main(int argc, char *argv[])
+{
+    int scale = argc > 1 ? atoi(argv[1]) : 10;
+    int reps = argc > 2 ? atoi(argv[2]) : 7;
+
+    if (scale < 1 || reps < 1)
+    {
+        cerr << "Usage: EmulatorBench [Scale] [Repetitions]" << endl;
+        return 1;
+    }
+
+    // populates the list of all possible errors
+    Errors();
+
+    const Workload workloads[] =
+    {
+        {"arithmetic", ArithmeticLoop},
+        {"branch-heavy", BranchHeavy},
+        {"memory-stream", MemoryStreaming},
+        {"division-heavy", DivisionHeavy},
+        {"self-modifying", SelfModifying}
+    };
+
+    cout<<left<<setw(18)<<"WORKLOAD"<<right
+        <<setw(14)<<"INSTRUCTIONS"
+        <<setw(12)<<"MINSTR/S"
+        <<setw(12)<<"NS/DISPATCH"
+        <<setw(14)<<"VARIANCE"
+        <<setw(10)<<"RSD %"
+        <<endl;
+
+    bool allPassed = true;
+    for (const Workload& work : workloads)
+        allPassed = RunWorkload(work, scale, reps) && allPassed;
+
+    return allPassed ? 0 : 1;
+}
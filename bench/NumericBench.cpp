@@ -0,0 +1,223 @@
+/*
+ * Numeric parsing and formatting microbenchmark.
+ *
+ * Times the conversions made for every READ, WRITE and translation with
+ * the code they used before Numeric (character loops, stoi, to_string
+ * and ostream) and with Numeric, over generated words: run-time inputs
+ * (some invalid or too long), addresses padded to ADDRESS_DIGITS, the
+ * contents of translations and values written by WRITE. Each pair must
+ * give the same results; the nanoseconds per word and the speedup are
+ * reported.
+ *
+ * Build from the repository root, for example:
+ *
+ *     g++ -O2 -std=c++17 -I. bench/NumericBench.cpp -o NumericBench
+ *
+ * Usage: NumericBench [Words] [Repetitions]
+ */
+
+#include "../stdafx.h"
+#include <chrono>
+#include <random>
+
+namespace
+{
+
+// Checks and converts an input as Emulator::InputError() did before Numeric
+int LoopParse(const string& a_input, int& a_value)
+{
+    size_t maxChar = Quack3200::WORD_DIGITS;
+    size_t start = 0;
+
+    if (!a_input.empty() && a_input[0] == '-')
+    {
+        maxChar = Quack3200::WORD_DIGITS + 1;
+        start = 1;
+    }
+
+    if (start == a_input.size())
+        return 28;
+
+    for (size_t i = start; i < a_input.size(); i++)
+        if (!isdigit(a_input[i]))
+            return 28;
+
+    if (a_input.size() > maxChar)
+        return 19;
+
+    a_value = stoi(a_input);
+
+    return -1;
+}
+
+// Checks and converts an input with Numeric
+int NumericParse(const string& a_input, int& a_value)
+{
+    switch (Numeric::Parse(a_input, Quack3200::WORD_DIGITS, a_value))
+    {
+        case Numeric::NS_NotInteger:
+            return 28;
+
+        case Numeric::NS_TooLong:
+            return 19;
+
+        default:
+            return -1;
+    }
+}
+
+// Pads an address as Pass II did before Numeric
+void LoopPad(string& a_content, const int& a_address)
+{
+    string address = to_string(a_address);
+
+    for (size_t i = address.size(); i < (size_t)Quack3200::ADDRESS_DIGITS; i++)
+        a_content += '0';
+
+    a_content += address;
+}
+
+// Pads an address with Numeric
+void NumericPad(string& a_content, const int& a_address)
+{
+    Numeric::AppendPadded(a_content, a_address, Quack3200::ADDRESS_DIGITS);
+}
+
+// The results of one conversion timed both ways
+struct Comparison
+{
+    const char *m_name;                     // What is converted
+    double m_before;                        // Nanoseconds per word before Numeric
+    double m_after;                         // Nanoseconds per word with Numeric
+    bool m_same;                            // == true if both gave the same results
+};
+
+// Times "a_convert" over "a_words" words "a_reps" times, returning the best nanoseconds per word
+template <class Convert>
+double Time(const size_t& a_words, const int& a_reps, long long& a_checksum, Convert a_convert)
+{
+    double best = 0;
+
+    for (int rep = 0; rep < a_reps; rep++)
+    {
+        long long checksum = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        for (size_t i = 0; i < a_words; i++)
+            checksum += a_convert(i);
+
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double nanoseconds = 1e9 * seconds / a_words;
+
+        if (rep == 0 || nanoseconds < best)
+            best = nanoseconds;
+
+        a_checksum = checksum;
+    }
+
+    return best;
+}
+
+// Times both ways of one conversion
+template <class Before, class After>
+Comparison Compare(const char *a_name, const size_t& a_words, const int& a_reps, Before a_before, After a_after)
+{
+    long long before = 0, after = 0;
+    Comparison comparison;
+
+    comparison.m_name = a_name;
+    comparison.m_before = Time(a_words, a_reps, before, a_before);
+    comparison.m_after = Time(a_words, a_reps, after, a_after);
+    comparison.m_same = (before == after);
+
+    return comparison;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    size_t words = argc > 1 ? atol(argv[1]) : 1000000;
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+
+    if (words < 1 || reps < 1)
+    {
+        cerr << "Usage: NumericBench [Words] [Repetitions]" << endl;
+        return 1;
+    }
+
+    mt19937 random(3200);
+    uniform_int_distribution<int> word(Quack3200::MINVAL, Quack3200::MAXVAL);
+    uniform_int_distribution<int> address(0, Quack3200::MEMSZ - 1);
+
+    // one input in sixteen is not an integer and one in sixteen is too long
+    vector<string> inputs(words), contents(words);
+    vector<int> addresses(words), values(words);
+
+    for (size_t i = 0; i < words; i++)
+    {
+        values[i] = word(random);
+        addresses[i] = address(random);
+        inputs[i] = to_string(values[i]);
+
+        if (i % 16 == 5)
+            inputs[i][inputs[i].size() / 2] = 'x';
+
+        else if (i % 16 == 11)
+            inputs[i] += "0";
+
+        contents[i].clear();
+        NumericPad(contents[i], addresses[i]);
+        contents[i] = "05" + to_string(i % 10) + contents[i];
+    }
+
+    vector<Comparison> comparisons;
+    string content;
+    ostringstream stream;
+    string output;
+    char digits[Numeric::MAXCHARS];
+
+    comparisons.push_back(Compare("READ input", words, reps,
+        [&](size_t i) {int value = 0; return LoopParse(inputs[i], value) * 1000003LL + value;},
+        [&](size_t i) {int value = 0; return NumericParse(inputs[i], value) * 1000003LL + value;}));
+
+    comparisons.push_back(Compare("Pass II address", words, reps,
+        [&](size_t i) {content.assign("059", 3); LoopPad(content, addresses[i]); return (long long)content.back() + content.size();},
+        [&](size_t i) {content.assign("059", 3); NumericPad(content, addresses[i]); return (long long)content.back() + content.size();}));
+
+    comparisons.push_back(Compare("Translation value", words, reps,
+        [&](size_t i) {return (long long)stoi(contents[i]);},
+        [&](size_t i) {return (long long)Numeric::Value(contents[i]);}));
+
+    comparisons.push_back(Compare("WRITE output", words, reps,
+        [&](size_t i) {stream.str(""); stream<<values[i]<<'\n'; return (long long)stream.str().size();},
+        [&](size_t i)
+        {
+            output.assign(digits, Numeric::Format(digits, values[i]));
+            output += '\n';
+            return (long long)output.size();
+        }));
+
+    cout<<left<<setw(20)<<"CONVERSION"<<right
+        <<setw(12)<<"BEFORE NS"
+        <<setw(12)<<"NUMERIC NS"
+        <<setw(10)<<"SPEEDUP"
+        <<setw(8)<<"SAME"
+        <<endl;
+
+    bool allSame = true;
+
+    for (const Comparison& comparison : comparisons)
+    {
+        cout<<left<<setw(20)<<comparison.m_name<<right<<fixed<<setprecision(2)
+            <<setw(12)<<comparison.m_before
+            <<setw(12)<<comparison.m_after
+            <<setw(9)<<comparison.m_before / comparison.m_after<<'x'
+            <<setw(8)<<(comparison.m_same ? "yes" : "NO")
+            <<endl;
+
+        allSame = allSame && comparison.m_same;
+    }
+
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+//
+//  Implementation of the source generator.
+//
+
+#include "SourceGenerator.h"
+
+namespace
+{
+
+// Small deterministic pseudo-random sequence (xorshift)
+class Sequence
+{
+
+public:
+
+    Sequence(const unsigned& a_seed): m_state(a_seed ? a_seed : 1) {}
+
+    // Returns a number in the range 0 to a_bound - 1
+    int Next(const int& a_bound)
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return (int)(m_state % (unsigned)a_bound);
+    }
+
+private:
+
+    unsigned m_state;
+};
+
+// Opcodes that take a register and a symbolic operand
+const char *const REGISTER_OPCODES[] = {"add", "SUB", "Mult", "div", "LOAD", "store", "load", "ADD"};
+
+// Opcodes that branch to a label
+const char *const BRANCH_OPCODES[] = {"bm", "BZ", "bp"};
+
+// Statements containing each kind of error, in rotation
+const char *const INVALID_STATEMENTS[] =
+{
+    "         load 12, D0            ; invalid register",
+    "         add 1, NOWHERE         ; undefined symbol",
+    "L0       sub 1, D0              ; multiply defined label",
+    "         mult 1, 25             ; numeric operand",
+    "         load 1, D0 extra words ; extra operands",
+    "         frob 1, D0             ; invalid statement",
+    "         store 1,, D0           ; comma error",
+    "9bad     write D0               ; invalid symbol"
+};
+
+// Left-justifies a label in the label column
+string LabelColumn(const string& a_label)
+{
+    string column = a_label;
+    column.resize(9, ' ');
+    return column;
+}
+
+}
+
+/*
+NAME
+
+    GenerateSource - Generates the source text of a Quack3200 program
+
+SYNOPSIS
+
+    string GenerateSource(const GeneratorOptions& a_opts);
+
+DESCRIPTION
+
+    This function produces a program shaped by "a_opts": a block of
+    labelled machine language statements with branches, trailing comments,
+    full-line comments, ORG jumps and very long lines, followed by a HALT,
+    a mix of DC and DS statements and an END. When "a_opts.m_errorEvery" is
+    not zero, an invalid statement is inserted at that interval.
+
+    Returns - the text of the program
+*/
+
+string GenerateSource(const GeneratorOptions& a_opts)
+{
+    Sequence rand(a_opts.m_seed);
+    string src;
+    src.reserve((size_t)(a_opts.m_instructions + a_opts.m_constants) * 48);
+
+    int constants = a_opts.m_constants > 0 ? a_opts.m_constants : 1;
+    int labels = (a_opts.m_instructions + 2) / 3;
+
+    src += "; synthetic Quack3200 program for the assembler benchmarks\n";
+    src += "         org 100\n";
+
+    // location of the next statement, to keep ORG and DS within memory
+    int loc = 100;
+
+    for (int i = 0; i < a_opts.m_instructions; i++)
+    {
+        if (a_opts.m_commentEvery > 0 && i % a_opts.m_commentEvery == 0)
+            src += "; statement " + to_string(i) + " of the generated program\n";
+
+        if (a_opts.m_orgEvery > 0 && i > 0 && i % a_opts.m_orgEvery == 0 && loc + 50 < 90'000)
+        {
+            loc += 50;
+            src += "         org " + to_string(loc) + "\n";
+        }
+
+        if (a_opts.m_errorEvery > 0 && i > 0 && i % a_opts.m_errorEvery == 0)
+        {
+            src += INVALID_STATEMENTS[(i / a_opts.m_errorEvery) % 8];
+            src += '\n';
+        }
+
+        // every third statement is a branch target
+        string line = LabelColumn(i % 3 == 0 ? "L" + to_string(i) : "");
+        int kind = rand.Next(10);
+
+        if (kind < 7)
+        {
+            line += REGISTER_OPCODES[rand.Next(8)];
+            line += " " + to_string(rand.Next(10)) + ", D" + to_string(rand.Next(constants));
+        }
+
+        else if (kind < 9)
+        {
+            line += BRANCH_OPCODES[rand.Next(3)];
+            line += " " + to_string(rand.Next(10)) + ", L" + to_string(3 * rand.Next(labels));
+        }
+
+        else
+            line += "write D" + to_string(rand.Next(constants));
+
+        if (rand.Next(4) == 0)
+        {
+            line.resize(40, ' ');
+            line += "; trailing comment";
+        }
+
+        if (a_opts.m_longLineEvery > 0 && i % a_opts.m_longLineEvery == 0)
+        {
+            line += "   ;";
+            line.append(400, '=');
+        }
+
+        src += line + "\n";
+        loc++;
+    }
+
+    src += "         halt\n";
+    loc++;
+
+    // data follows the HALT instruction
+    for (int i = 0; i < constants; i++)
+    {
+        string line = LabelColumn("D" + to_string(i));
+
+        if (rand.Next(3) == 0 && loc + 8 < 99'000)
+        {
+            int size = 1 + rand.Next(8);
+            line += "ds " + to_string(size);
+            loc += size;
+        }
+
+        else
+        {
+            int value = rand.Next(99'999'999);
+            line += (rand.Next(2) ? "DC " : "dc ") + to_string(rand.Next(4) == 0 ? -value - 1 : value);
+            loc++;
+        }
+
+        src += line + "\n";
+    }
+
+    src += "         end\n";
+    return src;
+}
+/*string GenerateSource(const GeneratorOptions& a_opts); */
@@ -0,0 +1,26 @@
+//
+//        Source generator - produces large synthetic Quack3200 programs
+//        for the assembler benchmarks
+//
+
+#pragma once
+
+#include "../stdafx.h"
+
+// The shape of the program to be generated
+struct GeneratorOptions
+{
+    GeneratorOptions(): m_instructions(20'000), m_constants(4'000), m_commentEvery(4),
+    m_orgEvery(2'500), m_longLineEvery(50), m_errorEvery(0), m_seed(3200) {}
+
+    int m_instructions;         // Number of machine language statements
+    int m_constants;            // Number of DC and DS statements after the HALT
+    int m_commentEvery;         // One full-line comment every this many statements
+    int m_orgEvery;             // One ORG jump every this many statements (0 = none)
+    int m_longLineEvery;        // One very long statement every this many (0 = none)
+    int m_errorEvery;           // One invalid statement every this many (0 = valid program)
+    unsigned m_seed;            // Seed of the pseudo-random sequence
+};
+
+// Generates the source text of a Quack3200 program
+string GenerateSource(const GeneratorOptions&);
@@ -12,17 +12,36 @@
 #include <string>
 #include <fstream>
 #include <map>
+#include <set>
 #include <vector>
 #include <algorithm>
 #include <sstream>
 #include <iterator>
 #include <cstring>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <charconv>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 using namespace std;
 
 // Project specific include files
 
+#include "Metrics.h"
+#include "Numeric.h"
+#include "SourceScanner.h"
 #include "FileAccess.h"
+#include "ListingWriter.h"
 #include "Instruction.h"
 #include "SymTab.h"
+#include "AotModule.h"
+#include "Machine.h"
+#include "Channel.h"
 #include "Emulator.h"
+#include "AotTranslator.h"
+#include "Optimizer.h"
+#include "Linker.h"
+#include "AssemblyCache.h"
 #include "Errors.h"
@@ -0,0 +1,108 @@
+/*
+ * Ahead-of-time translator for Quack3200 programs.
+ *
+ * Assembles a source file and writes its memory image as one C++ function
+ * (see AotTranslator), optionally compiling it into a shared library with
+ * the system compiler ($CXX, c++ by default). The assembler runs the
+ * library in place of the interpreter when QUACK_AOT names it:
+ *
+ *     QuackAot Program.qk Program.cpp -so ./Program.so
+ *     QUACK_AOT=./Program.so Assem Program.qk
+ *
+ * A program translated with -O is optimized (see Optimizer) and must be
+ * run with QUACK_OPTIMIZE=1, so that the assembler runs the same image.
+ *
+ * Build from the repository root, for example:
+ *
+ *     g++ -O2 -std=c++17 -I. Assembler.cpp Emulator.cpp Errors.cpp FileAccess.cpp \
+ *         Instruction.cpp SymTab.cpp Metrics.cpp ListingWriter.cpp SourceScanner.cpp \
+ *         AotTranslator.cpp AssemblyCache.cpp Optimizer.cpp Linker.cpp Channel.cpp tools/QuackAot.cpp -o QuackAot -ldl -lpthread
+ *
+ * Usage: QuackAot SourceFile OutputFile [-so Library] [-I IncludeDirectory] [-O]
+ *
+ * The include directory is the one holding AotModule.h (. by default).
+ */
+
+#include "../stdafx.h"
+#include "../Assembler.h"
+#include <cstdlib>
+#include <memory>
+
+int main(int argc, char *argv[])
+{
+    string library;
+    string includeDir = ".";
+    vector<string> files;
+    bool optimize = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "-so" && i + 1 < argc)
+            library = argv[++i];
+
+        else if (arg == "-I" && i + 1 < argc)
+            includeDir = argv[++i];
+
+        else if (arg == "-O")
+            optimize = true;
+
+        else
+            files.push_back(arg);
+    }
+
+    if (files.size() != 2)
+    {
+        cerr << "Usage: QuackAot SourceFile OutputFile [-so Library] [-I IncludeDirectory] [-O]" << endl;
+        return 1;
+    }
+
+    char program[] = "QuackAot";
+    char *assemArgv[] = {program, &files[0][0], nullptr};
+
+    // the assembler holds the whole emulator memory
+    unique_ptr<Assembler> assem(new Assembler(2, assemArgv));
+    assem->SetListing(false);
+    assem->PassI();
+
+    // the symbol table is only needed for its errors
+    assem->CheckSymbolTable();
+
+    assem->PassII();
+
+    if (Errors::NumErrors() != 0)
+    {
+        cerr << files[0] << " has " << Errors::NumErrors() / 2
+             << " errors, run Assem on it for the list of errors." << endl;
+        return 1;
+    }
+
+    if (optimize)
+        assem->Optimize();
+
+    ofstream out(files[1], ios::out | ios::binary);
+    assem->TranslateToNative(out);
+    out.close();
+
+    if (!out)
+    {
+        cerr << files[1] << " could not be written." << endl;
+        return 1;
+    }
+
+    if (library.empty())
+        return 0;
+
+    const char *compiler = getenv("CXX");
+    string command = string(compiler != nullptr && *compiler != '\0' ? compiler : "c++")
+        + " -O2 -shared -fPIC -I\"" + includeDir + "\" \"" + files[1] + "\" -o \"" + library + "\"";
+
+    if (system(command.c_str()) != 0)
+    {
+        cerr << "Compilation failed: " << command << endl;
+        return 1;
+    }
+
+    return 0;
+}
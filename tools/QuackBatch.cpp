@@ -0,0 +1,453 @@
+/*
+ * Batch driver for many Quack3200 programs.
+ *
+ * Assembles and runs every source named on the command line, found under
+ * a directory (files ending in .qk) or listed in a manifest (one path per
+ * line, blank lines and lines starting with # are ignored). The work is a
+ * pipeline of stages connected by bounded queues:
+ *
+ *     read -> parse (Pass I) -> translate (Pass II) -> emulate -> report
+ *
+ * Reading and reporting have one thread each and the other stages have a
+ * pool of threads each, so that reading files overlaps with assembling
+ * and running the others. At most a fixed number of programs are between
+ * the first and the last stage, which bounds the memory used however many
+ * files there are. Each program is assembled and run with its own errors
+ * and its own emulator memory.
+ *
+ * The input of the READ instructions of Program.qk is taken from
+ * Program.qk.in if it exists (one word per READ), and the results are
+ * reported in the order the sources were given, in the format of
+ * QuackServer:
+ *
+ *     == <source>
+ *     ASSEMBLED <1 if there are no errors> 0
+ *     E <code> <statement><TAB><message>
+ *     W <value>
+ *     HALTED <1 if HALT was executed> <instructions dispatched>
+ *
+ * With -o the results of each source go to Directory/<source path>.out
+ * instead, with the separators of the path replaced by _. A summary is
+ * written to the standard error at the end.
+ *
+ * Build from the repository root, for example:
+ *
+ *     g++ -O2 -std=c++17 -I. Assembler.cpp Emulator.cpp Errors.cpp FileAccess.cpp \
+ *         Instruction.cpp SymTab.cpp Metrics.cpp ListingWriter.cpp SourceScanner.cpp \
+ *         AotTranslator.cpp AssemblyCache.cpp Optimizer.cpp Linker.cpp Channel.cpp LaneEmulator.cpp Toolchain.cpp tools/QuackBatch.cpp \
+ *         -o QuackBatch -ldl -lpthread
+ *
+ * Usage: QuackBatch [-m Manifest] [-o Directory] [-j Threads] [-w Window] Source|Directory ...
+ *
+ * -j is the number of threads of each of the parse, translate and emulate
+ * stages (the number of processors by default) and -w the number of
+ * programs in the pipeline at once (4 per thread by default).
+ */
+
+#include "../stdafx.h"
+#include "../Toolchain.h"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+
+// A queue between two stages; Push() waits while it is full
+template <typename T>
+class BoundedQueue
+{
+
+public:
+
+    BoundedQueue(const size_t& a_capacity): m_capacity(a_capacity), m_closed(false) {}
+
+    void Push(T a_item)
+    {
+        unique_lock<mutex> lock(m_lock);
+        m_notFull.wait(lock, [this] {return m_items.size() < m_capacity;});
+
+        m_items.push_back(move(a_item));
+        m_notEmpty.notify_one();
+    }
+
+    // Returns false once the queue is closed and empty
+    bool Pop(T& a_item)
+    {
+        unique_lock<mutex> lock(m_lock);
+        m_notEmpty.wait(lock, [this] {return m_closed || !m_items.empty();});
+
+        if (m_items.empty())
+            return false;
+
+        a_item = move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+
+        return true;
+    }
+
+    // Called once every producer is done
+    void Close()
+    {
+        lock_guard<mutex> lock(m_lock);
+        m_closed = true;
+        m_notEmpty.notify_all();
+    }
+
+private:
+
+    size_t m_capacity;
+    mutex m_lock;
+    condition_variable m_notFull;
+    condition_variable m_notEmpty;
+    deque<T> m_items;
+    bool m_closed;
+};
+
+// One source travelling through the pipeline
+struct Job
+{
+    size_t m_index;                         // Position of the source in the batch
+    string m_path;                          // The source file
+    bool m_readable = false;                // == true if the source was read
+    string m_source;                        // Contents of the source
+    string m_input;                         // Input of the READ instructions
+    unique_ptr<ParsedSource> m_parsed;      // The source after Pass I
+    AssemblyResult m_assembly;              // The source after Pass II
+    string m_report;                        // The results of the source
+};
+
+typedef unique_ptr<Job> JobPtr;
+
+// Reads a whole file, false if it cannot be opened
+bool ReadFile(const string& a_path, string& a_contents)
+{
+    ifstream in(a_path, ios::in | ios::binary);
+
+    if (!in)
+        return false;
+
+    a_contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return true;
+}
+
+// Appends the lines of a list of diagnostics to a report
+void WriteDiagnostics(const vector<Diagnostic>& a_diagnostics, string& a_report)
+{
+    for (const Diagnostic& diagnostic : a_diagnostics)
+    {
+        string line = "E " + to_string(diagnostic.m_code) + " " + diagnostic.m_statement
+            + "\t" + diagnostic.m_message;
+
+        replace(line.begin(), line.end(), '\n', ' ');
+        replace(line.begin(), line.end(), '\r', ' ');
+
+        a_report += line + "\n";
+    }
+}
+
+// The input words and the WRITE values of one run
+class ReportIO : public EmulatorIO
+{
+
+public:
+
+    ReportIO(const string& a_input, string& a_report): m_input(a_input), m_report(a_report) {}
+
+    bool Read(string& a_word)
+    {
+        return static_cast<bool>(m_input>>a_word);
+    }
+
+    void Write(const int& a_value)
+    {
+        m_report += "W " + to_string(a_value) + "\n";
+    }
+
+private:
+
+    istringstream m_input;
+    string& m_report;
+};
+
+// Adds the sources named by "a_arg" (a file or a directory) to "a_paths"
+void AddSources(const string& a_arg, vector<string>& a_paths)
+{
+    error_code ec;
+
+    if (!filesystem::is_directory(a_arg, ec))
+    {
+        a_paths.push_back(a_arg);
+        return;
+    }
+
+    vector<string> found;
+
+    for (filesystem::recursive_directory_iterator it(a_arg, ec), end; !ec && it != end; it.increment(ec))
+        if (it->is_regular_file(ec) && it->path().extension() == ".qk")
+            found.push_back(it->path().string());
+
+    // the same order on every run
+    sort(found.begin(), found.end());
+    a_paths.insert(a_paths.end(), found.begin(), found.end());
+}
+
+// Counts of the whole batch
+struct Summary
+{
+    size_t m_sources = 0;
+    size_t m_unreadable = 0;
+    size_t m_assemblyFailures = 0;
+    size_t m_runtimeFailures = 0;
+    long long m_instructions = 0;
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+    vector<string> paths;
+    string outDir;
+    size_t threads = max(1u, thread::hardware_concurrency());
+    size_t window = 0;
+    bool valid = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "-m" && i + 1 < argc)
+        {
+            ifstream manifest(argv[++i]);
+            string line;
+
+            if (!manifest)
+            {
+                cerr << argv[i] << " could not be opened." << endl;
+                return 1;
+            }
+
+            while (getline(manifest, line))
+            {
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+
+                if (!line.empty() && line[0] != '#')
+                    AddSources(line, paths);
+            }
+        }
+
+        else if (arg == "-o" && i + 1 < argc)
+            outDir = argv[++i];
+
+        else if (arg == "-j" && i + 1 < argc)
+            threads = max(1, atoi(argv[++i]));
+
+        else if (arg == "-w" && i + 1 < argc)
+            window = max(1, atoi(argv[++i]));
+
+        else if (arg[0] != '-')
+            AddSources(arg, paths);
+
+        else
+            valid = false;
+    }
+
+    if (!valid || paths.empty())
+    {
+        cerr << "Usage: QuackBatch [-m Manifest] [-o Directory] [-j Threads] [-w Window] Source|Directory ..." << endl;
+        return 1;
+    }
+
+    if (window == 0)
+        window = 4 * threads;
+
+    if (!outDir.empty())
+    {
+        error_code ec;
+        filesystem::create_directories(outDir, ec);
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    BoundedQueue<JobPtr> toParse(window), toTranslate(window), toEmulate(window), toReport(window);
+
+    // the programs between reading and reporting, which bounds the reorder buffer
+    mutex windowLock;
+    condition_variable windowOpen;
+    size_t inFlight = 0;
+
+    // each stage closes its output once all of its threads are done
+    auto stage = [&](BoundedQueue<JobPtr>& a_in, BoundedQueue<JobPtr>& a_out,
+                     const function<void(Job&)>& a_work)
+    {
+        vector<thread> pool;
+
+        for (size_t i = 0; i < threads; i++)
+            pool.emplace_back([&a_in, &a_out, a_work]
+            {
+                JobPtr job;
+
+                while (a_in.Pop(job))
+                {
+                    a_work(*job);
+                    a_out.Push(move(job));
+                }
+            });
+
+        return thread([&a_out, pool = move(pool)]() mutable
+        {
+            for (thread& worker : pool)
+                worker.join();
+
+            a_out.Close();
+        });
+    };
+
+    thread reader([&]
+    {
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            {
+                unique_lock<mutex> lock(windowLock);
+                windowOpen.wait(lock, [&] {return inFlight < window;});
+                inFlight++;
+            }
+
+            JobPtr job(new Job);
+            job->m_index = i;
+            job->m_path = paths[i];
+            job->m_readable = ReadFile(paths[i], job->m_source);
+
+            if (job->m_readable && !ReadFile(paths[i] + ".in", job->m_input))
+                job->m_input.clear();
+
+            toParse.Push(move(job));
+        }
+
+        toParse.Close();
+    });
+
+    thread parse = stage(toParse, toTranslate, [](Job& a_job)
+    {
+        if (a_job.m_readable)
+            a_job.m_parsed = Toolchain::Parse(a_job.m_source.data(), a_job.m_source.size());
+
+        string().swap(a_job.m_source);
+    });
+
+    thread translate = stage(toTranslate, toEmulate, [](Job& a_job)
+    {
+        if (a_job.m_parsed)
+        {
+            a_job.m_assembly = Toolchain::Translate(*a_job.m_parsed);
+            a_job.m_parsed.reset();
+        }
+    });
+
+    thread emulate = stage(toEmulate, toReport, [](Job& a_job)
+    {
+        // paged in once for every run of this thread
+        thread_local unique_ptr<Emulator> emul(new Emulator);
+
+        if (!a_job.m_readable)
+        {
+            a_job.m_report = "UNREADABLE\n";
+            return;
+        }
+
+        const AssemblyResult& assembly = a_job.m_assembly;
+        a_job.m_report = "ASSEMBLED " + to_string(assembly.m_success ? 1 : 0) + " 0\n";
+        WriteDiagnostics(assembly.m_diagnostics, a_job.m_report);
+
+        if (assembly.m_success)
+        {
+            ReportIO io(a_job.m_input, a_job.m_report);
+            RunResult run = Toolchain::Run(*emul, assembly.m_image, io);
+
+            a_job.m_report += "HALTED " + to_string(run.m_halted ? 1 : 0) + " "
+                + to_string(run.m_instructions) + "\n";
+            WriteDiagnostics(run.m_diagnostics, a_job.m_report);
+        }
+
+        // the image is not needed past this stage
+        vector<int>().swap(a_job.m_assembly.m_image);
+    });
+
+    // reports in the order of the sources
+    Summary summary;
+    map<size_t, JobPtr> waiting;
+    size_t next = 0;
+    JobPtr job;
+
+    while (toReport.Pop(job))
+    {
+        size_t index = job->m_index;
+        waiting[index] = move(job);
+
+        for (auto it = waiting.begin(); it != waiting.end() && it->first == next; it = waiting.erase(it), next++)
+        {
+            Job& done = *it->second;
+            const string& report = done.m_report;
+
+            summary.m_sources++;
+            summary.m_unreadable += !done.m_readable;
+            summary.m_assemblyFailures += done.m_readable && !done.m_assembly.m_success;
+
+            size_t halted = report.find("\nHALTED ");
+            if (halted != string::npos)
+            {
+                istringstream counts(report.substr(halted + 8));
+                int halt;
+                long long instructions;
+
+                if (counts>>halt>>instructions)
+                {
+                    summary.m_runtimeFailures += (halt == 0);
+                    summary.m_instructions += instructions;
+                }
+            }
+
+            if (outDir.empty())
+                cout << "== " << done.m_path << "\n" << report;
+
+            else
+            {
+                // sources with the same name in different directories are kept apart
+                string name = filesystem::path(done.m_path).relative_path().string() + ".out";
+                replace(name.begin(), name.end(), '/', '_');
+                ofstream out(filesystem::path(outDir) / name, ios::out | ios::binary);
+                out << report;
+
+                if (!out)
+                    cerr << name << " could not be written." << endl;
+            }
+
+            {
+                lock_guard<mutex> lock(windowLock);
+                inFlight--;
+            }
+
+            windowOpen.notify_one();
+        }
+    }
+
+    reader.join();
+    parse.join();
+    translate.join();
+    emulate.join();
+    cout << flush;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cerr << summary.m_sources << " sources in " << fixed << setprecision(3) << seconds << " s ("
+         << setprecision(0) << summary.m_sources / max(seconds, 1e-9) << " per second), "
+         << summary.m_unreadable << " unreadable, "
+         << summary.m_assemblyFailures << " with assembly errors, "
+         << summary.m_runtimeFailures << " stopped by run-time errors, "
+         << summary.m_instructions << " instructions" << endl;
+
+    return summary.m_unreadable + summary.m_assemblyFailures + summary.m_runtimeFailures == 0 ? 0 : 1;
+}
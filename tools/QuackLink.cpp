@@ -0,0 +1,199 @@
+/*
+ * Linker driver for Quack3200 programs made of several sources.
+ *
+ * A source assembled as an object module may use the symbols of other
+ * modules and let them use its own:
+ *
+ *             IMPORT  Square            the location is found by the linker
+ *             EXPORT  Start             other modules may import Start
+ *
+ * and a library module needs no HALT instruction. The modules named on
+ * the command line, sources or object modules written by -c (files
+ * starting with QUACKOBJ), are linked in that order: the first is placed
+ * at its own locations and each of the others after the one before it
+ * (see Linker). Exactly one of them has the HALT instruction.
+ *
+ *     QuackLink -c Main.qk Square.qk          writes Main.qk.qo and Square.qk.qo
+ *     QuackLink -o Program.qo Main.qk.qo Square.qk.qo
+ *     QuackLink -run Program.qo
+ *
+ * -o writes the linked image as an object module without imports and
+ * -run runs it, with the input of the READ instructions taken from the
+ * standard input. The errors are written to the standard error.
+ *
+ * Build from the repository root, for example:
+ *
+ *     g++ -O2 -std=c++17 -I. Assembler.cpp Emulator.cpp Errors.cpp FileAccess.cpp \
+ *         Instruction.cpp SymTab.cpp Metrics.cpp ListingWriter.cpp SourceScanner.cpp \
+ *         AotTranslator.cpp AssemblyCache.cpp Optimizer.cpp Linker.cpp Channel.cpp LaneEmulator.cpp Toolchain.cpp tools/QuackLink.cpp \
+ *         -o QuackLink -ldl -lpthread
+ *
+ * Usage: QuackLink [-c] [-o Output] [-run] Module ...
+ */
+
+#include "../stdafx.h"
+#include "../Toolchain.h"
+
+namespace
+{
+
+// Reads a whole file, false if it cannot be opened
+bool ReadFile(const string& a_path, string& a_contents)
+{
+    ifstream in(a_path, ios::in | ios::binary);
+
+    if (!in)
+        return false;
+
+    a_contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return true;
+}
+
+// Writes the errors of one module or of the link to the standard error
+void WriteDiagnostics(const string& a_name, const vector<Diagnostic>& a_diagnostics)
+{
+    for (const Diagnostic& diagnostic : a_diagnostics)
+        cerr << a_name << ": " << diagnostic.m_statement << "  <ERROR " << diagnostic.m_code
+             << ": " << diagnostic.m_message << ">" << endl;
+}
+
+// Reads an object module or assembles a source into one, false if there are errors
+bool LoadModule(const string& a_path, ObjectModule& a_module)
+{
+    string contents;
+
+    if (!ReadFile(a_path, contents))
+    {
+        cerr << a_path << " could not be opened." << endl;
+        return false;
+    }
+
+    if (contents.compare(0, 8, "QUACKOBJ") == 0)
+    {
+        istringstream in(contents);
+
+        if (!Linker::ReadModule(in, a_module))
+        {
+            cerr << a_path << " is not a valid object module." << endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    ModuleResult result = Toolchain::AssembleModule(contents.data(), contents.size());
+
+    if (!result.m_success)
+    {
+        WriteDiagnostics(a_path, result.m_diagnostics);
+        return false;
+    }
+
+    a_module = move(result.m_module);
+    return true;
+}
+
+// Writes an object module to a file, false if it cannot be written
+bool WriteModule(const string& a_path, const ObjectModule& a_module)
+{
+    ofstream out(a_path, ios::out | ios::binary);
+    Linker::WriteModule(a_module, out);
+    out.close();
+
+    if (!out)
+    {
+        cerr << a_path << " could not be written." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    vector<string> paths;
+    string output;
+    bool compileOnly = false;
+    bool run = false;
+    bool valid = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "-c")
+            compileOnly = true;
+
+        else if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+
+        else if (arg == "-run")
+            run = true;
+
+        else if (arg[0] != '-')
+            paths.push_back(arg);
+
+        else
+            valid = false;
+    }
+
+    if (!valid || paths.empty() || (compileOnly && (run || !output.empty())))
+    {
+        cerr << "Usage: QuackLink [-c] [-o Output] [-run] Module ..." << endl;
+        return 1;
+    }
+
+    vector<ObjectModule> modules(paths.size());
+    bool loaded = true;
+
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        loaded = LoadModule(paths[i], modules[i]) && loaded;
+
+        if (compileOnly && loaded)
+            loaded = WriteModule(paths[i] + ".qo", modules[i]);
+    }
+
+    if (!loaded)
+        return 1;
+
+    if (compileOnly)
+        return 0;
+
+    AssemblyResult linked = Toolchain::Link(modules);
+
+    if (!linked.m_success)
+    {
+        WriteDiagnostics("link", linked.m_diagnostics);
+        return 1;
+    }
+
+    if (!output.empty())
+    {
+        // the image is a module that is already at its place
+        ObjectModule image;
+        image.m_first = 0;
+        image.m_end = Emulator::MEMSZ;
+        image.m_halt = true;
+        image.m_exports = linked.m_symbols;
+
+        for (int loc = 0; loc < Emulator::MEMSZ; loc++)
+            if (linked.m_image[loc] != 0)
+                image.m_words.push_back(make_pair(loc, linked.m_image[loc]));
+
+        if (!WriteModule(output, image))
+            return 1;
+    }
+
+    if (!run)
+        return 0;
+
+    ConsoleIO console;
+    RunResult result = Toolchain::Run(linked.m_image, console);
+
+    WriteDiagnostics("run", result.m_diagnostics);
+
+    return result.m_halted ? 0 : 1;
+}
@@ -0,0 +1,840 @@
+/*
+ * Assembler and emulator server for Quack3200 programs.
+ *
+ * Listens on a Unix domain socket and serves many clients at once from a
+ * pool of worker threads, so that a short job costs one round trip rather
+ * than starting a process, building the error list and paging in a new
+ * emulator memory. Each worker keeps its own emulator, and the programs
+ * assembled recently are kept in memory by their source.
+ *
+ * Build from the repository root, for example:
+ *
+ *     g++ -O2 -std=c++17 -I. Assembler.cpp Emulator.cpp Errors.cpp FileAccess.cpp \
+ *         Instruction.cpp SymTab.cpp Metrics.cpp ListingWriter.cpp SourceScanner.cpp \
+ *         AotTranslator.cpp AssemblyCache.cpp Optimizer.cpp Linker.cpp Channel.cpp LaneEmulator.cpp Toolchain.cpp tools/QuackServer.cpp \
+ *         -o QuackServer -ldl -lpthread
+ *
+ * Usage: QuackServer SocketPath [-t Threads] [-c CachedPrograms] [-b Budget]
+ *        QuackServer -client SocketPath SourceFile [-assemble]
+ *
+ * The second form sends one request, with the standard input as the input
+ * of the READ instructions, and prints the reply.
+ *
+ * Each request is one header line followed by the bytes it announces:
+ *
+ *     PING
+ *     ASSEMBLE <source bytes>
+ *     RUN <source bytes> <input bytes>
+ *     START <source bytes>
+ *     INPUT <session> <input bytes>
+ *     CLOSE <session>
+ *
+ * The input of RUN and INPUT is split at white space, one word per READ
+ * instruction. START runs a program interactively: it is suspended at each
+ * READ that has no input yet, holding no thread, and continues when INPUT
+ * gives the next words (words left over when the program finishes are
+ * ignored). A session ends when its program finishes, on CLOSE or when its
+ * connection closes.
+ * A client may send its next request before the reply to the previous one
+ * arrives; the replies come back in order. Each reply ends with "END":
+ *
+ *     PONG
+ *     END
+ *
+ *     ASSEMBLED <1 if there are no errors> <1 if the program was cached>
+ *     E <code> <statement><TAB><message>       (one line per error)
+ *     W <value>                                (RUN, one line per WRITE)
+ *     HALTED <1 if HALT was executed> <instructions dispatched>
+ *     E <code> <statement><TAB><message>       (RUN, run-time errors)
+ *     END
+ *
+ * START replies as ASSEMBLE, followed (if there are no errors) by
+ * "SESSION <session>" and the reply of INPUT:
+ *
+ *     W <value>                                (one line per WRITE)
+ *     WAITING                                  (or HALTED and errors as RUN)
+ *     END
+ *
+ * CLOSE replies with CLOSED, and INPUT or CLOSE of a session that is not
+ * open with "UNKNOWN <session>".
+ *
+ * A program run by RUN, or by START and INPUT over its whole session, stops
+ * after Budget instructions (100000000 unless -b gives another, 0 for no
+ * limit) with HALTED 0 and error 40, so that a program that never ends
+ * cannot hold a worker.
+ *
+ * RUN only runs programs without assembly errors. A malformed request is
+ * answered with "BAD <reason>" and "END", and the connection is closed.
+ */
+
+#include "../stdafx.h"
+#include "../Toolchain.h"
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+// Requests larger than this are refused
+const size_t MAX_REQUEST_BYTES = 16 << 20;
+
+// Set by SIGINT and SIGTERM
+volatile sig_atomic_t stopRequested = 0;
+
+void RequestStop(int)
+{
+    stopRequested = 1;
+}
+
+// Fills "a_addr" with the address of the socket "a_path"
+bool SocketAddress(const string& a_path, sockaddr_un& a_addr)
+{
+    memset(&a_addr, 0, sizeof(a_addr));
+    a_addr.sun_family = AF_UNIX;
+
+    if (a_path.size() >= sizeof(a_addr.sun_path))
+        return false;
+
+    memcpy(a_addr.sun_path, a_path.c_str(), a_path.size() + 1);
+    return true;
+}
+
+// Appends the lines of a list of diagnostics to a reply
+void WriteDiagnostics(const vector<Diagnostic>& a_diagnostics, string& a_reply)
+{
+    for (const Diagnostic& diagnostic : a_diagnostics)
+    {
+        string line = "E " + to_string(diagnostic.m_code) + " " + diagnostic.m_statement
+            + "\t" + diagnostic.m_message;
+
+        // a reply line never breaks inside a diagnostic
+        replace(line.begin(), line.end(), '\n', ' ');
+        replace(line.begin(), line.end(), '\r', ' ');
+
+        a_reply += line + "\n";
+    }
+}
+
+// The input words and the WRITE values of one run
+class ReplyIO : public EmulatorIO
+{
+
+public:
+
+    ReplyIO(const string& a_input, string& a_reply): m_input(a_input), m_reply(a_reply) {}
+
+    bool Read(string& a_word)
+    {
+        return static_cast<bool>(m_input>>a_word);
+    }
+
+    void Write(const int& a_value)
+    {
+        m_reply += "W " + to_string(a_value) + "\n";
+    }
+
+private:
+
+    istringstream m_input;
+    string& m_reply;
+};
+
+// The programs assembled most recently, by their source
+class ProgramCache
+{
+
+public:
+
+    ProgramCache(const size_t& a_capacity): m_capacity(a_capacity) {}
+
+    // Returns the assembly of "a_source", assembling it if it is not cached
+    shared_ptr<const AssemblyResult> Assemble(const string& a_source, bool& a_cached)
+    {
+        {
+            lock_guard<mutex> lock(m_lock);
+            auto it = m_entries.find(a_source);
+
+            if (it != m_entries.end())
+            {
+                m_order.splice(m_order.begin(), m_order, it->second.second);
+                a_cached = true;
+                return it->second.first;
+            }
+        }
+
+        // assembled without the lock, so that workers assemble in parallel
+        shared_ptr<const AssemblyResult> result = make_shared<AssemblyResult>(Toolchain::Assemble(a_source));
+        a_cached = false;
+
+        if (m_capacity == 0)
+            return result;
+
+        lock_guard<mutex> lock(m_lock);
+
+        // another worker may have assembled the same source meanwhile
+        if (m_entries.count(a_source) != 0)
+            return result;
+
+        m_order.push_front(a_source);
+        m_entries[a_source] = make_pair(result, m_order.begin());
+
+        if (m_entries.size() > m_capacity)
+        {
+            m_entries.erase(m_order.back());
+            m_order.pop_back();
+        }
+
+        return result;
+    }
+
+private:
+
+    size_t m_capacity;                      // Number of programs kept
+    mutex m_lock;                           // Guards the members below
+    list<string> m_order;                   // The sources, most recently used first
+    unordered_map<string, pair<shared_ptr<const AssemblyResult>, list<string>::iterator>> m_entries;
+};
+
+// The instructions a program may execute unless -b gives another budget
+const long long DEFAULT_BUDGET = 100000000;
+
+// Sessions open at once on one connection
+const size_t MAX_SESSIONS = 4096;
+
+// A request of one connection, carried out by a worker
+struct Job
+{
+    unsigned long long m_connection;        // The connection that sent the request
+    string m_command;                       // ASSEMBLE, RUN, START or INPUT
+    string m_source;                        // The source of the program
+    string m_input;                         // The input of RUN or INPUT
+    unsigned long long m_sessionId = 0;     // The session of START or INPUT
+    shared_ptr<Session> m_session;          // The session of INPUT, made by START
+};
+
+// The reply to a job, sent by the event loop
+struct Reply
+{
+    unsigned long long m_connection;
+    string m_text;
+    unsigned long long m_sessionId;
+    shared_ptr<Session> m_session;          // The session, if its program still waits for input
+};
+
+// The state of one client
+struct Connection
+{
+    int m_fd;
+    string m_in;                            // Received bytes not yet parsed
+    string m_out;                           // Reply bytes not yet sent
+    bool m_busy = false;                    // == true while a worker has its request
+    bool m_closing = false;                 // == true once nothing more is read
+    map<unsigned long long, shared_ptr<Session>> m_sessions;   // The programs waiting for input
+    unsigned long long m_nextSession = 1;   // Id of the next session started
+};
+
+class Server
+{
+
+public:
+
+    Server(const size_t& a_threads, const size_t& a_cachedPrograms, const long long& a_budget):
+    m_threads(a_threads), m_cache(a_cachedPrograms), m_budget(a_budget), m_listener(-1), m_nextConnection(0),
+    m_stopping(false)
+    {
+        m_wake[0] = m_wake[1] = -1;
+    }
+
+    ~Server();
+
+    // Listens on the socket "a_path"
+    bool Listen(const string&);
+
+    // Serves clients until SIGINT or SIGTERM
+    void Serve();
+
+private:
+
+    // The loop of each worker thread
+    void Work();
+
+    // Carries out one request
+    string Carry(Job&, Emulator&);
+
+    // Hands the next complete request of a connection to the workers
+    void Dispatch(const unsigned long long&, Connection&);
+
+    // Reads what a connection sent
+    void Receive(const unsigned long long&, Connection&);
+
+    // Moves the replies of the workers to their connections
+    void CollectReplies();
+
+    size_t m_threads;                       // Number of workers
+    ProgramCache m_cache;                   // The programs assembled recently
+    long long m_budget;                     // The instructions a program may execute, 0 for no limit
+    string m_path;                          // The path of the socket
+    int m_listener;                         // The listening socket
+    int m_wake[2];                          // Written by workers when a reply is ready
+
+    map<unsigned long long, Connection> m_connections;
+    unsigned long long m_nextConnection;    // Id of the next connection accepted
+
+    mutex m_lock;                           // Guards the members below
+    condition_variable m_jobReady;
+    deque<Job> m_jobs;
+    deque<Reply> m_replies;
+    bool m_stopping;
+};
+
+Server::~Server()
+{
+    if (m_listener >= 0)
+    {
+        close(m_listener);
+        unlink(m_path.c_str());
+    }
+
+    for (auto& connection : m_connections)
+        close(connection.second.m_fd);
+
+    if (m_wake[0] >= 0)
+    {
+        close(m_wake[0]);
+        close(m_wake[1]);
+    }
+}
+
+bool Server::Listen(const string& a_path)
+{
+    sockaddr_un addr;
+
+    if (!SocketAddress(a_path, addr))
+    {
+        cerr << "Socket path too long: " << a_path << endl;
+        return false;
+    }
+
+    m_listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (m_listener < 0)
+    {
+        cerr << "Cannot create a socket: " << strerror(errno) << endl;
+        return false;
+    }
+
+    bool bound = ::bind(m_listener, (sockaddr *)&addr, sizeof(addr)) == 0;
+
+    if (!bound && errno == EADDRINUSE)
+    {
+        // a socket left by a server that did not stop is replaced, a live one is not
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = connect(probe, (sockaddr *)&addr, sizeof(addr)) == 0;
+        close(probe);
+
+        if (live)
+        {
+            cerr << "Another server is listening on " << a_path << endl;
+            close(m_listener);
+            m_listener = -1;
+            return false;
+        }
+
+        unlink(a_path.c_str());
+        bound = ::bind(m_listener, (sockaddr *)&addr, sizeof(addr)) == 0;
+    }
+
+    if (!bound || listen(m_listener, SOMAXCONN) != 0 || pipe(m_wake) != 0)
+    {
+        cerr << "Cannot listen on " << a_path << ": " << strerror(errno) << endl;
+        close(m_listener);
+        m_listener = -1;
+        return false;
+    }
+
+    m_path = a_path;
+
+    fcntl(m_listener, F_SETFL, O_NONBLOCK);
+    fcntl(m_wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(m_wake[1], F_SETFL, O_NONBLOCK);
+
+    return true;
+}
+
+void Server::Serve()
+{
+    vector<thread> workers;
+    for (size_t i = 0; i < m_threads; i++)
+        workers.emplace_back(&Server::Work, this);
+
+    vector<pollfd> fds;
+    vector<unsigned long long> ids;
+
+    while (!stopRequested)
+    {
+        fds.clear();
+        ids.clear();
+
+        fds.push_back({m_listener, POLLIN, 0});
+        fds.push_back({m_wake[0], POLLIN, 0});
+
+        for (auto& connection : m_connections)
+        {
+            short events = 0;
+
+            if (!connection.second.m_closing)
+                events |= POLLIN;
+
+            if (!connection.second.m_out.empty())
+                events |= POLLOUT;
+
+            fds.push_back({connection.second.m_fd, events, 0});
+            ids.push_back(connection.first);
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            cerr << "poll failed: " << strerror(errno) << endl;
+            break;
+        }
+
+        if (fds[1].revents != 0)
+            CollectReplies();
+
+        for (size_t i = 2; i < fds.size(); i++)
+        {
+            auto it = m_connections.find(ids[i - 2]);
+            Connection& connection = it->second;
+
+            if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && !connection.m_closing)
+                Receive(it->first, connection);
+
+            if ((fds[i].revents & POLLOUT) != 0 && !connection.m_out.empty())
+            {
+                ssize_t sent = send(connection.m_fd, connection.m_out.data(), connection.m_out.size(), MSG_NOSIGNAL);
+
+                if (sent > 0)
+                    connection.m_out.erase(0, sent);
+
+                else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    connection.m_out.clear();
+                    connection.m_closing = true;
+                }
+            }
+
+            // a connection goes once it has nothing left to read, carry out or send
+            if (connection.m_closing && !connection.m_busy && connection.m_out.empty())
+            {
+                close(connection.m_fd);
+                m_connections.erase(it);
+            }
+        }
+
+        if ((fds[0].revents & POLLIN) != 0)
+        {
+            int fd;
+
+            while ((fd = accept4(m_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                m_connections[m_nextConnection++].m_fd = fd;
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(m_lock);
+        m_stopping = true;
+    }
+
+    m_jobReady.notify_all();
+
+    for (thread& worker : workers)
+        worker.join();
+}
+
+void Server::Work()
+{
+    // paged in once for every run of this worker
+    unique_ptr<Emulator> emul(new Emulator);
+    emul->SetInstructionBudget(m_budget);
+
+    for (;;)
+    {
+        Job job;
+
+        {
+            unique_lock<mutex> lock(m_lock);
+            m_jobReady.wait(lock, [this] {return m_stopping || !m_jobs.empty();});
+
+            if (m_jobs.empty())
+                return;
+
+            job = move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        string reply = Carry(job, *emul);
+
+        // a finished program does not need its session any more
+        if (job.m_session && job.m_session->IsFinished())
+            job.m_session.reset();
+
+        {
+            lock_guard<mutex> lock(m_lock);
+            m_replies.push_back({job.m_connection, move(reply), job.m_sessionId, move(job.m_session)});
+        }
+
+        // the pipe only needs to be readable, a full pipe already is
+        char byte = 0;
+        ssize_t written = write(m_wake[1], &byte, 1);
+        (void)written;
+    }
+}
+
+string Server::Carry(Job& a_job, Emulator& a_emul)
+{
+    string reply;
+
+    // the session waits for input again or finishes
+    auto resumed = [&]
+    {
+        for (int value : a_job.m_session->TakeOutput())
+            reply += "W " + to_string(value) + "\n";
+
+        if (a_job.m_session->NeedsInput())
+            reply += "WAITING\n";
+
+        else
+        {
+            const RunResult& run = a_job.m_session->GetResult();
+            reply += "HALTED " + to_string(run.m_halted ? 1 : 0) + " " + to_string(run.m_instructions) + "\n";
+            WriteDiagnostics(run.m_diagnostics, reply);
+        }
+    };
+
+    if (a_job.m_command == "INPUT")
+    {
+        istringstream words(a_job.m_input);
+        string word;
+
+        while (a_job.m_session->NeedsInput() && words>>word)
+            a_job.m_session->Resume(word);
+
+        resumed();
+        return reply + "END\n";
+    }
+
+    bool cached;
+    shared_ptr<const AssemblyResult> program = m_cache.Assemble(a_job.m_source, cached);
+
+    reply = "ASSEMBLED " + to_string(program->m_success ? 1 : 0) + " " + to_string(cached ? 1 : 0) + "\n";
+    WriteDiagnostics(program->m_diagnostics, reply);
+
+    if (a_job.m_command == "START" && program->m_success)
+    {
+        a_job.m_session = make_shared<Session>(program->m_image);
+        a_job.m_session->SetInstructionBudget(m_budget);
+        a_job.m_session->Start();
+
+        reply += "SESSION " + to_string(a_job.m_sessionId) + "\n";
+        resumed();
+    }
+
+    if (a_job.m_command == "RUN" && program->m_success)
+    {
+        string output;
+        ReplyIO io(a_job.m_input, output);
+        RunResult run = Toolchain::Run(a_emul, program->m_image, io);
+
+        reply += output;
+        reply += "HALTED " + to_string(run.m_halted ? 1 : 0) + " " + to_string(run.m_instructions) + "\n";
+        WriteDiagnostics(run.m_diagnostics, reply);
+    }
+
+    return reply + "END\n";
+}
+
+void Server::Dispatch(const unsigned long long& a_id, Connection& a_connection)
+{
+    // the requests of a connection are carried out one at a time, in order
+    while (!a_connection.m_busy && !a_connection.m_closing)
+    {
+        size_t end = a_connection.m_in.find('\n');
+
+        if (end == string::npos)
+        {
+            if (a_connection.m_in.size() > 256)
+            {
+                a_connection.m_out += "BAD header too long\nEND\n";
+                a_connection.m_closing = true;
+            }
+
+            return;
+        }
+
+        istringstream header(a_connection.m_in.substr(0, end));
+        string command, extra;
+        size_t sourceBytes = 0, inputBytes = 0;
+        header>>command;
+
+        if (command == "PING" && !(header>>extra))
+        {
+            a_connection.m_in.erase(0, end + 1);
+            a_connection.m_out += "PONG\nEND\n";
+            continue;
+        }
+
+        unsigned long long sessionId = 0;
+
+        if (command == "CLOSE" && header>>sessionId && !(header>>extra))
+        {
+            a_connection.m_in.erase(0, end + 1);
+            a_connection.m_out += a_connection.m_sessions.erase(sessionId) != 0
+                ? "CLOSED\nEND\n" : "UNKNOWN " + to_string(sessionId) + "\nEND\n";
+            continue;
+        }
+
+        bool valid = (command == "ASSEMBLE" && header>>sourceBytes && !(header>>extra))
+            || (command == "RUN" && header>>sourceBytes>>inputBytes && !(header>>extra))
+            || (command == "START" && header>>sourceBytes && !(header>>extra))
+            || (command == "INPUT" && header>>sessionId>>inputBytes && !(header>>extra));
+
+        if (!valid || sourceBytes + inputBytes > MAX_REQUEST_BYTES)
+        {
+            a_connection.m_out += valid ? "BAD request too large\nEND\n" : "BAD unknown request\nEND\n";
+            a_connection.m_closing = true;
+            return;
+        }
+
+        if (a_connection.m_in.size() - (end + 1) < sourceBytes + inputBytes)
+            return;
+
+        if (command == "START" && a_connection.m_sessions.size() >= MAX_SESSIONS)
+        {
+            a_connection.m_out += "BAD too many sessions\nEND\n";
+            a_connection.m_closing = true;
+            return;
+        }
+
+        Job job;
+        job.m_connection = a_id;
+        job.m_command = command;
+        job.m_source = a_connection.m_in.substr(end + 1, sourceBytes);
+        job.m_input = a_connection.m_in.substr(end + 1 + sourceBytes, inputBytes);
+        a_connection.m_in.erase(0, end + 1 + sourceBytes + inputBytes);
+
+        if (command == "START")
+            job.m_sessionId = a_connection.m_nextSession++;
+
+        else if (command == "INPUT")
+        {
+            auto session = a_connection.m_sessions.find(sessionId);
+
+            if (session == a_connection.m_sessions.end())
+            {
+                a_connection.m_out += "UNKNOWN " + to_string(sessionId) + "\nEND\n";
+                continue;
+            }
+
+            // the connection gets the session back with the reply
+            job.m_sessionId = sessionId;
+            job.m_session = move(session->second);
+            a_connection.m_sessions.erase(session);
+        }
+
+        a_connection.m_busy = true;
+
+        {
+            lock_guard<mutex> lock(m_lock);
+            m_jobs.push_back(move(job));
+        }
+
+        m_jobReady.notify_one();
+    }
+}
+
+void Server::Receive(const unsigned long long& a_id, Connection& a_connection)
+{
+    char buffer[65536];
+    ssize_t received = recv(a_connection.m_fd, buffer, sizeof(buffer), 0);
+
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return;
+
+    if (received <= 0)
+    {
+        // the requests received in full are still answered
+        Dispatch(a_id, a_connection);
+        a_connection.m_closing = true;
+        return;
+    }
+
+    a_connection.m_in.append(buffer, received);
+    Dispatch(a_id, a_connection);
+}
+
+void Server::CollectReplies()
+{
+    char bytes[256];
+    while (read(m_wake[0], bytes, sizeof(bytes)) > 0)
+        ;
+
+    deque<Reply> replies;
+
+    {
+        lock_guard<mutex> lock(m_lock);
+        replies.swap(m_replies);
+    }
+
+    for (Reply& reply : replies)
+    {
+        auto it = m_connections.find(reply.m_connection);
+
+        if (it == m_connections.end())
+            continue;
+
+        it->second.m_out += reply.m_text;
+        it->second.m_busy = false;
+
+        if (reply.m_session)
+            it->second.m_sessions[reply.m_sessionId] = move(reply.m_session);
+
+        Dispatch(it->first, it->second);
+    }
+}
+
+// Sends one request to a server and prints its reply
+int RunClient(const string& a_path, const string& a_sourceFile, const bool& a_assembleOnly)
+{
+    ifstream in(a_sourceFile, ios::in | ios::binary);
+
+    if (!in)
+    {
+        cerr << a_sourceFile << " could not be opened." << endl;
+        return 1;
+    }
+
+    string source((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    string request;
+
+    if (a_assembleOnly)
+        request = "ASSEMBLE " + to_string(source.size()) + "\n" + source;
+
+    else
+    {
+        string input((istreambuf_iterator<char>(cin)), istreambuf_iterator<char>());
+        request = "RUN " + to_string(source.size()) + " " + to_string(input.size()) + "\n" + source + input;
+    }
+
+    sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (!SocketAddress(a_path, addr) || fd < 0 || connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        cerr << "Cannot connect to " << a_path << endl;
+        return 1;
+    }
+
+    for (size_t sent = 0; sent < request.size(); )
+    {
+        ssize_t count = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+
+        if (count <= 0)
+        {
+            cerr << "The server closed the connection." << endl;
+            close(fd);
+            return 1;
+        }
+
+        sent += count;
+    }
+
+    string reply;
+    char buffer[65536];
+    ssize_t count;
+
+    // one request, so the reply ends with the first END line
+    while (reply.size() < 4 || (reply.compare(reply.size() - 4, 4, "END\n") != 0))
+    {
+        if ((count = recv(fd, buffer, sizeof(buffer), 0)) <= 0)
+            break;
+
+        reply.append(buffer, count);
+    }
+
+    close(fd);
+    cout << reply;
+
+    return reply.compare(0, 11, "ASSEMBLED 1") == 0 ? 0 : 1;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 4 && string(argv[1]) == "-client")
+        return RunClient(argv[2], argv[3], argc == 5 && string(argv[4]) == "-assemble");
+
+    string path;
+    size_t threads = max(1u, thread::hardware_concurrency());
+    size_t cachedPrograms = 64;
+    long long budget = DEFAULT_BUDGET;
+    bool valid = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "-t" && i + 1 < argc)
+            threads = max(1, atoi(argv[++i]));
+
+        else if (arg == "-c" && i + 1 < argc)
+            cachedPrograms = max(0, atoi(argv[++i]));
+
+        else if (arg == "-b" && i + 1 < argc)
+            budget = max(0LL, atoll(argv[++i]));
+
+        else if (path.empty() && arg[0] != '-')
+            path = arg;
+
+        else
+            valid = false;
+    }
+
+    if (!valid || path.empty())
+    {
+        cerr << "Usage: QuackServer SocketPath [-t Threads] [-c CachedPrograms] [-b Budget]" << endl
+             << "       QuackServer -client SocketPath SourceFile [-assemble]" << endl;
+        return 1;
+    }
+
+    // stop cleanly, removing the socket
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = RequestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    Server server(threads, cachedPrograms, budget);
+
+    if (!server.Listen(path))
+        return 1;
+
+    server.Serve();
+
+    return 0;
+}